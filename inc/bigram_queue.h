@@ -0,0 +1,123 @@
+#ifndef BIGRAM_QUEUE_H
+#define BIGRAM_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "concurrent_hashmap.h"
+
+/**
+ * Numero di coppie di parole contenute in una coda (potenza di due).
+ */
+#define BIGRAM_QUEUE_CAPACITY 1024
+
+/**
+ * Numero di coppie di parole pubblicate in una sola volta dal produttore.
+ */
+#define BIGRAM_QUEUE_BATCH 128
+
+/**
+ * Struttura che rappresenta una coppia di parole del testo.
+ *
+ * position è la posizione della coppia nel testo.
+ */
+typedef struct {
+    ConcurrentWord *word;
+    ConcurrentWord *next_word;
+    size_t position;
+} Bigram;
+
+/**
+ * Struttura che rappresenta il segnale su cui un consumatore attende i dati di tutte le sue code.
+ */
+typedef struct {
+    _Atomic uint32_t data_signal;
+    _Atomic bool consumer_waiting;
+} BigramSignal;
+
+/**
+ * Struttura che rappresenta una coda di coppie di parole a singolo produttore e singolo consumatore tra thread.
+ *
+ * head e tail contano le coppie pubblicate e lette dall'inizio, quindi non vengono mai riportati a
+ * zero; il produttore scrive le coppie oltre head e le pubblica a gruppi (written indica le coppie
+ * scritte, cached_tail l'ultimo valore letto di tail). signal è il segnale del consumatore.
+ */
+typedef struct {
+    _Alignas(64) _Atomic size_t head;
+    _Atomic bool closed;
+    _Alignas(64) _Atomic size_t tail;
+    _Atomic uint32_t space_signal;
+    _Atomic bool producer_waiting;
+    _Alignas(64) size_t written;
+    size_t cached_tail;
+    BigramSignal *signal;
+    Bigram items[BIGRAM_QUEUE_CAPACITY];
+} BigramQueue;
+
+/**
+ * Crea una coda di coppie di parole.
+ *
+ * @param signal Il segnale del consumatore.
+ * @return La coda creata.
+ */
+BigramQueue *bigram_queue_create(BigramSignal *signal);
+
+/**
+ * Distrugge una coda di coppie di parole.
+ *
+ * @param queue La coda da distruggere.
+ */
+void bigram_queue_destroy(BigramQueue *queue);
+
+/**
+ * Aggiunge una coppia di parole alla coda, attendendo se è piena.
+ *
+ * @param queue La coda.
+ * @param bigram La coppia di parole.
+ */
+void bigram_queue_push(BigramQueue *queue, Bigram bigram);
+
+/**
+ * Pubblica le coppie di parole ancora da pubblicare e chiude la coda.
+ *
+ * @param queue La coda.
+ */
+void bigram_queue_close(BigramQueue *queue);
+
+/**
+ * Restituisce le coppie di parole pubblicate e non ancora lette, senza attendere e senza copiarle.
+ *
+ * @param queue La coda.
+ * @param items Il puntatore alle coppie.
+ * @return Il numero di coppie contigue disponibili (0 se la coda è vuota).
+ */
+size_t bigram_queue_acquire(BigramQueue *queue, Bigram **items);
+
+/**
+ * Libera le coppie di parole lette, rendendo lo spazio disponibile al produttore.
+ *
+ * @param queue La coda.
+ * @param count Il numero di coppie lette.
+ */
+void bigram_queue_release(BigramQueue *queue, size_t count);
+
+/**
+ * Verifica se una coda è stata chiusa ed è vuota.
+ *
+ * @param queue La coda.
+ * @return true se la coda è stata chiusa ed è vuota, false altrimenti.
+ */
+bool bigram_queue_finished(BigramQueue *queue);
+
+/**
+ * Attende che almeno una delle code di un consumatore abbia dati o sia stata chiusa.
+ *
+ * @param signal Il segnale del consumatore.
+ * @param queues Le code non ancora terminate del consumatore.
+ * @param count Il numero di code.
+ */
+void bigram_queue_wait(BigramSignal *signal, BigramQueue **queues, int count);
+
+#endif
\ No newline at end of file
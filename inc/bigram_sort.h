@@ -0,0 +1,62 @@
+#ifndef BIGRAM_SORT_H
+#define BIGRAM_SORT_H
+
+#include <stddef.h>
+
+/**
+ * Numero di bit delle cifre del radix sort.
+ */
+#define BIGRAM_SORT_DIGIT_BITS 8
+
+/**
+ * Struttura che rappresenta una coppia di parole del testo da ordinare.
+ *
+ * word e next_word sono gli identificativi delle parole, position la posizione della coppia nel testo.
+ */
+typedef struct {
+    unsigned int word;
+    unsigned int next_word;
+    size_t position;
+} BigramRecord;
+
+/**
+ * Struttura che rappresenta un array di coppie di parole che cresce durante la lettura del testo.
+ */
+typedef struct {
+    BigramRecord *records;
+    size_t count;
+    size_t capacity;
+} BigramArray;
+
+/**
+ * Inizializza un array di coppie di parole vuoto.
+ *
+ * @param array L'array.
+ */
+void bigram_array_init(BigramArray *array);
+
+/**
+ * Aggiunge una coppia di parole a un array, ingrandendolo se necessario.
+ *
+ * @param array L'array.
+ * @param word L'identificativo della parola.
+ * @param next_word L'identificativo della parola successiva.
+ * @param position La posizione della coppia nel testo.
+ */
+void bigram_array_push(BigramArray *array, unsigned int word, unsigned int next_word, size_t position);
+
+/**
+ * Ordina le coppie di parole di più array con un radix sort LSD stabile, usando un thread per array.
+ *
+ * Le coppie vengono ordinate per parola e poi per parola successiva; a parità di parole restano
+ * nell'ordine degli array concatenati. Gli array vengono svuotati.
+ *
+ * @param arrays Gli array.
+ * @param count Il numero di array.
+ * @param word_count Il numero di identificativi delle parole.
+ * @param size Il numero di coppie ordinate.
+ * @return Le coppie ordinate (da deallocare).
+ */
+BigramRecord *bigram_sort(BigramArray *arrays, int count, size_t word_count, size_t *size);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,192 @@
+#ifndef CONCURRENT_HASHMAP_H
+#define CONCURRENT_HASHMAP_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "region.h"
+
+/**
+ * Numero di lock tra cui vengono suddivise le entry (potenza di due).
+ */
+#define CONCURRENT_HASHMAP_LOCKS 256
+
+/**
+ * Struttura che rappresenta un nodo di una hashmap concorrente.
+ *
+ * next_word è l'offset della parola successiva, count il numero di occorrenze, order la posizione
+ * nel testo della prima occorrenza della coppia di parole; i nodi vengono modificati solo
+ * insieme all'entry a cui appartengono.
+ */
+typedef struct {
+    size_t next_word;
+    size_t count;
+    size_t order;
+    size_t next;
+} ConcurrentNode;
+
+/**
+ * Struttura che rappresenta una parola di una hashmap concorrente e la sua entry.
+ *
+ * Ogni parola distinta viene memorizzata una sola volta e non viene mai spostata, quindi il suo
+ * offset la identifica; id è un identificativo progressivo assegnato alla creazione. count è il numero di occorrenze della parola come parola precedente
+ * (0 se la parola non ha un'entry), order la posizione nel testo della sua prima occorrenza come
+ * parola precedente, next_words la lista dei nodi (di size elementi), indicizzata in successors
+ * (di successors_size slot) quando le parole successive sono molte. I campi dell'entry vengono
+ * modificati tenendo il lock scelto dall'hash della parola, oppure da un solo thread se le parole
+ * sono suddivise tra i thread. Il testo è in UTF-8.
+ */
+typedef struct {
+    unsigned int hash;
+    unsigned int id;
+    size_t count;
+    size_t order;
+    size_t next_words;
+    size_t size;
+    size_t successors;
+    size_t successors_size;
+    char text[];
+} ConcurrentWord;
+
+/**
+ * Struttura che rappresenta una tabella delle parole di una hashmap concorrente.
+ *
+ * slots è una tabella ad indirizzamento aperto con probing lineare (size è una potenza di due) che
+ * contiene gli offset delle parole; gli slot vengono occupati con una compare-and-swap. Durante
+ * il ridimensionamento next è l'offset della tabella successiva, in cui le parole vengono
+ * spostate a blocchi dai thread che inseriscono (claimed indica il primo slot non ancora
+ * assegnato, migrated il numero di slot spostati).
+ */
+typedef struct {
+    size_t size;
+    _Atomic size_t count;
+    _Atomic int resizing;
+    _Atomic size_t next;
+    _Atomic size_t claimed;
+    _Atomic size_t migrated;
+    _Atomic size_t slots[];
+} ConcurrentTable;
+
+/**
+ * Struttura che rappresenta una hashmap in cui più thread possono inserire contemporaneamente.
+ *
+ * Parole, nodi e tabelle sono allocati in una regione privata e collegati tramite offset; la
+ * regione viene estesa solo tenendo region_lock, mentre parole e nodi vengono allocati senza
+ * lock dai blocchi dei singoli thread. table è l'offset della tabella corrente, word_count il
+ * numero di identificativi assegnati, locks i lock che proteggono le entry.
+ */
+typedef struct {
+    Region *region;
+    pthread_mutex_t region_lock;
+    _Atomic size_t table;
+    _Atomic unsigned int word_count;
+    pthread_mutex_t locks[CONCURRENT_HASHMAP_LOCKS];
+} ConcurrentHashMap;
+
+/**
+ * Struttura che rappresenta un thread che inserisce in una hashmap concorrente.
+ *
+ * slab e slab_end indicano lo spazio ancora libero del blocco da cui il thread alloca parole e nodi.
+ */
+typedef struct {
+    ConcurrentHashMap *map;
+    size_t slab;
+    size_t slab_end;
+} ConcurrentWriter;
+
+/**
+ * Crea una nuova hashmap concorrente.
+ *
+ * @return La hashmap creata.
+ */
+ConcurrentHashMap *concurrent_hashmap_create();
+
+/**
+ * Distrugge una hashmap concorrente (quando nessun thread la usa più).
+ *
+ * @param map La hashmap da distruggere.
+ */
+void concurrent_hashmap_destroy(ConcurrentHashMap *map);
+
+/**
+ * Crea un thread che inserisce in una hashmap concorrente.
+ *
+ * @param map La hashmap.
+ * @return Il thread creato.
+ */
+ConcurrentWriter *concurrent_writer_create(ConcurrentHashMap *map);
+
+/**
+ * Distrugge un thread che inserisce in una hashmap concorrente (le parole allocate restano nella hashmap).
+ *
+ * @param writer Il thread da distruggere.
+ */
+void concurrent_writer_destroy(ConcurrentWriter *writer);
+
+/**
+ * Restituisce una parola, aggiungendola alla hashmap se non è presente.
+ *
+ * @param writer Il thread che inserisce.
+ * @param word Il testo della parola.
+ * @return La parola (lo stesso per tutti i thread).
+ */
+ConcurrentWord *concurrent_hashmap_intern(ConcurrentWriter *writer, char *word);
+
+/**
+ * Inserisce un nodo in una hashmap concorrente.
+ *
+ * @param writer Il thread che inserisce.
+ * @param word La parola.
+ * @param next_word La parola successiva.
+ * @param position La posizione della coppia di parole nel testo (distinta per ogni inserimento).
+ */
+void concurrent_hashmap_insert(ConcurrentWriter *writer, ConcurrentWord *word, ConcurrentWord *next_word, size_t position);
+
+/**
+ * Inserisce un nodo in una hashmap concorrente senza lock.
+ *
+ * @param writer Il thread che inserisce.
+ * @param word La parola (modificata solo da questo thread, ad esempio perché le parole sono suddivise tra i thread).
+ * @param next_word La parola successiva.
+ * @param position La posizione della coppia di parole nel testo (distinta per ogni inserimento).
+ */
+void concurrent_hashmap_insert_owned(ConcurrentWriter *writer, ConcurrentWord *word, ConcurrentWord *next_word, size_t position);
+
+/**
+ * Restituisce le entry di una hashmap concorrente (quando nessun thread inserisce più).
+ *
+ * @param map La hashmap.
+ * @param count Il numero di entry.
+ * @return Le entry in ordine di prima occorrenza nel testo (da deallocare).
+ */
+ConcurrentWord **concurrent_hashmap_entries(ConcurrentHashMap *map, size_t *count);
+
+/**
+ * Restituisce le parole di una hashmap concorrente indicizzate per identificativo (quando nessun thread inserisce più).
+ *
+ * @param map La hashmap.
+ * @param count Il numero di identificativi assegnati.
+ * @return Le parole (NULL per gli identificativi di parole create e non pubblicate, da deallocare).
+ */
+ConcurrentWord **concurrent_hashmap_words(ConcurrentHashMap *map, size_t *count);
+
+/**
+ * Restituisce i nodi di un'entry di una hashmap concorrente (quando nessun thread inserisce più).
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ * @param nodes I nodi in ordine inverso di prima occorrenza nel testo (size elementi).
+ */
+void concurrent_hashmap_nodes(ConcurrentHashMap *map, ConcurrentWord *entry, ConcurrentNode **nodes);
+
+/**
+ * Restituisce una parola a partire dal suo offset.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset della parola.
+ * @return La parola, NULL se l'offset è 0.
+ */
+ConcurrentWord *concurrent_hashmap_word(ConcurrentHashMap *map, size_t offset);
+
+#endif
\ No newline at end of file
@@ -3,4 +3,19 @@
 
 #define MAX_WORD_LENGTH 31
 
+/**
+ * Dimensione in byte di una parola codificata in UTF-8 (ogni carattere occupa al massimo 4 byte), compreso il terminatore.
+ */
+#define MAX_WORD_BYTES (MAX_WORD_LENGTH * 4 + 1)
+
+/**
+ * Numero massimo di thread tra cui suddividere il testo o la tabella.
+ */
+#define MAX_THREADS 256
+
+/**
+ * Numero massimo di processi tra cui suddividere il testo.
+ */
+#define MAX_JOBS 256
+
 #endif
\ No newline at end of file
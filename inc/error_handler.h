@@ -10,12 +10,15 @@ typedef enum ErrorCode {
     ERR_UNKNOWN_OPTION,
     ERR_MISSING_OPTION_ARGUMENT,
     ERR_INVALID_OPTION_ARGUMENT,
+    ERR_CONFLICTING_OPTION,
     ERR_MISSING_COMMAND,
     ERR_INVALID_COMMAND,
     ERR_INVALID_TEXT,
     ERR_INVALID_TABLE,
     ERR_MEMORY_ALLOCATION,
     ERR_PARALLELIZATION,
+    ERR_TEMPORARY_FILE,
+    ERR_OUTPUT_FILE,
     ERR_INTERNAL_ERROR,
 } ErrorCode;
 
@@ -13,7 +13,19 @@
  * @param previous_word La parola precedente.
  * @param output_file Il file di output.
  * @param multiprocess_mode La modalità multiprocessore.
+ * @param shared_memory_mode Indica se trasferire la tabella su un ring buffer in memoria condivisa invece che su una pipe.
+ * @param threads Il numero di thread tra cui suddividere il caricamento della tabella.
+ * @param index_filename Il percorso dell'indice della tabella, per caricarne le righe su richiesta (NULL per caricarla interamente).
+ * @param cache_table_filename Il percorso della tabella, per condividerla tramite la cache in memoria condivisa (NULL per non usare la cache).
  */
-void flatten(FILE *input_file, int words_to_generate, wchar_t *previous_word, FILE *output_file, bool multiprocess_mode);
+void flatten(FILE *input_file, int words_to_generate, char *previous_word, FILE *output_file, bool multiprocess_mode, bool shared_memory_mode, int threads, char *index_filename, char *cache_table_filename);
+
+/**
+ * Compila una tabella di frequenze in un file binario, che flatten mappa senza leggerlo.
+ *
+ * @param input_file Il file di input (tabella in formato CSV).
+ * @param output_file Il file di output.
+ */
+void flatten_compile(FILE *input_file, FILE *output_file);
 
 #endif
\ No newline at end of file
@@ -1,44 +1,141 @@
 #ifndef HASHMAP_H
 #define HASHMAP_H
 
+#include <stdio.h>
+#include <stdbool.h>
+
 #include "constants.h"
+#include "region.h"
+
+/**
+ * Fattore di carico massimo della hashmap, oltre il quale la tabella viene raddoppiata.
+ */
+#ifndef HASHMAP_MAX_LOAD_FACTOR
+#define HASHMAP_MAX_LOAD_FACTOR 0.75
+#endif
 
 /*
  * Struttura che rappresenta un nodo.
+ *
+ * In tabulate viene aggiornato solo il numero di occorrenze (count), la frequenza
+ * viene calcolata una sola volta in fase di scrittura; in flatten viene usata la
+ * frequenza letta dalla tabella. next_word è l'identificativo della parola successiva,
+ * i collegamenti sono offset nella regione della hashmap.
  */
 typedef struct Node {
-    wchar_t next_word[MAX_WORD_LENGTH];
+    unsigned int next_word;
     double frequency;
-    struct Node *next;
+    size_t count;
+    size_t next;
 } Node;
 
 /**
  * Struttura che rappresenta una entry.
+ *
+ * word è l'identificativo della parola, size indica il numero di parole successive, count il
+ * numero di occorrenze della parola. Le entry sono collegate nell'ordine di inserimento
+ * (next_inserted). Quando le parole successive sono molte, vengono indicizzate in una tabella
+ * di slot (successors, di dimensione successors_size) in modo che la ricerca non debba scorrere
+ * la lista. In flatten alias è l'offset della tabella alias delle parole successive (0 se la
+ * tabella non è stata compilata).
  */
 typedef struct Entry {
-    wchar_t word[MAX_WORD_LENGTH];
-    Node *next_words;
+    unsigned int word;
+    size_t next_words;
     size_t size;
-    struct Entry *next;
+    size_t count;
+    size_t next_inserted;
+    size_t successors;
+    size_t successors_size;
+    size_t alias;
 } Entry;
 
 /**
- * Struttura che rappresenta una hashmap.
+ * Struttura che rappresenta uno slot della tabella alias di un'entry (metodo di Walker e Vose).
+ *
+ * Scelto uno slot a caso tra i size dell'entry, la parola successiva è quella dell'entry next_entry
+ * con probabilità probability, altrimenti quella dello slot alias; in questo modo la scelta richiede
+ * tempo costante. next_entry è l'offset dell'entry della parola successiva next_word, quindi la
+ * generazione passa da un'entry all'altra senza cercare le parole (0 se l'entry non è ancora stata caricata).
+ */
+typedef struct {
+    double probability;
+    size_t next_entry;
+    unsigned int alias;
+    unsigned int next_word;
+} AliasSlot;
+
+/**
+ * Struttura che rappresenta una parola.
+ *
+ * Ogni parola distinta viene memorizzata una sola volta ed è identificata da un numero a 32 bit
+ * (id), usato da entry e nodi al posto del testo; entry è l'offset dell'entry della parola
+ * (0 se la parola non ha un'entry). Il testo è memorizzato in UTF-8.
+ */
+typedef struct {
+    size_t entry;
+    unsigned int id;
+    char text[];
+} Word;
+
+/**
+ * Struttura che rappresenta uno slot della tabella.
+ *
+ * hash è l'hash della parola (o dell'identificativo della parola successiva), in modo che le
+ * parole vengano confrontate solo se gli hash coincidono e che il ridimensionamento non debba
+ * ricalcolarli; offset è l'offset della parola o del nodo (0 se lo slot è vuoto).
+ */
+typedef struct {
+    unsigned int hash;
+    size_t offset;
+} Slot;
+
+/**
+ * Struttura che rappresenta i campi di una hashmap memorizzati nella sua regione, in modo che
+ * la hashmap possa essere riaperta da un altro processo.
  */
 typedef struct {
-    Entry **buckets;
+    size_t slots;
+    size_t size;
+    size_t words;
+    size_t word_count;
     size_t usage;
+    size_t first;
+    size_t last;
+} HashMapRoot;
+
+/**
+ * Struttura che rappresenta una hashmap.
+ *
+ * Le parole vengono memorizzate una sola volta: slots è una tabella ad indirizzamento aperto con
+ * probing robin hood (size è una potenza di due) che associa il testo alla parola, words un array
+ * (di dimensione words_size) che associa gli identificativi alle parole. usage indica il numero di
+ * entry. Slot, parole, entry e nodi sono allocati in una regione e collegati tramite offset, quindi
+ * una hashmap costruita in una regione condivisa può essere letta da un altro processo senza copie.
+ * Parole, entry e nodi vengono allocati in sequenza da blocchi della regione (slab e slab_end
+ * indicano lo spazio ancora libero del blocco corrente).
+ */
+typedef struct {
+    Region *region;
+    size_t slots;
     size_t size;
+    size_t words;
+    size_t words_size;
+    size_t word_count;
+    size_t usage;
+    size_t first;
+    size_t last;
+    size_t slab;
+    size_t slab_end;
 } HashMap;
 
 /**
  * Calcola l'hash di una stringa.
  *
  * @param string La stringa di cui calcolare l'hash.
- * @param size La dimensione della hashmap.
- * @return L'hash della stringa.
+ * @return L'hash della stringa (da ridurre con la maschera della tabella).
  */
-unsigned int hash(wchar_t *string, int size);
+unsigned int hash(char *string);
 
 /**
  * Crea una nuova hashmap.
@@ -47,6 +144,55 @@ unsigned int hash(wchar_t *string, int size);
  */
 HashMap *hashmap_create();
 
+/**
+ * Crea una nuova hashmap in una regione condivisa.
+ *
+ * @param fd Il file descriptor del file della regione.
+ * @return La hashmap creata.
+ */
+HashMap *hashmap_create_shared(int fd);
+
+/**
+ * Apre in sola lettura una hashmap pubblicata da un altro processo in una regione condivisa.
+ *
+ * @param fd Il file descriptor del file della regione.
+ * @return La hashmap aperta.
+ */
+HashMap *hashmap_open(int fd);
+
+/**
+ * Apre in sola lettura una hashmap pubblicata e salvata in un file, a partire da un offset.
+ *
+ * @param fd Il file descriptor del file.
+ * @param offset L'offset della regione della hashmap nel file (multiplo della dimensione di una pagina).
+ * @return La hashmap aperta, NULL se il file non contiene una hashmap pubblicata.
+ */
+HashMap *hashmap_load(int fd, size_t offset);
+
+/**
+ * Pubblica una hashmap e salva la sua regione su un file, in modo che possa essere aperta con hashmap_load.
+ *
+ * @param map La hashmap.
+ * @param file Il file.
+ * @return true se la regione è stata scritta, false altrimenti.
+ */
+bool hashmap_save(HashMap *map, FILE *file);
+
+/**
+ * Copia una hashmap compilata in una nuova regione, con i soli oggetti usati dalla generazione del testo.
+ *
+ * @param map La hashmap (compilata).
+ * @return La hashmap compattata (senza nodi), in una nuova regione privata.
+ */
+HashMap *hashmap_compact(HashMap *map);
+
+/**
+ * Pubblica una hashmap nella sua regione, in modo che possa essere aperta da un altro processo.
+ *
+ * @param map La hashmap da pubblicare.
+ */
+void hashmap_publish(HashMap *map);
+
 /**
  * Ridimensiona una hashmap.
  *
@@ -62,23 +208,69 @@ void hashmap_resize(HashMap *map);
 void hashmap_destroy(HashMap *map);
 
 /**
- * Inserisce un nodo.
+ * Restituisce l'identificativo di una parola, aggiungendola alla tabella delle parole se non è presente.
+ *
+ * @param map La hashmap.
+ * @param word La parola.
+ * @return L'identificativo della parola.
+ */
+unsigned int hashmap_intern(HashMap *map, char *word);
+
+/**
+ * Restituisce il testo di una parola a partire dal suo identificativo.
+ *
+ * @param map La hashmap.
+ * @param id L'identificativo della parola.
+ * @return Il testo della parola.
+ */
+char *hashmap_word(HashMap *map, unsigned int id);
+
+/**
+ * Restituisce l'entry di una parola a partire dal suo identificativo.
+ *
+ * @param map La hashmap.
+ * @param id L'identificativo della parola.
+ * @return L'entry della parola, NULL se la parola non ha un'entry.
+ */
+Entry *hashmap_word_entry(HashMap *map, unsigned int id);
+
+/**
+ * Restituisce una entry a partire dal suo offset.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset dell'entry.
+ * @return L'entry, NULL se l'offset è 0.
+ */
+Entry *hashmap_entry(HashMap *map, size_t offset);
+
+/**
+ * Restituisce un nodo a partire dal suo offset.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset del nodo.
+ * @return Il nodo, NULL se l'offset è 0.
+ */
+Node *hashmap_node(HashMap *map, size_t offset);
+
+/**
+ * Inserisce un nodo in testa alla lista delle parole successive di una entry.
  *
- * @param head La testa della lista.
+ * @param map La hashmap.
+ * @param entry L'entry.
  * @param next_word La parola successiva.
  * @param frequency La frequenza della parola successiva.
- * @return La nuova testa della lista.
+ * @return Il nodo inserito.
  */
-Node *hashmap_insert_node(Node *head, wchar_t *next_word, double frequency);
+Node *hashmap_add_node(HashMap *map, Entry *entry, char *next_word, double frequency);
 
 /**
- * Inserisce una entry.
+ * Aggiunge una nuova entry a una hashmap.
  *
- * @param head La testa della lista.
- * @param word La parola.
- * @return La nuova testa della lista.
+ * @param map La hashmap.
+ * @param word La parola (che non ha ancora un'entry).
+ * @return L'entry creata.
  */
-Entry *hashmap_insert_entry(Entry *head, wchar_t *word);
+Entry *hashmap_add_entry(HashMap *map, char *word);
 
 /**
  * Inserisce un nodo in una hashmap.
@@ -87,7 +279,16 @@ Entry *hashmap_insert_entry(Entry *head, wchar_t *word);
  * @param word La parola.
  * @param next_word La parola successiva.
  */
-void hashmap_insert(HashMap *map, wchar_t *word, wchar_t *next_word);
+void hashmap_insert(HashMap *map, char *word, char *next_word);
+
+/**
+ * Inserisce un nodo in una hashmap a partire dagli identificativi delle parole.
+ *
+ * @param map La hashmap.
+ * @param word L'identificativo della parola.
+ * @param next_word L'identificativo della parola successiva.
+ */
+void hashmap_insert_ids(HashMap *map, unsigned int word, unsigned int next_word);
 
 /**
  * Restituisce la entry di una parola.
@@ -96,22 +297,86 @@ void hashmap_insert(HashMap *map, wchar_t *word, wchar_t *next_word);
  * @param word La parola di cui cercare l'entry.
  * @return L'entry della parola.
  */
-Entry *hashmap_get(HashMap *map, wchar_t *word);
+Entry *hashmap_get(HashMap *map, char *word);
+
+/**
+ * Compila una tabella delle frequenze: costruisce la tabella alias delle parole successive di ogni
+ * entry, a partire dalle frequenze dei nodi, collegando ogni parola successiva alla sua entry.
+ *
+ * @param map La hashmap.
+ * @return true se ogni parola successiva ha un'entry, false altrimenti.
+ */
+bool hashmap_compile(HashMap *map);
+
+/**
+ * Compila una sola entry: costruisce la sua tabella alias, collegando le parole successive che hanno già un'entry.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ */
+void hashmap_compile_entry(HashMap *map, Entry *entry);
+
+/**
+ * Collega uno slot di una tabella alias all'entry della sua parola successiva.
+ *
+ * @param map La hashmap.
+ * @param slot Lo slot.
+ * @return true se la parola successiva ha un'entry, false altrimenti.
+ */
+bool hashmap_resolve_alias(HashMap *map, AliasSlot *slot);
+
+/**
+ * Restituisce la tabella alias di un'entry.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ * @return La tabella alias (size slot), NULL se non è stata costruita.
+ */
+AliasSlot *hashmap_alias(HashMap *map, Entry *entry);
+
+/**
+ * Unisce una hashmap in un'altra.
+ *
+ * Le entry e i nodi mancanti vengono aggiunti nell'ordine in cui sono stati inseriti nella
+ * hashmap sorgente, in modo che il risultato coincida con quello ottenuto inserendo le coppie
+ * di parole della sorgente dopo quelle della destinazione. La hashmap sorgente viene svuotata.
+ *
+ * @param map La hashmap di destinazione.
+ * @param other La hashmap da unire.
+ */
+void hashmap_merge(HashMap *map, HashMap *other);
+
+/**
+ * Unisce un'entry di un'altra hashmap in una hashmap.
+ *
+ * Le entry di una sorgente devono essere unite nell'ordine di inserimento; entry diverse possono
+ * essere unite in parallelo in hashmap di destinazione diverse, perché l'entry sorgente e i suoi
+ * nodi vengono modificati solo da chi la unisce.
+ *
+ * @param map La hashmap di destinazione.
+ * @param other La hashmap sorgente.
+ * @param other_entry L'entry da unire.
+ * @param words La conversione degli identificativi delle parole della sorgente in quelli della destinazione (UINT_MAX per quelli non ancora convertiti).
+ * @return L'entry della destinazione.
+ */
+Entry *hashmap_merge_entry(HashMap *map, HashMap *other, Entry *other_entry, unsigned int *words);
 
 /**
- * Converte una hashmap in un buffer.
+ * Converte una hashmap in un buffer binario.
  *
  * @param map La hashmap da convertire.
+ * @param size La dimensione del buffer.
  * @return Il buffer convertito.
  */
-wchar_t *hashmap_serialize(HashMap *map);
+char *hashmap_serialize(HashMap *map, size_t *size);
 
 /**
- * Carica una hashmap da un buffer.
+ * Carica una hashmap da un buffer binario.
  *
  * @param map La hashmap da caricare.
  * @param buffer Il buffer da cui caricare la hashmap.
+ * @param size La dimensione del buffer.
  */
- void hashmap_deserialize(HashMap *map, wchar_t *buffer);
+void hashmap_deserialize(HashMap *map, char *buffer, size_t size);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef PIPE_IO_H
+#define PIPE_IO_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "reader.h"
+
+/**
+ * Dimensione massima del contenuto di un frame.
+ */
+#define PIPE_FRAME_SIZE 65536
+
+/**
+ * Capacità richiesta per le pipe (il kernel può concederne una minore).
+ */
+#define PIPE_CAPACITY 1048576
+
+/**
+ * Crea una pipe e ne aumenta la capacità.
+ *
+ * @param pipe_fd I file descriptor della pipe.
+ */
+void pipe_open(int pipe_fd[2]);
+
+/**
+ * Scrive un buffer su un file descriptor, gestendo le scritture parziali.
+ *
+ * @param fd Il file descriptor.
+ * @param buffer Il buffer da scrivere.
+ * @param size La dimensione del buffer in byte.
+ */
+void pipe_write(int fd, const void *buffer, size_t size);
+
+/**
+ * Legge un buffer da un file descriptor, gestendo le letture parziali.
+ *
+ * @param fd Il file descriptor.
+ * @param buffer Il buffer in cui leggere.
+ * @param size La dimensione del buffer in byte.
+ * @return true se il buffer è stato letto completamente, false altrimenti.
+ */
+bool pipe_read(int fd, void *buffer, size_t size);
+
+/**
+ * Scrive su una pipe il contenuto di un file suddiviso in frame.
+ *
+ * Ogni frame è composto dalla dimensione del contenuto seguita dal contenuto, che non divide mai
+ * un carattere UTF-8; un frame vuoto indica la fine del file.
+ *
+ * @param fd Il file descriptor del lato di scrittura della pipe.
+ * @param reader Il lettore del file.
+ */
+void pipe_send(int fd, Reader *reader);
+
+/**
+ * Legge un frame da una pipe.
+ *
+ * @param fd Il file descriptor del lato di lettura della pipe.
+ * @param buffer Il buffer in cui leggere il contenuto (di almeno PIPE_FRAME_SIZE byte).
+ * @return La dimensione del contenuto, 0 alla fine del file.
+ */
+size_t pipe_receive(int fd, char *buffer);
+
+/**
+ * Attende i processi di una pipeline.
+ *
+ * Se un processo termina con un errore, gli altri vengono terminati (un processo in attesa su un
+ * ring buffer non si accorgerebbe altrimenti della fine dell'altro lato) e il programma termina
+ * con un errore.
+ *
+ * @param pids Gli identificatori dei processi.
+ * @param count Il numero di processi.
+ */
+void pipe_wait_processes(pid_t pids[], int count);
+
+#endif
\ No newline at end of file
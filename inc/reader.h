@@ -0,0 +1,90 @@
+#ifndef READER_H
+#define READER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+/**
+ * Struttura che rappresenta un lettore di un file di input.
+ *
+ * Se il file è regolare viene mappato in memoria e restituito come un unico blocco contiguo,
+ * altrimenti viene letto a blocchi in un buffer; i blocchi non dividono mai un carattere UTF-8
+ * (i byte di un carattere incompleto vengono conservati e restituiti con il blocco successivo).
+ * Il lettore di una pipe restituisce invece i frame scritti dal processo di lettura, quello di un
+ * ring buffer i dati pubblicati direttamente nella memoria condivisa.
+ */
+typedef struct {
+    int fd;
+    bool mapped;
+    bool framed;
+    struct RingBuffer *ring;
+    char *mapping;
+    size_t mapping_size;
+    char *data;
+    size_t size;
+    char *buffer;
+    size_t pending;
+    bool finished;
+} Reader;
+
+/**
+ * Crea un lettore per un file.
+ *
+ * @param file Il file da leggere.
+ * @return Il lettore creato.
+ */
+Reader *reader_open(FILE *file);
+
+/**
+ * Crea un lettore per una porzione di un file regolare.
+ *
+ * @param file Il file da leggere.
+ * @param start L'offset di inizio della porzione.
+ * @param end L'offset di fine della porzione.
+ * @return Il lettore creato.
+ */
+Reader *reader_open_range(FILE *file, off_t start, off_t end);
+
+/**
+ * Crea un lettore per dati già in memoria (che non vengono copiati né deallocati).
+ *
+ * @param data I dati da leggere.
+ * @param size La dimensione dei dati.
+ * @return Il lettore creato.
+ */
+Reader *reader_open_memory(char *data, size_t size);
+
+/**
+ * Crea un lettore per i frame scritti su una pipe.
+ *
+ * @param fd Il file descriptor del lato di lettura della pipe.
+ * @return Il lettore creato.
+ */
+Reader *reader_open_pipe(int fd);
+
+/**
+ * Crea un lettore per i dati pubblicati su un ring buffer.
+ *
+ * @param ring Il ring buffer.
+ * @return Il lettore creato.
+ */
+Reader *reader_open_ring(struct RingBuffer *ring);
+
+/**
+ * Restituisce il blocco successivo del file.
+ *
+ * @param reader Il lettore.
+ * @param data Il puntatore al blocco letto.
+ * @return La dimensione del blocco, 0 se il file è terminato.
+ */
+size_t reader_read(Reader *reader, char **data);
+
+/**
+ * Distrugge un lettore.
+ *
+ * @param reader Il lettore da distruggere.
+ */
+void reader_close(Reader *reader);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <stddef.h>
+
+/**
+ * Intestazione di una regione, memorizzata all'inizio della regione stessa.
+ *
+ * size indica i byte occupati (compresa l'intestazione), root l'offset dell'oggetto principale.
+ */
+typedef struct {
+    size_t size;
+    size_t root;
+} RegionHeader;
+
+/**
+ * Struttura che rappresenta una regione di memoria da cui vengono allocati gli oggetti.
+ *
+ * Gli oggetti si riferiscono tra loro tramite offset dall'inizio della regione (0 indica l'assenza
+ * di un oggetto), quindi una regione condivisa resta valida anche se viene mappata a un indirizzo
+ * diverso da un altro processo. Lo spazio di indirizzamento viene riservato alla creazione, in modo
+ * che gli oggetti non vengano mai spostati durante la crescita.
+ */
+typedef struct {
+    int fd;
+    char *base;
+    size_t capacity;
+    size_t reserved;
+} Region;
+
+/**
+ * Crea il file in memoria che contiene una regione condivisa (da creare prima della fork dei processi che la usano).
+ *
+ * @return Il file descriptor del file.
+ */
+int region_create_file();
+
+/**
+ * Crea una regione.
+ *
+ * @param fd Il file descriptor del file della regione condivisa, -1 per una regione privata.
+ * @return La regione creata.
+ */
+Region *region_create(int fd);
+
+/**
+ * Mappa in sola lettura una regione condivisa creata da un altro processo.
+ *
+ * @param fd Il file descriptor del file della regione.
+ * @return La regione mappata.
+ */
+Region *region_attach(int fd);
+
+/**
+ * Mappa in sola lettura una regione salvata in un file, a partire da un offset.
+ *
+ * @param fd Il file descriptor del file.
+ * @param offset L'offset della regione nel file (multiplo della dimensione di una pagina).
+ * @return La regione mappata, NULL se il file non contiene una regione.
+ */
+Region *region_map(int fd, size_t offset);
+
+/**
+ * Distrugge una regione, deallocando tutti i suoi oggetti.
+ *
+ * @param region La regione da distruggere.
+ */
+void region_destroy(Region *region);
+
+/**
+ * Alloca un oggetto in una regione.
+ *
+ * @param region La regione.
+ * @param size La dimensione dell'oggetto.
+ * @return L'offset dell'oggetto.
+ */
+size_t region_allocate(Region *region, size_t size);
+
+/**
+ * Restituisce l'indirizzo di un oggetto di una regione.
+ *
+ * @param region La regione.
+ * @param offset L'offset dell'oggetto.
+ * @return L'indirizzo dell'oggetto, NULL se l'offset è 0.
+ */
+void *region_pointer(Region *region, size_t offset);
+
+/**
+ * Restituisce l'intestazione di una regione.
+ *
+ * @param region La regione.
+ * @return L'intestazione della regione.
+ */
+RegionHeader *region_header(Region *region);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,107 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "reader.h"
+
+/**
+ * Capacità del ring buffer (multiplo della dimensione della pagina).
+ */
+#define RING_CAPACITY 1048576
+
+/**
+ * Dimensione massima dei dati pubblicati in una sola volta dal produttore.
+ */
+#define RING_CHUNK_SIZE 65536
+
+/**
+ * Struttura di controllo del ring buffer, condivisa tra i processi.
+ *
+ * head e tail contano i byte scritti e letti dall'inizio, quindi non vengono mai riportati a zero;
+ * i segnali sono le parole su cui i processi attendono con una futex.
+ */
+typedef struct {
+    _Atomic size_t head;
+    _Atomic size_t tail;
+    _Atomic bool closed;
+    _Atomic uint32_t data_signal;
+    _Atomic uint32_t space_signal;
+    _Atomic bool consumer_waiting;
+    _Atomic bool producer_waiting;
+} RingControl;
+
+/**
+ * Struttura che rappresenta un ring buffer a singolo produttore e singolo consumatore in memoria condivisa.
+ *
+ * L'area dei dati viene mappata due volte consecutivamente, quindi ogni porzione del buffer è
+ * contigua anche quando supera la fine dell'area.
+ */
+typedef struct RingBuffer {
+    RingControl *control;
+    size_t control_size;
+    char *data;
+    size_t capacity;
+} RingBuffer;
+
+/**
+ * Crea un ring buffer in memoria condivisa (da creare prima della fork dei processi che lo usano).
+ *
+ * @param capacity La capacità del buffer.
+ * @return Il ring buffer creato.
+ */
+RingBuffer *ring_create(size_t capacity);
+
+/**
+ * Distrugge un ring buffer.
+ *
+ * @param ring Il ring buffer da distruggere.
+ */
+void ring_destroy(RingBuffer *ring);
+
+/**
+ * Scrive sul ring buffer il contenuto di un file e lo chiude.
+ *
+ * I dati vengono pubblicati senza dividere i caratteri UTF-8.
+ *
+ * @param ring Il ring buffer.
+ * @param reader Il lettore del file.
+ */
+void ring_send(RingBuffer *ring, Reader *reader);
+
+/**
+ * Attende e restituisce i dati pubblicati e non ancora letti, senza copiarli.
+ *
+ * @param ring Il ring buffer.
+ * @param data Il puntatore ai dati.
+ * @return La dimensione dei dati, 0 se il buffer è stato chiuso ed è vuoto.
+ */
+size_t ring_acquire(RingBuffer *ring, char **data);
+
+/**
+ * Libera i dati letti, rendendo lo spazio disponibile al produttore.
+ *
+ * @param ring Il ring buffer.
+ * @param size La dimensione dei dati letti.
+ */
+void ring_release(RingBuffer *ring, size_t size);
+
+/**
+ * Attende che il valore di una parola condivisa cambi.
+ *
+ * @param address L'indirizzo della parola.
+ * @param value Il valore atteso.
+ */
+void futex_wait(_Atomic uint32_t *address, uint32_t value);
+
+/**
+ * Risveglia i processi o i thread in attesa su una parola condivisa.
+ *
+ * @param address L'indirizzo della parola.
+ */
+void futex_wake(_Atomic uint32_t *address);
+
+#endif
\ No newline at end of file
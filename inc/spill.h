@@ -0,0 +1,156 @@
+#ifndef SPILL_H
+#define SPILL_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "constants.h"
+
+/**
+ * Numero massimo di run aperti contemporaneamente, oltre il quale vengono uniti in un unico run.
+ */
+#define SPILL_MAX_RUNS 64
+
+/**
+ * Struttura che rappresenta una coppia di parole di un run, cioè di una tabella parziale scritta su disco.
+ *
+ * count è il numero di occorrenze della coppia nel run, order l'ordine della sua prima occorrenza,
+ * entry_order quello della prima occorrenza della parola come parola precedente; gli ordini dei
+ * run successivi sono sempre maggiori di quelli dei run precedenti.
+ */
+typedef struct {
+    char word[MAX_WORD_BYTES];
+    char next_word[MAX_WORD_BYTES];
+    size_t count;
+    size_t order;
+    size_t entry_order;
+} SpillPair;
+
+/**
+ * Struttura che rappresenta una riga della tabella delle frequenze in un run, con l'ordine in cui deve essere scritta.
+ */
+typedef struct {
+    size_t order;
+    size_t length;
+    size_t capacity;
+    char *text;
+} SpillLine;
+
+/**
+ * Struttura che rappresenta la lettura di un run durante l'unione.
+ */
+typedef struct {
+    FILE *file;
+    SpillPair pair;
+    SpillLine line;
+} SpillRun;
+
+/**
+ * Struttura che rappresenta un elenco di run dello stesso tipo (coppie di parole o righe).
+ *
+ * files contiene count run (capacity elementi allocati).
+ */
+typedef struct {
+    FILE **files;
+    int count;
+    int capacity;
+    bool lines;
+} SpillRuns;
+
+/**
+ * Struttura che rappresenta l'unione di più run, ordinati allo stesso modo.
+ *
+ * heap è un min-heap degli indici dei run non ancora terminati (di size elementi), ordinato in
+ * base al record corrente di ogni run; last è l'indice del run il cui record è stato restituito
+ * per ultimo (-1 se nessuno), che avanza alla richiesta successiva.
+ */
+typedef struct {
+    SpillRun *runs;
+    int count;
+    int *heap;
+    int size;
+    int last;
+    bool lines;
+} SpillMerge;
+
+/**
+ * Crea un file temporaneo per un run (eliminato alla chiusura).
+ *
+ * @return Il file creato.
+ */
+FILE *spill_create();
+
+/**
+ * Scrive una coppia di parole su un run (le coppie devono essere ordinate per parola e parola successiva).
+ *
+ * @param file Il run.
+ * @param pair La coppia.
+ */
+void spill_write_pair(FILE *file, SpillPair *pair);
+
+/**
+ * Scrive una riga su un run (le righe devono essere ordinate per ordine).
+ *
+ * @param file Il run.
+ * @param order L'ordine della riga.
+ * @param text Il testo della riga.
+ * @param length La lunghezza della riga.
+ */
+void spill_write_line(FILE *file, size_t order, char *text, size_t length);
+
+/**
+ * Inizializza un elenco di run vuoto.
+ *
+ * @param runs L'elenco.
+ * @param lines Indica se i run contengono righe invece di coppie di parole.
+ */
+void spill_runs_init(SpillRuns *runs, bool lines);
+
+/**
+ * Aggiunge un run a un elenco; se i run raggiungono SPILL_MAX_RUNS vengono uniti in un unico run.
+ *
+ * @param runs L'elenco.
+ * @param file Il run.
+ */
+void spill_runs_add(SpillRuns *runs, FILE *file);
+
+/**
+ * Distrugge un elenco di run, chiudendo i run rimasti.
+ *
+ * @param runs L'elenco.
+ */
+void spill_runs_destroy(SpillRuns *runs);
+
+/**
+ * Crea l'unione dei run di un elenco, che viene svuotato.
+ *
+ * @param runs L'elenco (i run vengono chiusi alla distruzione dell'unione).
+ * @return L'unione creata.
+ */
+SpillMerge *spill_merge_create(SpillRuns *runs);
+
+/**
+ * Restituisce la coppia di parole successiva di un'unione, in ordine di parola e parola successiva.
+ *
+ * @param merge L'unione.
+ * @return La coppia (valida fino alla chiamata successiva), NULL se i run sono terminati.
+ */
+SpillPair *spill_merge_pair(SpillMerge *merge);
+
+/**
+ * Restituisce la riga successiva di un'unione, in ordine di riga.
+ *
+ * @param merge L'unione.
+ * @return La riga (valida fino alla chiamata successiva), NULL se i run sono terminati.
+ */
+SpillLine *spill_merge_line(SpillMerge *merge);
+
+/**
+ * Distrugge un'unione di run, chiudendo i run.
+ *
+ * @param merge L'unione da distruggere.
+ */
+void spill_merge_destroy(SpillMerge *merge);
+
+#endif
\ No newline at end of file
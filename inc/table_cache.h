@@ -0,0 +1,89 @@
+#ifndef TABLE_CACHE_H
+#define TABLE_CACHE_H
+
+#include <stdio.h>
+
+#include "hashmap.h"
+
+/**
+ * Directory in memoria condivisa che contiene le directory della cache di ogni utente.
+ */
+#define TABLE_CACHE_DIRECTORY "/dev/shm"
+
+/**
+ * Prefisso del nome della directory della cache di un utente (seguito dall'identificativo dell'utente).
+ */
+#define TABLE_CACHE_PREFIX "wftable-"
+
+/**
+ * Tempo massimo, in secondi, dall'ultimo uso di un'immagine, oltre il quale l'immagine viene eliminata.
+ */
+#define TABLE_CACHE_MAX_AGE (7 * 24 * 60 * 60)
+
+/**
+ * Struttura che rappresenta l'immagine di una tabella nella cache.
+ *
+ * Le immagini sono tabelle compilate, salvate nella directory della cache dell'utente (directory),
+ * accessibile solo all'utente; il nome di un'immagine contiene un hash del percorso della tabella
+ * (stem), la dimensione e la data di modifica della tabella e la versione del formato, quindi
+ * un'immagine non viene mai usata per una tabella modificata. Il file di lock (uno per percorso)
+ * serializza la creazione delle immagini della stessa tabella e contiene il percorso della tabella
+ * (table_path), in modo che le immagini di una tabella eliminata o modificata possano essere
+ * riconosciute ed eliminate anche da altre esecuzioni.
+ */
+typedef struct {
+    char *directory;
+    char *table_path;
+    char *stem;
+    char *image_filename;
+    char *lock_filename;
+    int lock_fd;
+} TableCache;
+
+/**
+ * Crea il riferimento all'immagine di una tabella nella cache.
+ *
+ * @param table_file Il file della tabella.
+ * @param table_filename Il percorso della tabella.
+ * @return Il riferimento all'immagine, NULL se la tabella non è un file regolare o la cache dell'utente non è disponibile.
+ */
+TableCache *table_cache_create(FILE *table_file, char *table_filename);
+
+/**
+ * Mappa in sola lettura l'immagine di una tabella, se è presente nella cache.
+ *
+ * @param cache Il riferimento all'immagine.
+ * @return La tabella delle frequenze, NULL se l'immagine non è presente, non appartiene all'utente o non è valida.
+ */
+HashMap *table_cache_open(TableCache *cache);
+
+/**
+ * Acquisisce il lock per la creazione delle immagini della tabella (attendendo gli altri processi).
+ *
+ * @param cache Il riferimento all'immagine.
+ */
+void table_cache_lock(TableCache *cache);
+
+/**
+ * Rilascia il lock per la creazione delle immagini della tabella.
+ *
+ * @param cache Il riferimento all'immagine.
+ */
+void table_cache_unlock(TableCache *cache);
+
+/**
+ * Salva l'immagine di una tabella nella cache, eliminando le immagini non più valide.
+ *
+ * @param cache Il riferimento all'immagine.
+ * @param word_frequencies La tabella delle frequenze (compilata).
+ */
+void table_cache_store(TableCache *cache, HashMap *word_frequencies);
+
+/**
+ * Distrugge il riferimento all'immagine di una tabella, rilasciando il lock se è stato acquisito.
+ *
+ * @param cache Il riferimento all'immagine.
+ */
+void table_cache_destroy(TableCache *cache);
+
+#endif
\ No newline at end of file
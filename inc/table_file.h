@@ -0,0 +1,63 @@
+#ifndef TABLE_FILE_H
+#define TABLE_FILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hashmap.h"
+
+/**
+ * Identificativo dei file delle tabelle compilate.
+ */
+#define TABLE_FILE_MAGIC "WFTABLE"
+
+/**
+ * Versione del formato delle tabelle compilate, da incrementare a ogni modifica delle strutture della hashmap.
+ */
+#define TABLE_FILE_VERSION 3
+
+/**
+ * Struttura che rappresenta l'intestazione di un file di una tabella compilata.
+ *
+ * La regione della hashmap compilata segue l'intestazione a partire da region_offset (la dimensione
+ * di una pagina del sistema su cui è stato scritto) e viene mappata così com'è, quindi il file può
+ * essere letto solo con la stessa versione, lo stesso ordine dei byte e le stesse dimensioni dei
+ * tipi con cui è stato scritto.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t size_bytes;
+    uint32_t word_bytes;
+    uint64_t region_offset;
+    uint64_t region_size;
+} TableFileHeader;
+
+/**
+ * Scrive una tabella delle frequenze compilata su un file.
+ *
+ * @param word_frequencies La tabella delle frequenze (compilata).
+ * @param file Il file.
+ * @return true se la tabella è stata scritta, false altrimenti.
+ */
+bool table_file_write(HashMap *word_frequencies, FILE *file);
+
+/**
+ * Apre in sola lettura la tabella delle frequenze compilata contenuta in un file, senza leggerla.
+ *
+ * @param fd Il file descriptor del file.
+ * @return La tabella delle frequenze, NULL se il file non contiene una tabella compilata.
+ */
+HashMap *table_file_open(int fd);
+
+/**
+ * Apre in sola lettura la tabella delle frequenze compilata contenuta in un file, se è valida.
+ *
+ * @param fd Il file descriptor del file.
+ * @return La tabella delle frequenze, NULL se il file non contiene una tabella compilata valida.
+ */
+HashMap *table_file_load(int fd);
+
+#endif
\ No newline at end of file
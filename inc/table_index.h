@@ -0,0 +1,79 @@
+#ifndef TABLE_INDEX_H
+#define TABLE_INDEX_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Identificativo dei file degli indici delle tabelle.
+ */
+#define TABLE_INDEX_MAGIC "WFINDEX"
+
+/**
+ * Versione del formato degli indici delle tabelle.
+ */
+#define TABLE_INDEX_VERSION 1
+
+/**
+ * Struttura che rappresenta l'intestazione del file di un indice.
+ *
+ * L'indice è valido solo per la tabella con la dimensione e la data di modifica registrate; gli
+ * slot (slot_count, potenza di 2) seguono l'intestazione.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t table_size;
+    int64_t table_mtime;
+    int64_t table_mtime_nsec;
+    uint64_t slot_count;
+} TableIndexHeader;
+
+/**
+ * Struttura che rappresenta l'indice delle righe di una tabella in formato CSV.
+ *
+ * La tabella è mappata in memoria (table, di table_size byte); slots è una tabella hash a
+ * indirizzamento aperto che contiene, per la parola di ogni riga, l'offset della riga più uno
+ * (0 indica uno slot vuoto). Gli slot sono mappati dal file dell'indice (mapping, di mapping_size
+ * byte) oppure allocati se l'indice è stato costruito e non può essere salvato.
+ */
+typedef struct {
+    char *table;
+    size_t table_size;
+    uint64_t *slots;
+    size_t slot_count;
+    char *mapping;
+    size_t mapping_size;
+} TableIndex;
+
+/**
+ * Apre l'indice di una tabella, riusando il file dell'indice se corrisponde alla tabella e
+ * costruendolo e salvandolo altrimenti.
+ *
+ * @param table_file Il file della tabella.
+ * @param index_filename Il percorso del file dell'indice.
+ * @return L'indice, NULL se la tabella non è un file regolare.
+ */
+TableIndex *table_index_open(FILE *table_file, char *index_filename);
+
+/**
+ * Cerca la riga di una parola.
+ *
+ * @param index L'indice.
+ * @param word La parola.
+ * @param size La dimensione della riga (compreso l'eventuale a capo).
+ * @return L'inizio della riga nella tabella mappata, NULL se la parola non ha una riga.
+ */
+char *table_index_find(TableIndex *index, char *word, size_t *size);
+
+/**
+ * Chiude un indice, rimuovendo le mappature.
+ *
+ * @param index L'indice.
+ */
+void table_index_close(TableIndex *index);
+
+#endif
\ No newline at end of file
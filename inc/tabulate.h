@@ -5,13 +5,33 @@
 
 #include "hashmap.h"
 
+/**
+ * Enumerazione dei motori della modalità a più thread.
+ *
+ * ENGINE_MERGE costruisce una tabella per thread e le unisce per partizioni, ENGINE_SHARED fa
+ * inserire tutti i thread in un'unica tabella concorrente, ENGINE_SHUFFLE fa inviare le coppie di
+ * parole ai thread proprietari delle parole, che le contano senza lock, ENGINE_SORT ordina le
+ * coppie di parole con un radix sort e le conta scorrendole.
+ */
+typedef enum {
+    ENGINE_MERGE,
+    ENGINE_SHARED,
+    ENGINE_SHUFFLE,
+    ENGINE_SORT
+} TabulateEngine;
+
 /**
  * Converte un file di testo in una tabella di frequenze.
  *
  * @param input_file Il file di input.
  * @param output_file Il file di output.
  * @param multiprocess_mode La modalità multiprocessore.
+ * @param shared_memory_mode Indica se trasferire il testo su un ring buffer in memoria condivisa invece che su una pipe.
+ * @param jobs Il numero di processi tra cui suddividere il testo.
+ * @param threads Il numero di thread tra cui suddividere il testo.
+ * @param engine Il motore della modalità a più thread.
+ * @param max_memory La memoria massima in byte per la tabella (0 se non è limitata).
  */
-void tabulate(FILE *input_file, FILE *output_file, bool multiprocess_mode);
+void tabulate(FILE *input_file, FILE *output_file, bool multiprocess_mode, bool shared_memory_mode, int jobs, int threads, TabulateEngine engine, size_t max_memory);
 
 #endif
\ No newline at end of file
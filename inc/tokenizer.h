@@ -0,0 +1,81 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <stddef.h>
+#include <wchar.h>
+
+#include "constants.h"
+
+/**
+ * Numero di parole restituite al massimo da una scansione.
+ */
+#define TOKENIZER_BATCH_SIZE 256
+
+/**
+ * Struttura che rappresenta una parola del testo.
+ *
+ * word è la parola convertita in minuscolo (in UTF-8), terminator il segno di punteggiatura che la
+ * termina ('.', '?' o '!', '\0' se la parola termina in altro modo), end l'offset del blocco
+ * successivo al carattere che termina la parola.
+ */
+typedef struct {
+    char word[MAX_WORD_BYTES];
+    char terminator;
+    size_t end;
+} Token;
+
+/**
+ * Struttura che rappresenta un tokenizzatore.
+ *
+ * Le parole vengono scritte direttamente nell'array tokens: le prime count sono complete, quella
+ * in posizione count è la parola corrente (di index byte e length caratteri), che può proseguire
+ * nel blocco successivo. latin1_lower contiene la minuscola dei caratteri Latin-1 non ASCII
+ * (0 per gli spazi), in modo che non debbano essere convertiti uno alla volta.
+ */
+typedef struct {
+    Token tokens[TOKENIZER_BATCH_SIZE + 1];
+    size_t count;
+    int index;
+    int length;
+    wchar_t latin1_lower[128];
+} Tokenizer;
+
+/**
+ * Crea un tokenizzatore.
+ *
+ * @return Il tokenizzatore creato.
+ */
+Tokenizer *tokenizer_create();
+
+/**
+ * Scansiona un blocco del testo, fermandosi quando il gruppo di parole è pieno.
+ *
+ * @param tokenizer Il tokenizzatore (con il gruppo di parole vuoto).
+ * @param data Il blocco da scansionare (non divide mai un carattere).
+ * @param size La dimensione del blocco.
+ * @return Il numero di byte scansionati.
+ */
+size_t tokenizer_scan(Tokenizer *tokenizer, const unsigned char *data, size_t size);
+
+/**
+ * Termina il testo, completando la parola corrente.
+ *
+ * @param tokenizer Il tokenizzatore (con il gruppo di parole vuoto).
+ */
+void tokenizer_finish(Tokenizer *tokenizer);
+
+/**
+ * Svuota il gruppo di parole già consumate, conservando la parola corrente.
+ *
+ * @param tokenizer Il tokenizzatore.
+ */
+void tokenizer_clear(Tokenizer *tokenizer);
+
+/**
+ * Distrugge un tokenizzatore.
+ *
+ * @param tokenizer Il tokenizzatore da distruggere.
+ */
+void tokenizer_destroy(Tokenizer *tokenizer);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <stddef.h>
+#include <wchar.h>
+
+/**
+ * Restituisce la lunghezza della sequenza di lettere e cifre ASCII all'inizio di un buffer.
+ *
+ * Il buffer viene esaminato a blocchi di 16 byte (SSE2) o 32 byte (AVX2) quando disponibili.
+ *
+ * @param data Il buffer.
+ * @param size La dimensione del buffer.
+ * @return Il numero di byte della sequenza.
+ */
+size_t utf8_alnum_span(const unsigned char *data, size_t size);
+
+/**
+ * Copia una sequenza di lettere e cifre ASCII convertendola in minuscolo.
+ *
+ * @param destination La stringa di destinazione.
+ * @param source La sequenza da copiare.
+ * @param size La lunghezza della sequenza.
+ */
+void utf8_alnum_lower(char *destination, const unsigned char *source, size_t size);
+
+/**
+ * Decodifica un carattere UTF-8.
+ *
+ * @param data Il buffer da cui decodificare il carattere.
+ * @param size Il numero di byte disponibili nel buffer.
+ * @param character Il carattere decodificato.
+ * @return Il numero di byte del carattere, 0 se la sequenza è incompleta, (size_t)-1 se non è valida.
+ */
+size_t utf8_decode(const unsigned char *data, size_t size, wchar_t *character);
+
+/**
+ * Codifica un carattere in UTF-8.
+ *
+ * @param character Il carattere da codificare.
+ * @param destination La stringa di destinazione (almeno 4 byte disponibili).
+ * @return Il numero di byte scritti.
+ */
+size_t utf8_encode(wchar_t character, char *destination);
+
+/**
+ * Restituisce il numero di byte finali di un buffer che formano un carattere incompleto.
+ *
+ * @param data Il buffer.
+ * @param size La dimensione del buffer.
+ * @return Il numero di byte del carattere incompleto, 0 se il buffer termina con un carattere completo.
+ */
+size_t utf8_incomplete_suffix(const unsigned char *data, size_t size);
+
+#endif
\ No newline at end of file
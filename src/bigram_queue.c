@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bigram_queue.h"
+#include "error_handler.h"
+#include "ring.h"
+
+/**
+ * Pubblica le coppie di parole scritte dal produttore e risveglia il consumatore.
+ *
+ * @param queue La coda.
+ */
+void publish_bigrams(BigramQueue *queue);
+
+/**
+ * Crea una coda di coppie di parole.
+ *
+ * @param signal Il segnale del consumatore.
+ * @return La coda creata.
+ */
+BigramQueue *bigram_queue_create(BigramSignal *signal) {
+    // Allocazione della coda (allineata, in modo che i contatori del produttore e del consumatore stiano su linee di cache diverse)
+    BigramQueue *queue = (BigramQueue *)aligned_alloc(64, sizeof(BigramQueue));
+    if (!queue) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Inizializzazione della coda
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->closed, false);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->space_signal, 0);
+    atomic_init(&queue->producer_waiting, false);
+    queue->written = 0;
+    queue->cached_tail = 0;
+    queue->signal = signal;
+
+    // Restituzione della coda
+    return queue;
+}
+
+/**
+ * Distrugge una coda di coppie di parole.
+ *
+ * @param queue La coda da distruggere.
+ */
+void bigram_queue_destroy(BigramQueue *queue) {
+    free(queue);
+}
+
+/**
+ * Aggiunge una coppia di parole alla coda, attendendo se è piena.
+ *
+ * @param queue La coda.
+ * @param bigram La coppia di parole.
+ */
+void bigram_queue_push(BigramQueue *queue, Bigram bigram) {
+    // tail viene riletto solo quando la coda sembra piena
+    if (queue->written - queue->cached_tail == BIGRAM_QUEUE_CAPACITY) {
+        // Le coppie scritte vengono pubblicate, altrimenti il consumatore non potrebbe liberare spazio
+        publish_bigrams(queue);
+
+        while ((queue->cached_tail = atomic_load(&queue->tail)) + BIGRAM_QUEUE_CAPACITY == queue->written) {
+            atomic_store(&queue->producer_waiting, true);
+
+            // Il segnale viene letto prima di ricontrollare tail, quindi un rilascio successivo non viene perso
+            uint32_t signal = atomic_load(&queue->space_signal);
+            if (atomic_load(&queue->tail) + BIGRAM_QUEUE_CAPACITY == queue->written) futex_wait(&queue->space_signal, signal);
+
+            atomic_store(&queue->producer_waiting, false);
+        }
+    }
+
+    // Scrittura della coppia, pubblicata a gruppi
+    queue->items[queue->written++ & (BIGRAM_QUEUE_CAPACITY - 1)] = bigram;
+
+    if (queue->written - atomic_load_explicit(&queue->head, memory_order_relaxed) >= BIGRAM_QUEUE_BATCH) publish_bigrams(queue);
+}
+
+/**
+ * Pubblica le coppie di parole ancora da pubblicare e chiude la coda.
+ *
+ * @param queue La coda.
+ */
+void bigram_queue_close(BigramQueue *queue) {
+    atomic_store(&queue->head, queue->written);
+
+    // Chiusura della coda e risveglio del consumatore
+    atomic_store(&queue->closed, true);
+    atomic_fetch_add(&queue->signal->data_signal, 1);
+    if (atomic_load(&queue->signal->consumer_waiting)) futex_wake(&queue->signal->data_signal);
+}
+
+/**
+ * Restituisce le coppie di parole pubblicate e non ancora lette, senza attendere e senza copiarle.
+ *
+ * @param queue La coda.
+ * @param items Il puntatore alle coppie.
+ * @return Il numero di coppie contigue disponibili (0 se la coda è vuota).
+ */
+size_t bigram_queue_acquire(BigramQueue *queue, Bigram **items) {
+    // Solo il consumatore modifica tail
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    size_t head = atomic_load(&queue->head);
+
+    // Le coppie vengono restituite fino alla fine dell'array, le successive alla chiamata seguente
+    size_t index = tail & (BIGRAM_QUEUE_CAPACITY - 1);
+    size_t count = head - tail;
+    if (count > BIGRAM_QUEUE_CAPACITY - index) count = BIGRAM_QUEUE_CAPACITY - index;
+
+    *items = queue->items + index;
+    return count;
+}
+
+/**
+ * Libera le coppie di parole lette, rendendo lo spazio disponibile al produttore.
+ *
+ * @param queue La coda.
+ * @param count Il numero di coppie lette.
+ */
+void bigram_queue_release(BigramQueue *queue, size_t count) {
+    if (count == 0) return;
+
+    // Avanzamento di tail e risveglio del produttore
+    atomic_fetch_add(&queue->tail, count);
+    atomic_fetch_add(&queue->space_signal, 1);
+    if (atomic_load(&queue->producer_waiting)) futex_wake(&queue->space_signal);
+}
+
+/**
+ * Verifica se una coda è stata chiusa ed è vuota.
+ *
+ * @param queue La coda.
+ * @return true se la coda è stata chiusa ed è vuota, false altrimenti.
+ */
+bool bigram_queue_finished(BigramQueue *queue) {
+    // closed viene letto prima di head, quindi le coppie pubblicate alla chiusura non vengono perse
+    return atomic_load(&queue->closed) && atomic_load(&queue->head) == atomic_load(&queue->tail);
+}
+
+/**
+ * Attende che almeno una delle code di un consumatore abbia dati o sia stata chiusa.
+ *
+ * @param signal Il segnale del consumatore.
+ * @param queues Le code non ancora terminate del consumatore.
+ * @param count Il numero di code.
+ */
+void bigram_queue_wait(BigramSignal *signal, BigramQueue **queues, int count) {
+    atomic_store(&signal->consumer_waiting, true);
+
+    // Il segnale viene letto prima di ricontrollare le code, quindi una pubblicazione successiva non viene persa
+    uint32_t value = atomic_load(&signal->data_signal);
+
+    bool ready = false;
+    for (int i = 0; i < count && !ready; i++) {
+        ready = atomic_load(&queues[i]->closed) || atomic_load(&queues[i]->head) != atomic_load(&queues[i]->tail);
+    }
+
+    if (!ready) futex_wait(&signal->data_signal, value);
+
+    atomic_store(&signal->consumer_waiting, false);
+}
+
+/**
+ * Pubblica le coppie di parole scritte dal produttore e risveglia il consumatore.
+ *
+ * @param queue La coda.
+ */
+void publish_bigrams(BigramQueue *queue) {
+    atomic_store(&queue->head, queue->written);
+
+    atomic_fetch_add(&queue->signal->data_signal, 1);
+    if (atomic_load(&queue->signal->consumer_waiting)) futex_wake(&queue->signal->data_signal);
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bigram_sort.h"
+#include "error_handler.h"
+
+/**
+ * Capacità iniziale di un array di coppie di parole.
+ */
+#define INITIAL_CAPACITY 4096
+
+/**
+ * Numero di valori di una cifra del radix sort.
+ */
+#define DIGIT_VALUES (1 << BIGRAM_SORT_DIGIT_BITS)
+
+/**
+ * Struttura che rappresenta lo stato condiviso dai thread del radix sort.
+ *
+ * Ogni passata sposta le coppie da source a destination in base a una cifra della chiave
+ * (word << word_bits | next_word); nella prima passata ogni thread legge il proprio array,
+ * nelle successive una parte uguale di source. histograms contiene i conteggi delle cifre
+ * di ogni thread (DIGIT_VALUES per thread).
+ */
+typedef struct {
+    BigramArray *arrays;
+    int thread_count;
+    int word_bits;
+    int passes;
+    size_t size;
+    BigramRecord *buffers[2];
+    size_t *histograms;
+    pthread_barrier_t barrier;
+} SortContext;
+
+/**
+ * Struttura che rappresenta un thread del radix sort.
+ */
+typedef struct {
+    SortContext *context;
+    int index;
+} SortTask;
+
+/**
+ * Esegue le passate del radix sort sulla parte di un thread.
+ *
+ * @param argument Il thread (SortTask).
+ * @return NULL.
+ */
+void *sort_bigrams(void *argument);
+
+/**
+ * Inizializza un array di coppie di parole vuoto.
+ *
+ * @param array L'array.
+ */
+void bigram_array_init(BigramArray *array) {
+    array->records = NULL;
+    array->count = 0;
+    array->capacity = 0;
+}
+
+/**
+ * Aggiunge una coppia di parole a un array, ingrandendolo se necessario.
+ *
+ * @param array L'array.
+ * @param word L'identificativo della parola.
+ * @param next_word L'identificativo della parola successiva.
+ * @param position La posizione della coppia nel testo.
+ */
+void bigram_array_push(BigramArray *array, unsigned int word, unsigned int next_word, size_t position) {
+    // Se l'array è pieno la capacità viene raddoppiata
+    if (array->count == array->capacity) {
+        array->capacity = array->capacity ? array->capacity * 2 : INITIAL_CAPACITY;
+
+        array->records = (BigramRecord *)realloc(array->records, array->capacity * sizeof(BigramRecord));
+        if (!array->records) error_handler(ERR_MEMORY_ALLOCATION);
+    }
+
+    array->records[array->count++] = (BigramRecord){ word, next_word, position };
+}
+
+/**
+ * Ordina le coppie di parole di più array con un radix sort LSD stabile, usando un thread per array.
+ *
+ * La chiave è formata dagli identificativi delle due parole, ciascuno di word_bits bit, quindi il
+ * numero di passate dipende dal numero di parole e non dal numero di coppie.
+ *
+ * @param arrays Gli array.
+ * @param count Il numero di array.
+ * @param word_count Il numero di identificativi delle parole.
+ * @param size Il numero di coppie ordinate.
+ * @return Le coppie ordinate (da deallocare).
+ */
+BigramRecord *bigram_sort(BigramArray *arrays, int count, size_t word_count, size_t *size) {
+    SortContext context;
+
+    context.arrays = arrays;
+    context.thread_count = count;
+
+    // Bit necessari per un identificativo e passate necessarie per la chiave
+    context.word_bits = 1;
+    while (((size_t)1 << context.word_bits) < word_count) context.word_bits++;
+
+    context.passes = (2 * context.word_bits + BIGRAM_SORT_DIGIT_BITS - 1) / BIGRAM_SORT_DIGIT_BITS;
+
+    // Numero totale di coppie
+    context.size = 0;
+    for (int i = 0; i < count; i++) context.size += arrays[i].count;
+
+    // Allocazione dei buffer e dei conteggi
+    context.buffers[0] = (BigramRecord *)malloc((context.size + 1) * sizeof(BigramRecord));
+    context.buffers[1] = (BigramRecord *)malloc((context.size + 1) * sizeof(BigramRecord));
+    context.histograms = (size_t *)malloc(count * DIGIT_VALUES * sizeof(size_t));
+    if (!context.buffers[0] || !context.buffers[1] || !context.histograms) error_handler(ERR_MEMORY_ALLOCATION);
+
+    if (pthread_barrier_init(&context.barrier, NULL, count) != 0) error_handler(ERR_PARALLELIZATION);
+
+    // Avvio dei thread
+    SortTask tasks[count];
+    pthread_t thread_ids[count];
+
+    for (int i = 0; i < count; i++) {
+        tasks[i] = (SortTask){ &context, i };
+
+        if (pthread_create(&thread_ids[i], NULL, sort_bigrams, &tasks[i]) != 0) error_handler(ERR_PARALLELIZATION);
+    }
+
+    for (int i = 0; i < count; i++) pthread_join(thread_ids[i], NULL);
+
+    pthread_barrier_destroy(&context.barrier);
+    free(context.histograms);
+
+    // La passata p scrive nel buffer p % 2, quindi il risultato è nel buffer dell'ultima passata
+    int result = (context.passes - 1) % 2;
+    free(context.buffers[1 - result]);
+
+    *size = context.size;
+    return context.buffers[result];
+}
+
+/**
+ * Esegue le passate del radix sort sulla parte di un thread.
+ *
+ * Ogni thread conta le cifre della propria parte; dopo una barriera calcola, da tutti i conteggi,
+ * la posizione di ogni cifra nella destinazione (prima le cifre minori, a parità di cifra le parti
+ * dei thread precedenti), quindi l'ordinamento è stabile.
+ *
+ * @param argument Il thread (SortTask).
+ * @return NULL.
+ */
+void *sort_bigrams(void *argument) {
+    SortTask *task = (SortTask *)argument;
+    SortContext *context = task->context;
+
+    size_t *histogram = context->histograms + task->index * DIGIT_VALUES;
+    size_t offsets[DIGIT_VALUES];
+
+    for (int pass = 0; pass < context->passes; pass++) {
+        // Parte del thread: il proprio array nella prima passata, una parte uguale del buffer nelle successive
+        BigramRecord *source;
+        size_t count;
+
+        if (pass == 0) {
+            source = context->arrays[task->index].records;
+            count = context->arrays[task->index].count;
+        } else {
+            size_t start = context->size * task->index / context->thread_count;
+            size_t end = context->size * (task->index + 1) / context->thread_count;
+
+            source = context->buffers[(pass - 1) % 2] + start;
+            count = end - start;
+        }
+
+        BigramRecord *destination = context->buffers[pass % 2];
+        int shift = pass * BIGRAM_SORT_DIGIT_BITS;
+
+        // Conteggio delle cifre della parte
+        memset(histogram, 0, DIGIT_VALUES * sizeof(size_t));
+
+        for (size_t i = 0; i < count; i++) {
+            uint64_t key = (uint64_t)source[i].word << context->word_bits | source[i].next_word;
+            histogram[(key >> shift) & (DIGIT_VALUES - 1)]++;
+        }
+
+        pthread_barrier_wait(&context->barrier);
+
+        // Posizione della prima coppia di ogni cifra nella destinazione
+        size_t offset = 0;
+
+        for (int digit = 0; digit < DIGIT_VALUES; digit++) {
+            for (int thread = 0; thread < context->thread_count; thread++) {
+                if (thread == task->index) offsets[digit] = offset;
+                offset += context->histograms[thread * DIGIT_VALUES + digit];
+            }
+        }
+
+        // Distribuzione delle coppie, nel loro ordine
+        for (size_t i = 0; i < count; i++) {
+            uint64_t key = (uint64_t)source[i].word << context->word_bits | source[i].next_word;
+            destination[offsets[(key >> shift) & (DIGIT_VALUES - 1)]++] = source[i];
+        }
+
+        // Tutti i thread devono aver letto i conteggi e scritto le coppie prima della passata successiva
+        pthread_barrier_wait(&context->barrier);
+
+        // Dopo la prima passata l'array del thread non serve più
+        if (pass == 0) {
+            free(context->arrays[task->index].records);
+            bigram_array_init(&context->arrays[task->index]);
+        }
+    }
+
+    return NULL;
+}
\ No newline at end of file
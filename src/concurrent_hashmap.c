@@ -0,0 +1,791 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "concurrent_hashmap.h"
+#include "hashmap.h"
+#include "error_handler.h"
+
+/**
+ * Dimensione iniziale della tabella delle parole (potenza di due).
+ */
+#define INITIAL_SIZE 1024
+
+/**
+ * Dimensione dei blocchi della regione da cui i thread allocano parole e nodi.
+ */
+#define SLAB_SIZE (64 * 1024)
+
+/**
+ * Numero di slot spostati alla volta da un thread durante il ridimensionamento.
+ */
+#define MIGRATION_CHUNK 1024
+
+/**
+ * Numero di parole successive oltre il quale vengono indicizzate (sotto la soglia la lista viene
+ * scorsa confrontando gli offset).
+ */
+#define SUCCESSOR_INDEX_THRESHOLD 8
+
+/**
+ * Bit che indica uno slot bloccato dal ridimensionamento (gli offset sono multipli di 8, quindi il
+ * bit è sempre libero); uno slot vuoto bloccato vale FROZEN.
+ */
+#define FROZEN ((size_t)1)
+
+/**
+ * Alloca un oggetto dalla regione di una hashmap concorrente.
+ *
+ * @param map La hashmap.
+ * @param size La dimensione dell'oggetto.
+ * @return L'offset dell'oggetto (inizializzato a zero).
+ */
+size_t allocate_region(ConcurrentHashMap *map, size_t size);
+
+/**
+ * Alloca una parola, un nodo o un indice dal blocco corrente di un thread, allocando un nuovo blocco se necessario.
+ *
+ * @param writer Il thread.
+ * @param size La dimensione dell'oggetto.
+ * @return L'offset dell'oggetto (inizializzato a zero).
+ */
+size_t allocate_shared_record(ConcurrentWriter *writer, size_t size);
+
+/**
+ * Crea una parola, senza pubblicarla nella tabella.
+ *
+ * @param writer Il thread.
+ * @param word Il testo della parola.
+ * @param word_hash L'hash della parola.
+ * @return L'offset della parola creata.
+ */
+size_t create_shared_word(ConcurrentWriter *writer, char *word, unsigned int word_hash);
+
+/**
+ * Crea una tabella delle parole vuota.
+ *
+ * @param map La hashmap.
+ * @param size Il numero di slot (potenza di due).
+ * @return L'offset della tabella creata.
+ */
+size_t create_shared_table(ConcurrentHashMap *map, size_t size);
+
+/**
+ * Restituisce una tabella delle parole a partire dal suo offset.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset della tabella.
+ * @return La tabella.
+ */
+ConcurrentTable *get_shared_table(ConcurrentHashMap *map, size_t offset);
+
+/**
+ * Avvia il ridimensionamento di una tabella, se nessun altro thread lo ha già avviato.
+ *
+ * @param map La hashmap.
+ * @param table La tabella da ridimensionare.
+ */
+void start_resize(ConcurrentHashMap *map, ConcurrentTable *table);
+
+/**
+ * Sposta un blocco di slot di una tabella in ridimensionamento nella tabella successiva.
+ *
+ * Il thread che sposta l'ultimo blocco rende corrente la tabella successiva.
+ *
+ * @param map La hashmap.
+ * @param table La tabella in ridimensionamento.
+ */
+void help_migration(ConcurrentHashMap *map, ConcurrentTable *table);
+
+/**
+ * Inserisce in una tabella una parola che sicuramente non è presente.
+ *
+ * @param map La hashmap.
+ * @param table La tabella.
+ * @param word L'offset della parola.
+ */
+void place_shared_word(ConcurrentHashMap *map, ConcurrentTable *table, size_t word);
+
+/**
+ * Completa un ridimensionamento lasciato in corso dai thread (quando nessun thread inserisce più).
+ *
+ * @param map La hashmap.
+ * @return La tabella corrente.
+ */
+ConcurrentTable *finish_migration(ConcurrentHashMap *map);
+
+/**
+ * Calcola l'hash dell'offset di una parola successiva, usato dall'indice dei nodi.
+ *
+ * @param offset L'offset della parola.
+ * @return L'hash dell'offset.
+ */
+size_t hash_offset(size_t offset);
+
+/**
+ * Cerca il nodo di una parola successiva (con il lock dell'entry).
+ *
+ * Se l'entry ha più di SUCCESSOR_INDEX_THRESHOLD parole successive e non ha ancora un indice,
+ * l'indice viene creato.
+ *
+ * @param writer Il thread.
+ * @param entry L'entry.
+ * @param next_word L'offset della parola successiva.
+ * @return Il nodo della parola successiva, NULL se non è presente.
+ */
+ConcurrentNode *find_shared_node(ConcurrentWriter *writer, ConcurrentWord *entry, size_t next_word);
+
+/**
+ * Inserisce un nodo nell'indice delle parole successive di una entry, ingrandendolo se necessario (con il lock dell'entry).
+ *
+ * @param writer Il thread.
+ * @param entry L'entry (con indice).
+ * @param node L'offset del nodo.
+ */
+void index_shared_node(ConcurrentWriter *writer, ConcurrentWord *entry, size_t node);
+
+/**
+ * Confronta due entry in base alla loro prima occorrenza nel testo.
+ *
+ * @param first La prima entry.
+ * @param second La seconda entry.
+ * @return Un numero negativo, nullo o positivo se la prima entry precede, coincide o segue la seconda.
+ */
+int compare_entries(const void *first, const void *second);
+
+/**
+ * Confronta due nodi in ordine inverso di prima occorrenza nel testo.
+ *
+ * @param first Il primo nodo.
+ * @param second Il secondo nodo.
+ * @return Un numero negativo, nullo o positivo se il primo nodo precede, coincide o segue il secondo.
+ */
+int compare_nodes(const void *first, const void *second);
+
+/**
+ * Crea una nuova hashmap concorrente.
+ *
+ * @return La hashmap creata.
+ */
+ConcurrentHashMap *concurrent_hashmap_create() {
+    // Allocazione della hashmap
+    ConcurrentHashMap *map = (ConcurrentHashMap *)malloc(sizeof(ConcurrentHashMap));
+    if (!map) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // La regione è privata, perché i thread condividono lo spazio di indirizzamento
+    map->region = region_create(-1);
+    if (pthread_mutex_init(&map->region_lock, NULL) != 0) error_handler(ERR_PARALLELIZATION);
+
+    for (int i = 0; i < CONCURRENT_HASHMAP_LOCKS; i++) {
+        if (pthread_mutex_init(&map->locks[i], NULL) != 0) error_handler(ERR_PARALLELIZATION);
+    }
+
+    // Allocazione della tabella delle parole
+    atomic_init(&map->table, create_shared_table(map, INITIAL_SIZE));
+    atomic_init(&map->word_count, 0);
+
+    // Restituzione della hashmap
+    return map;
+}
+
+/**
+ * Distrugge una hashmap concorrente (quando nessun thread la usa più).
+ *
+ * @param map La hashmap da distruggere.
+ */
+void concurrent_hashmap_destroy(ConcurrentHashMap *map) {
+    // Distruzione dei lock
+    pthread_mutex_destroy(&map->region_lock);
+    for (int i = 0; i < CONCURRENT_HASHMAP_LOCKS; i++) pthread_mutex_destroy(&map->locks[i]);
+
+    // Deallocazione della regione, che contiene tabelle, parole e nodi
+    region_destroy(map->region);
+
+    // Deallocazione della hashmap
+    free(map);
+}
+
+/**
+ * Crea un thread che inserisce in una hashmap concorrente.
+ *
+ * @param map La hashmap.
+ * @return Il thread creato.
+ */
+ConcurrentWriter *concurrent_writer_create(ConcurrentHashMap *map) {
+    // Allocazione del thread
+    ConcurrentWriter *writer = (ConcurrentWriter *)malloc(sizeof(ConcurrentWriter));
+    if (!writer) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Il primo blocco viene allocato al primo inserimento
+    writer->map = map;
+    writer->slab = 0;
+    writer->slab_end = 0;
+
+    // Restituzione del thread
+    return writer;
+}
+
+/**
+ * Distrugge un thread che inserisce in una hashmap concorrente (le parole allocate restano nella hashmap).
+ *
+ * @param writer Il thread da distruggere.
+ */
+void concurrent_writer_destroy(ConcurrentWriter *writer) {
+    free(writer);
+}
+
+/**
+ * Restituisce una parola, aggiungendola alla hashmap se non è presente.
+ *
+ * La parola viene cercata nella tabella corrente; se la tabella è in ridimensionamento e la parola
+ * non è presente, il primo slot vuoto della sequenza di probing viene bloccato (in modo che
+ * nessun thread possa più inserirvi la parola) e la ricerca prosegue nella tabella successiva.
+ *
+ * @param writer Il thread che inserisce.
+ * @param word Il testo della parola.
+ * @return La parola (lo stesso per tutti i thread).
+ */
+ConcurrentWord *concurrent_hashmap_intern(ConcurrentWriter *writer, char *word) {
+    ConcurrentHashMap *map = writer->map;
+    unsigned int word_hash = hash(word);
+
+    // La parola viene creata solo quando serve inserirla
+    size_t created = 0;
+
+    size_t table_offset = atomic_load(&map->table);
+    ConcurrentTable *table = get_shared_table(map, table_offset);
+
+    // Se è in corso un ridimensionamento, il thread sposta un blocco di slot prima di inserire
+    if (atomic_load(&table->next)) help_migration(map, table);
+
+    while (true) {
+        size_t mask = table->size - 1;
+        size_t index = word_hash & mask;
+
+        for (size_t probes = 0; probes < table->size; probes++) {
+            size_t slot = atomic_load(&table->slots[index]);
+
+            if (slot == 0) {
+                // Durante il ridimensionamento lo slot vuoto viene bloccato e la parola viene inserita nella tabella successiva
+                if (atomic_load(&table->next)) {
+                    if (atomic_compare_exchange_strong(&table->slots[index], &slot, FROZEN)) break;
+                    continue;
+                }
+
+                if (!created) created = create_shared_word(writer, word, word_hash);
+
+                // Pubblicazione della parola (se un altro thread ha occupato lo slot, viene riesaminato)
+                if (!atomic_compare_exchange_strong(&table->slots[index], &slot, created)) continue;
+
+                // Se il fattore di carico supera quello massimo viene avviato il ridimensionamento (solo della tabella corrente)
+                size_t count = atomic_fetch_add(&table->count, 1) + 1;
+                if (count > table->size * HASHMAP_MAX_LOAD_FACTOR && table_offset == atomic_load(&map->table)) start_resize(map, table);
+
+                return concurrent_hashmap_word(map, created);
+            }
+
+            // Slot vuoto bloccato: la parola non è presente nella tabella
+            if (slot == FROZEN) break;
+
+            // Le parole bloccate sono ancora valide, perché non vengono mai spostate
+            ConcurrentWord *found = concurrent_hashmap_word(map, slot & ~FROZEN);
+
+            if (found->hash == word_hash && strcmp(found->text, word) == 0) {
+                // La parola creata e non pubblicata viene restituita al blocco del thread
+                if (created) writer->slab = created;
+
+                return found;
+            }
+
+            // Slot successivo
+            index = (index + 1) & mask;
+        }
+
+        // La ricerca prosegue nella tabella successiva (se la tabella è piena, viene avviato il ridimensionamento)
+        size_t next;
+        while (!(next = atomic_load(&table->next))) start_resize(map, table);
+
+        table_offset = next;
+        table = get_shared_table(map, table_offset);
+    }
+}
+
+/**
+ * Inserisce un nodo in una hashmap concorrente.
+ *
+ * @param writer Il thread che inserisce.
+ * @param word La parola.
+ * @param next_word La parola successiva.
+ * @param position La posizione della coppia di parole nel testo (distinta per ogni inserimento).
+ */
+void concurrent_hashmap_insert(ConcurrentWriter *writer, ConcurrentWord *word, ConcurrentWord *next_word, size_t position) {
+    // L'entry viene modificata tenendo il lock scelto dall'hash della parola
+    pthread_mutex_t *lock = &writer->map->locks[word->hash & (CONCURRENT_HASHMAP_LOCKS - 1)];
+
+    pthread_mutex_lock(lock);
+    concurrent_hashmap_insert_owned(writer, word, next_word, position);
+    pthread_mutex_unlock(lock);
+}
+
+/**
+ * Inserisce un nodo in una hashmap concorrente senza lock.
+ *
+ * @param writer Il thread che inserisce.
+ * @param word La parola (modificata solo da questo thread, ad esempio perché le parole sono suddivise tra i thread).
+ * @param next_word La parola successiva.
+ * @param position La posizione della coppia di parole nel testo (distinta per ogni inserimento).
+ */
+void concurrent_hashmap_insert_owned(ConcurrentWriter *writer, ConcurrentWord *word, ConcurrentWord *next_word, size_t position) {
+    ConcurrentHashMap *map = writer->map;
+    size_t next_offset = (char *)next_word - map->region->base;
+
+    // Viene incrementato il numero di occorrenze della parola e aggiornata la sua prima occorrenza
+    word->count++;
+    if (position < word->order) word->order = position;
+
+    // Se esiste un nodo per la parola successiva, viene incrementato il numero di occorrenze
+    ConcurrentNode *node = find_shared_node(writer, word, next_offset);
+
+    if (node) {
+        node->count++;
+        if (position < node->order) node->order = position;
+        return;
+    }
+
+    // Se non esiste un nodo per la parola successiva, viene creato e inserito in testa alla lista
+    size_t offset = allocate_shared_record(writer, sizeof(ConcurrentNode));
+    node = region_pointer(map->region, offset);
+
+    node->next_word = next_offset;
+    node->count = 1;
+    node->order = position;
+    node->next = word->next_words;
+
+    word->next_words = offset;
+    word->size++;
+
+    if (word->successors) index_shared_node(writer, word, offset);
+}
+
+/**
+ * Restituisce le entry di una hashmap concorrente (quando nessun thread inserisce più).
+ *
+ * @param map La hashmap.
+ * @param count Il numero di entry.
+ * @return Le entry in ordine di prima occorrenza nel testo (da deallocare).
+ */
+ConcurrentWord **concurrent_hashmap_entries(ConcurrentHashMap *map, size_t *count) {
+    ConcurrentTable *table = finish_migration(map);
+
+    // Allocazione dell'array delle entry
+    ConcurrentWord **entries = (ConcurrentWord **)malloc((atomic_load(&table->count) + 1) * sizeof(ConcurrentWord *));
+    if (!entries) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Le parole senza occorrenze come parola precedente non hanno un'entry
+    *count = 0;
+
+    for (size_t i = 0; i < table->size; i++) {
+        ConcurrentWord *word = concurrent_hashmap_word(map, atomic_load(&table->slots[i]));
+        if (word && word->count) entries[(*count)++] = word;
+    }
+
+    // Ordinamento delle entry, che non dipende dalla disposizione della tabella né dall'ordine dei thread
+    qsort(entries, *count, sizeof(ConcurrentWord *), compare_entries);
+
+    return entries;
+}
+
+/**
+ * Restituisce le parole di una hashmap concorrente indicizzate per identificativo (quando nessun thread inserisce più).
+ *
+ * @param map La hashmap.
+ * @param count Il numero di identificativi assegnati.
+ * @return Le parole (NULL per gli identificativi di parole create e non pubblicate, da deallocare).
+ */
+ConcurrentWord **concurrent_hashmap_words(ConcurrentHashMap *map, size_t *count) {
+    ConcurrentTable *table = finish_migration(map);
+
+    // Allocazione dell'array delle parole
+    *count = atomic_load(&map->word_count);
+
+    ConcurrentWord **words = (ConcurrentWord **)calloc(*count + 1, sizeof(ConcurrentWord *));
+    if (!words) error_handler(ERR_MEMORY_ALLOCATION);
+
+    for (size_t i = 0; i < table->size; i++) {
+        ConcurrentWord *word = concurrent_hashmap_word(map, atomic_load(&table->slots[i]));
+        if (word) words[word->id] = word;
+    }
+
+    return words;
+}
+
+/**
+ * Restituisce i nodi di un'entry di una hashmap concorrente (quando nessun thread inserisce più).
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ * @param nodes I nodi in ordine inverso di prima occorrenza nel testo (size elementi).
+ */
+void concurrent_hashmap_nodes(ConcurrentHashMap *map, ConcurrentWord *entry, ConcurrentNode **nodes) {
+    size_t index = 0;
+
+    for (ConcurrentNode *node = region_pointer(map->region, entry->next_words); node; node = region_pointer(map->region, node->next)) {
+        nodes[index++] = node;
+    }
+
+    // L'ultima parola successiva comparsa viene per prima, come nella lista della hashmap
+    qsort(nodes, index, sizeof(ConcurrentNode *), compare_nodes);
+}
+
+/**
+ * Restituisce una parola a partire dal suo offset.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset della parola.
+ * @return La parola, NULL se l'offset è 0.
+ */
+ConcurrentWord *concurrent_hashmap_word(ConcurrentHashMap *map, size_t offset) {
+    return (ConcurrentWord *)region_pointer(map->region, offset);
+}
+
+/**
+ * Alloca un oggetto dalla regione di una hashmap concorrente.
+ *
+ * @param map La hashmap.
+ * @param size La dimensione dell'oggetto.
+ * @return L'offset dell'oggetto (inizializzato a zero).
+ */
+size_t allocate_region(ConcurrentHashMap *map, size_t size) {
+    // La regione viene estesa da un thread alla volta (la memoria della regione privata è azzerata)
+    pthread_mutex_lock(&map->region_lock);
+    size_t offset = region_allocate(map->region, size);
+    pthread_mutex_unlock(&map->region_lock);
+
+    return offset;
+}
+
+/**
+ * Alloca una parola, un nodo o un indice dal blocco corrente di un thread, allocando un nuovo blocco se necessario.
+ *
+ * @param writer Il thread.
+ * @param size La dimensione dell'oggetto.
+ * @return L'offset dell'oggetto (inizializzato a zero).
+ */
+size_t allocate_shared_record(ConcurrentWriter *writer, size_t size) {
+    // Gli oggetti vengono allineati a 8 byte, in modo che il bit FROZEN degli offset sia libero
+    size = (size + 7) & ~(size_t)7;
+
+    // Gli oggetti grandi (gli indici) vengono allocati direttamente dalla regione
+    if (size > SLAB_SIZE / 4) return allocate_region(writer->map, size);
+
+    // Se il blocco corrente è esaurito ne viene allocato uno nuovo (lo spazio rimasto nel vecchio non viene usato)
+    if (writer->slab_end - writer->slab < size) {
+        writer->slab = allocate_region(writer->map, SLAB_SIZE);
+        writer->slab_end = writer->slab + SLAB_SIZE;
+    }
+
+    // L'oggetto viene allocato spostando l'inizio dello spazio libero
+    size_t offset = writer->slab;
+    writer->slab += size;
+
+    return offset;
+}
+
+/**
+ * Crea una parola, senza pubblicarla nella tabella.
+ *
+ * @param writer Il thread.
+ * @param word Il testo della parola.
+ * @param word_hash L'hash della parola.
+ * @return L'offset della parola creata.
+ */
+size_t create_shared_word(ConcurrentWriter *writer, char *word, unsigned int word_hash) {
+    size_t length = strlen(word);
+
+    // Allocazione della parola
+    size_t offset = allocate_shared_record(writer, sizeof(ConcurrentWord) + length + 1);
+    ConcurrentWord *created = concurrent_hashmap_word(writer->map, offset);
+
+    // Inizializzazione della parola, che non ha ancora un'entry
+    created->hash = word_hash;
+    created->id = atomic_fetch_add(&writer->map->word_count, 1);
+    created->count = 0;
+    created->order = SIZE_MAX;
+    created->next_words = 0;
+    created->size = 0;
+    created->successors = 0;
+    created->successors_size = 0;
+    memcpy(created->text, word, length + 1);
+
+    // Restituzione della parola
+    return offset;
+}
+
+/**
+ * Crea una tabella delle parole vuota.
+ *
+ * @param map La hashmap.
+ * @param size Il numero di slot (potenza di due).
+ * @return L'offset della tabella creata.
+ */
+size_t create_shared_table(ConcurrentHashMap *map, size_t size) {
+    // Allocazione della tabella (la regione è inizializzata a zero, quindi gli slot sono vuoti)
+    size_t offset = allocate_region(map, sizeof(ConcurrentTable) + size * sizeof(size_t));
+    ConcurrentTable *table = get_shared_table(map, offset);
+
+    // Inizializzazione della tabella
+    table->size = size;
+    atomic_init(&table->count, 0);
+    atomic_init(&table->resizing, 0);
+    atomic_init(&table->next, 0);
+    atomic_init(&table->claimed, 0);
+    atomic_init(&table->migrated, 0);
+
+    // Restituzione della tabella
+    return offset;
+}
+
+/**
+ * Restituisce una tabella delle parole a partire dal suo offset.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset della tabella.
+ * @return La tabella.
+ */
+ConcurrentTable *get_shared_table(ConcurrentHashMap *map, size_t offset) {
+    return (ConcurrentTable *)region_pointer(map->region, offset);
+}
+
+/**
+ * Avvia il ridimensionamento di una tabella, se nessun altro thread lo ha già avviato.
+ *
+ * @param map La hashmap.
+ * @param table La tabella da ridimensionare.
+ */
+void start_resize(ConcurrentHashMap *map, ConcurrentTable *table) {
+    // Solo un thread alloca la tabella successiva, gli altri continuano a usare quella corrente
+    int expected = 0;
+    if (!atomic_compare_exchange_strong(&table->resizing, &expected, 1)) return;
+
+    // La tabella successiva ha il doppio degli slot; da questo momento i thread iniziano a spostare gli slot
+    atomic_store(&table->next, create_shared_table(map, table->size * 2));
+}
+
+/**
+ * Sposta un blocco di slot di una tabella in ridimensionamento nella tabella successiva.
+ *
+ * Il thread che sposta l'ultimo blocco rende corrente la tabella successiva.
+ *
+ * @param map La hashmap.
+ * @param table La tabella in ridimensionamento.
+ */
+void help_migration(ConcurrentHashMap *map, ConcurrentTable *table) {
+    size_t next_offset = atomic_load(&table->next);
+    ConcurrentTable *next = get_shared_table(map, next_offset);
+
+    // Assegnazione del blocco (se tutti i blocchi sono già assegnati, il ridimensionamento è in corso in altri thread)
+    size_t start = atomic_fetch_add(&table->claimed, MIGRATION_CHUNK);
+    if (start >= table->size) return;
+
+    size_t end = start + MIGRATION_CHUNK < table->size ? start + MIGRATION_CHUNK : table->size;
+
+    for (size_t i = start; i < end; i++) {
+        size_t slot = atomic_load(&table->slots[i]);
+
+        // Lo slot viene bloccato, in modo che nessun thread possa più occuparlo (gli slot vuoti possono essere già bloccati)
+        while (slot != FROZEN && !atomic_compare_exchange_weak(&table->slots[i], &slot, slot | FROZEN));
+
+        // La parola viene spostata nella tabella successiva, in cui sicuramente non è presente
+        if (slot != FROZEN && slot != 0) place_shared_word(map, next, slot);
+    }
+
+    // Il thread che completa lo spostamento rende corrente la tabella successiva
+    if (atomic_fetch_add(&table->migrated, end - start) + (end - start) == table->size) atomic_store(&map->table, next_offset);
+}
+
+/**
+ * Inserisce in una tabella una parola che sicuramente non è presente.
+ *
+ * Se un thread che sposta gli slot resta fermo a lungo, la tabella può riempirsi o essere a sua
+ * volta ridimensionata; in questo caso la parola viene inserita nella tabella successiva.
+ *
+ * @param map La hashmap.
+ * @param table La tabella.
+ * @param word L'offset della parola.
+ */
+void place_shared_word(ConcurrentHashMap *map, ConcurrentTable *table, size_t word) {
+    unsigned int word_hash = concurrent_hashmap_word(map, word)->hash;
+
+    while (true) {
+        size_t mask = table->size - 1;
+        size_t index = word_hash & mask;
+
+        // La parola occupa il primo slot vuoto (gli slot occupati da altri thread vengono saltati)
+        for (size_t probes = 0; probes < table->size; probes++) {
+            size_t slot = 0;
+
+            if (atomic_compare_exchange_strong(&table->slots[index], &slot, word)) {
+                atomic_fetch_add(&table->count, 1);
+                return;
+            }
+
+            // Slot vuoto bloccato: la tabella è in ridimensionamento
+            if (slot == FROZEN) break;
+
+            index = (index + 1) & mask;
+        }
+
+        // L'inserimento prosegue nella tabella successiva (se la tabella è piena, viene avviato il ridimensionamento)
+        size_t next;
+        while (!(next = atomic_load(&table->next))) start_resize(map, table);
+
+        table = get_shared_table(map, next);
+    }
+}
+
+/**
+ * Completa un ridimensionamento lasciato in corso dai thread (quando nessun thread inserisce più).
+ *
+ * @param map La hashmap.
+ * @return La tabella corrente.
+ */
+ConcurrentTable *finish_migration(ConcurrentHashMap *map) {
+    ConcurrentTable *table;
+    while (atomic_load(&(table = get_shared_table(map, atomic_load(&map->table)))->next)) help_migration(map, table);
+
+    return table;
+}
+
+/**
+ * Calcola l'hash dell'offset di una parola successiva, usato dall'indice dei nodi.
+ *
+ * @param offset L'offset della parola.
+ * @return L'hash dell'offset.
+ */
+size_t hash_offset(size_t offset) {
+    // Moltiplicazione di Fibonacci sui bit significativi dell'offset (gli ultimi tre sono sempre nulli)
+    return (size_t)(((uint64_t)(offset >> 3) * 0x9e3779b97f4a7c15u) >> 32);
+}
+
+/**
+ * Cerca il nodo di una parola successiva (con il lock dell'entry).
+ *
+ * @param writer Il thread.
+ * @param entry L'entry.
+ * @param next_word L'offset della parola successiva.
+ * @return Il nodo della parola successiva, NULL se non è presente.
+ */
+ConcurrentNode *find_shared_node(ConcurrentWriter *writer, ConcurrentWord *entry, size_t next_word) {
+    Region *region = writer->map->region;
+
+    if (!entry->successors) {
+        if (entry->size <= SUCCESSOR_INDEX_THRESHOLD) {
+            // Poche parole successive: la lista viene scorsa confrontando gli offset
+            for (ConcurrentNode *node = region_pointer(region, entry->next_words); node; node = region_pointer(region, node->next)) {
+                if (node->next_word == next_word) return node;
+            }
+
+            return NULL;
+        }
+
+        // Creazione dell'indice, con spazio per il doppio delle parole successive attuali
+        size_t size = 1;
+        while (size < entry->size * 2) size *= 2;
+
+        entry->successors = allocate_shared_record(writer, size * sizeof(size_t));
+        entry->successors_size = size;
+
+        // Indicizzazione dei nodi presenti
+        size_t *slots = region_pointer(region, entry->successors);
+
+        for (size_t offset = entry->next_words; offset; offset = ((ConcurrentNode *)region_pointer(region, offset))->next) {
+            size_t index = hash_offset(((ConcurrentNode *)region_pointer(region, offset))->next_word) & (size - 1);
+            while (slots[index]) index = (index + 1) & (size - 1);
+
+            slots[index] = offset;
+        }
+    }
+
+    size_t *slots = region_pointer(region, entry->successors);
+    size_t mask = entry->successors_size - 1;
+
+    // Scorrimento degli slot a partire da quello indicato dall'hash
+    for (size_t index = hash_offset(next_word) & mask; slots[index]; index = (index + 1) & mask) {
+        ConcurrentNode *node = region_pointer(region, slots[index]);
+        if (node->next_word == next_word) return node;
+    }
+
+    // Se il nodo non è stato trovato, viene restituito NULL
+    return NULL;
+}
+
+/**
+ * Inserisce un nodo nell'indice delle parole successive di una entry, ingrandendolo se necessario (con il lock dell'entry).
+ *
+ * @param writer Il thread.
+ * @param entry L'entry (con indice).
+ * @param node L'offset del nodo.
+ */
+void index_shared_node(ConcurrentWriter *writer, ConcurrentWord *entry, size_t node) {
+    Region *region = writer->map->region;
+
+    // Se il fattore di carico supera quello massimo, l'indice viene raddoppiato (il vecchio resta nella regione)
+    if (entry->size > entry->successors_size * HASHMAP_MAX_LOAD_FACTOR) {
+        size_t new_size = entry->successors_size * 2;
+        size_t new_successors = allocate_shared_record(writer, new_size * sizeof(size_t));
+
+        size_t *slots = region_pointer(region, entry->successors);
+        size_t *new_slots = region_pointer(region, new_successors);
+
+        for (size_t i = 0; i < entry->successors_size; i++) {
+            if (!slots[i]) continue;
+
+            size_t index = hash_offset(((ConcurrentNode *)region_pointer(region, slots[i]))->next_word) & (new_size - 1);
+            while (new_slots[index]) index = (index + 1) & (new_size - 1);
+
+            new_slots[index] = slots[i];
+        }
+
+        entry->successors = new_successors;
+        entry->successors_size = new_size;
+    }
+
+    // Inserimento del nodo
+    size_t *slots = region_pointer(region, entry->successors);
+    size_t mask = entry->successors_size - 1;
+
+    size_t index = hash_offset(((ConcurrentNode *)region_pointer(region, node))->next_word) & mask;
+    while (slots[index]) index = (index + 1) & mask;
+
+    slots[index] = node;
+}
+
+/**
+ * Confronta due entry in base alla loro prima occorrenza nel testo.
+ *
+ * @param first La prima entry.
+ * @param second La seconda entry.
+ * @return Un numero negativo, nullo o positivo se la prima entry precede, coincide o segue la seconda.
+ */
+int compare_entries(const void *first, const void *second) {
+    size_t first_order = (*(ConcurrentWord **)first)->order;
+    size_t second_order = (*(ConcurrentWord **)second)->order;
+
+    return (first_order > second_order) - (first_order < second_order);
+}
+
+/**
+ * Confronta due nodi in ordine inverso di prima occorrenza nel testo.
+ *
+ * @param first Il primo nodo.
+ * @param second Il secondo nodo.
+ * @return Un numero negativo, nullo o positivo se il primo nodo precede, coincide o segue il secondo.
+ */
+int compare_nodes(const void *first, const void *second) {
+    size_t first_order = (*(ConcurrentNode **)first)->order;
+    size_t second_order = (*(ConcurrentNode **)second)->order;
+
+    return (first_order < second_order) - (first_order > second_order);
+}
\ No newline at end of file
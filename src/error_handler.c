@@ -20,12 +20,15 @@ Error errors[] = {
     { ERR_UNKNOWN_OPTION, "opzione sconosciuta" }, 
     { ERR_MISSING_OPTION_ARGUMENT, "argomento dell'opzione mancante per" },
     { ERR_INVALID_OPTION_ARGUMENT, "argomento dell'opzione non valido per" },
+    { ERR_CONFLICTING_OPTION, "opzione incompatibile con le altre opzioni specificate" },
     { ERR_MISSING_COMMAND, "comando mancante" },
     { ERR_INVALID_COMMAND, "comando non valido" },
     { ERR_INVALID_TEXT, "testo fornito non valido" }, 
     { ERR_INVALID_TABLE, "tabella fornita non valida" },
     { ERR_MEMORY_ALLOCATION, "allocazione di memoria fallita" },
     { ERR_PARALLELIZATION, "parallelizzazione fallita" },
+    { ERR_TEMPORARY_FILE, "scrittura su file temporaneo fallita" },
+    { ERR_OUTPUT_FILE, "scrittura sul file di output fallita" },
     { ERR_INTERNAL_ERROR, "errore interno" }, 
 };
 
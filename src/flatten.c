@@ -1,40 +1,92 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <wchar.h>
 #include <wctype.h>
 #include <math.h>
 #include <time.h> 
 #include <gsl/gsl_rng.h>
-#include <gsl/gsl_randist.h>
 #include <sys/wait.h>
 #include <errno.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 #include "flatten.h"
 #include "hashmap.h"
 #include "error_handler.h"
 #include "constants.h"
+#include "reader.h"
+#include "utf8.h"
+#include "pipe_io.h"
+#include "ring.h"
+#include "region.h"
+#include "table_file.h"
+#include "table_index.h"
+#include "table_cache.h"
 
 extern int errno;
 
+/**
+ * Numero massimo di cifre di una frequenza letta senza strtod (il valore delle cifre è rappresentato esattamente da un double).
+ */
+#define MAX_FREQUENCY_DIGITS 15
+
+/**
+ * Numero massimo di cifre decimali di una frequenza letta senza strtod (le potenze di 10 fino a 10^22 sono esatte).
+ */
+#define MAX_FREQUENCY_DECIMALS 22
+
+/**
+ * Struttura che rappresenta una porzione della tabella caricata da un thread.
+ *
+ * La porzione va da start a end e contiene righe intere; le righe vengono processate in
+ * word_frequencies, che per la prima porzione è la tabella finale.
+ */
+typedef struct {
+    FILE *input_file;
+    off_t start;
+    off_t end;
+    HashMap *word_frequencies;
+} TableRangeTask;
+
+/**
+ * Struttura che rappresenta una tabella caricata su richiesta.
+ *
+ * word_frequencies contiene solo le righe delle parole visitate, lette dalla tabella tramite index.
+ */
+typedef struct {
+    HashMap *word_frequencies;
+    TableIndex *index;
+} LazyTable;
+
 /**
  * Parsa una stringa.
  *
  * @param string La stringa da parsare.
  */
-void parse_string(wchar_t *string);
+void parse_string(char *string);
 
 /**
  * Processa una cella.
  *
  * @param word_frequencies La tabella delle frequenze.
  * @param string La stringa da processare.
- * @param hash_value Il valore hash.
+ * @param entry L'entry della riga corrente.
  * @param next_word La prossima parola.
  * @param sum La somma delle frequenze.
  * @param node_counter Il contatore dei nodi.
  */
-void process_cell(HashMap *word_frequencies, wchar_t *string, unsigned int *hash_value, wchar_t *next_word, double *sum, int *node_counter);
+void process_cell(HashMap *word_frequencies, char *string, Entry **entry, char *next_word, double *sum, int *node_counter);
+
+/**
+ * Legge una frequenza da una stringa.
+ *
+ * @param string La stringa (senza spazi).
+ * @return La frequenza letta.
+ */
+double read_frequency(char *string);
 
 /**
  * Restituisce una stringa casuale.
@@ -44,7 +96,7 @@ void process_cell(HashMap *word_frequencies, wchar_t *string, unsigned int *hash
  * @param size La dimensione.
  * @return La stringa casuale.
  */
-wchar_t *get_random_string(HashMap *word_frequencies, wchar_t *strings[], size_t size);
+char *get_random_string(HashMap *word_frequencies, char *strings[], size_t size);
 
 /**
  * Scrive un testo casuale.
@@ -53,24 +105,81 @@ wchar_t *get_random_string(HashMap *word_frequencies, wchar_t *strings[], size_t
  * @param words_to_generate Il numero di parole da generare.
  * @param previous_word La parola precedente.
  * @param output_file Il file di output.
+ * @param lazy_table La tabella caricata su richiesta (NULL se la tabella è stata caricata interamente).
  */
-void write_random_text(HashMap *word_frequencies, int words_to_generate, wchar_t *previous_word, FILE *output_file);
+void write_random_text(HashMap *word_frequencies, int words_to_generate, char *previous_word, FILE *output_file, LazyTable *lazy_table);
+
+/**
+ * Sceglie la parola precedente, se non è stata specificata, e scrive un testo casuale.
+ *
+ * @param word_frequencies La tabella delle frequenze (compilata).
+ * @param words_to_generate Il numero di parole da generare.
+ * @param previous_word La parola precedente (stringa vuota se non è stata specificata).
+ * @param output_file Il file di output.
+ * @param lazy_table La tabella caricata su richiesta (NULL se la tabella è stata caricata interamente).
+ */
+void generate_random_text(HashMap *word_frequencies, int words_to_generate, char *previous_word, FILE *output_file, LazyTable *lazy_table);
 
 /**
  * Legge una tabella.
  *
  * @param input_file Il file di input.
  * @param pipe_fd Il descrittore della pipe.
+ * @param ring Il ring buffer (NULL se la tabella viene trasferita sulla pipe).
  */
-void read_table(FILE *input_file, int pipe_fd[2]);
+void read_table(FILE *input_file, int pipe_fd[2], RingBuffer *ring);
 
 /**
  * Processa una tabella.
  *
  * @param word_frequencies La tabella delle frequenze.
  * @param pipe_fd Il descrittore della pipe.
+ * @param ring Il ring buffer (NULL se la tabella viene trasferita sulla pipe).
+ */
+void process_table(HashMap *word_frequencies, int pipe_fd[2], RingBuffer *ring);
+
+/**
+ * Processa la tabella letta da un lettore.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param reader Il lettore della tabella.
+ */
+void process_table_input(HashMap *word_frequencies, Reader *reader);
+
+/**
+ * Processa le righe della tabella lette da un lettore, verificando la somma delle frequenze di ogni riga.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param reader Il lettore della tabella.
  */
-void process_table(HashMap *word_frequencies, int pipe_fd[2]);
+void load_table_input(HashMap *word_frequencies, Reader *reader);
+
+/**
+ * Carica una tabella suddividendola tra più thread.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param threads Il numero di thread.
+ */
+void load_table_threaded(HashMap *word_frequencies, FILE *input_file, int threads);
+
+/**
+ * Cerca la fine della riga che contiene un offset.
+ *
+ * @param input_file Il file di input.
+ * @param offset L'offset da cui iniziare la ricerca.
+ * @param file_size La dimensione del file.
+ * @return L'offset successivo all'a capo, oppure la dimensione del file se non viene trovato.
+ */
+off_t find_row_end(FILE *input_file, off_t offset, off_t file_size);
+
+/**
+ * Carica le righe di una porzione della tabella.
+ *
+ * @param argument La porzione (TableRangeTask).
+ * @return NULL.
+ */
+void *load_table_range(void *argument);
 
 /**
  * Genera un testo casuale a partire da una tabella di frequenze utilizzando un singolo processo.
@@ -80,7 +189,38 @@ void process_table(HashMap *word_frequencies, int pipe_fd[2]);
  * @param previous_word La parola precedente.
  * @param output_file Il file di output.
  */
-void flatten_single_process(HashMap *word_frequencies, FILE *input_file, int words_to_generate, wchar_t *previous_word, FILE *output_file);
+void flatten_single_process(HashMap *word_frequencies, FILE *input_file, int words_to_generate, char *previous_word, FILE *output_file);
+
+/**
+ * Restituisce l'entry di una parola, caricando la sua riga dalla tabella se non è ancora presente.
+ *
+ * @param lazy_table La tabella caricata su richiesta.
+ * @param word La parola.
+ * @return L'entry della parola, NULL se la parola non ha una riga nella tabella.
+ */
+Entry *load_lazy_entry(LazyTable *lazy_table, char *word);
+
+/**
+ * Genera un testo casuale caricando le righe della tabella solo quando le loro parole vengono visitate.
+ *
+ * @param index L'indice della tabella.
+ * @param words_to_generate Il numero di parole da generare.
+ * @param previous_word La parola precedente.
+ * @param output_file Il file di output.
+ */
+void flatten_lazy(TableIndex *index, int words_to_generate, char *previous_word, FILE *output_file);
+
+/**
+ * Genera un testo casuale dall'immagine della tabella nella cache, creandola se non è presente.
+ *
+ * @param cache Il riferimento all'immagine della tabella.
+ * @param input_file Il file di input.
+ * @param words_to_generate Il numero di parole da generare.
+ * @param previous_word La parola precedente.
+ * @param output_file Il file di output.
+ * @param threads Il numero di thread tra cui suddividere il caricamento della tabella, se l'immagine deve essere creata.
+ */
+void flatten_cached(TableCache *cache, FILE *input_file, int words_to_generate, char *previous_word, FILE *output_file, int threads);
 
 /**
  * Genera un testo casuale a partire da una tabella di frequenze.
@@ -90,17 +230,63 @@ void flatten_single_process(HashMap *word_frequencies, FILE *input_file, int wor
  * @param previous_word La parola precedente.
  * @param output_file Il file di output.
  * @param multiprocess_mode La modalità multiprocessore.
+ * @param shared_memory_mode Indica se trasferire la tabella su un ring buffer in memoria condivisa invece che su una pipe.
+ * @param threads Il numero di thread tra cui suddividere il caricamento della tabella.
+ * @param index_filename Il percorso dell'indice della tabella, per caricarne le righe su richiesta (NULL per caricarla interamente).
+ * @param cache_table_filename Il percorso della tabella, per condividerla tramite la cache in memoria condivisa (NULL per non usare la cache).
  */
-void flatten(FILE *input_file, int words_to_generate, wchar_t *previous_word, FILE *output_file, bool multiprocess_mode) {
+void flatten(FILE *input_file, int words_to_generate, char *previous_word, FILE *output_file, bool multiprocess_mode, bool shared_memory_mode, int threads, char *index_filename, char *cache_table_filename) {
+    // Una tabella compilata viene mappata e usata direttamente, quindi non servono i processi di lettura e processamento
+    HashMap *compiled_table = table_file_open(fileno(input_file));
+
+    if (compiled_table) {
+        generate_random_text(compiled_table, words_to_generate, previous_word, output_file, NULL);
+        hashmap_destroy(compiled_table);
+        return;
+    }
+
+    // Con la cache la tabella viene caricata solo dal primo processo, gli altri mappano la sua immagine (se la tabella non è un file regolare viene caricata normalmente)
+    TableCache *cache = cache_table_filename ? table_cache_create(input_file, cache_table_filename) : NULL;
+
+    if (cache) {
+        flatten_cached(cache, input_file, words_to_generate, previous_word, output_file, threads);
+        table_cache_destroy(cache);
+        return;
+    }
+
+    // Con l'indice vengono lette solo le righe delle parole visitate (se la tabella non è un file regolare viene caricata interamente)
+    TableIndex *index = index_filename ? table_index_open(input_file, index_filename) : NULL;
+
+    if (index) {
+        flatten_lazy(index, words_to_generate, previous_word, output_file);
+        table_index_close(index);
+        return;
+    }
+
     // Creazione della hashmap
     HashMap *word_frequencies = hashmap_create();
 
-    if (multiprocess_mode) {
+    if (threads > 1) {
+        // Modalità a più thread: la tabella viene suddivisa tra i thread, poi il testo viene generato dal processo principale
+        load_table_threaded(word_frequencies, input_file, threads);
+        generate_random_text(word_frequencies, words_to_generate, previous_word, output_file, NULL);
+    } else if (multiprocess_mode) {
         // Modalità multiprocess
 
         // Creazione della pipe (pipe_fd[0] per la lettura del file di input, pipe_fd[1] per la scrittura su file di output)
-        int pipe_fd[2][2];
-        if (pipe(pipe_fd[0]) == -1 || pipe(pipe_fd[1]) == -1) error_handler(ERR_PARALLELIZATION);
+        int pipe_fd[2][2] = { { -1, -1 }, { -1, -1 } };
+        pipe_open(pipe_fd[1]);
+
+        // La hashmap viene costruita in una regione condivisa, sulla pipe di scrittura viene solo notificato che è pronta
+        int table_fd = region_create_file();
+
+        // Il file di input viene trasferito su un ring buffer in memoria condivisa oppure sulla pipe
+        RingBuffer *ring = NULL;
+        if (shared_memory_mode) {
+            ring = ring_create(RING_CAPACITY);
+        } else {
+            pipe_open(pipe_fd[0]);
+        }
 
         // Creazione di un processo per la lettura della tabella
         pid_t read_pid = fork();
@@ -110,7 +296,7 @@ void flatten(FILE *input_file, int words_to_generate, wchar_t *previous_word, FI
             close(pipe_fd[1][1]);
 
             // Lettura della tabella e scrittura nella pipe
-            read_table(input_file, pipe_fd[0]);
+            read_table(input_file, pipe_fd[0], ring);
 
             // Fine del processo di lettura
             exit(EXIT_SUCCESS);
@@ -124,33 +310,17 @@ void flatten(FILE *input_file, int words_to_generate, wchar_t *previous_word, FI
             // Chisura del lato di lettura della pipe di scrittura su file di output
             close(pipe_fd[1][0]);
 
-            // Processamento della tabella
-            process_table(word_frequencies, pipe_fd[0]);
-
-            // Conversione della hashmap in un buffer
-            wchar_t *buffer = hashmap_serialize(word_frequencies);
-
-            // Dimensione del buffer
-            size_t buffer_size = sizeof(wchar_t) * (wcslen(buffer) + 1);
-
-            // Scrittura della dimensione del buffer sulla pipe
-            write(pipe_fd[1][1], &buffer_size, sizeof(buffer_size));
-
-            // Totale dei byte scritti
-            ssize_t total = 0;
-
-            // Continua a scrivere finché non ha scritto tutto il buffer
-            while (total < buffer_size) {
-                // Scrittura del buffer sulla pipe
-                ssize_t written_size = write(pipe_fd[1][1], buffer + total / sizeof(wchar_t), buffer_size - total);
-                if (written_size == -1) error_handler(ERR_PARALLELIZATION);
+            // Processamento della tabella in una hashmap nella regione condivisa
+            hashmap_destroy(word_frequencies);
+            word_frequencies = hashmap_create_shared(table_fd);
+            process_table(word_frequencies, pipe_fd[0], ring);
 
-                // Viene incrementato il totale dei byte scritti
-                total += written_size;
-            }
+            // Pubblicazione della hashmap, che il processo di scrittura legge direttamente dalla regione
+            hashmap_publish(word_frequencies);
 
-            // Deallocazione del buffer
-            free(buffer);
+            // Notifica della dimensione della regione sulla pipe
+            size_t table_size = region_header(word_frequencies->region)->size;
+            pipe_write(pipe_fd[1][1], &table_size, sizeof(table_size));
 
             // Chisura del lato di scrittura della pipe di scrittura su file di output
             close(pipe_fd[1][1]);
@@ -162,56 +332,26 @@ void flatten(FILE *input_file, int words_to_generate, wchar_t *previous_word, FI
         }
 
         // Chiusura dei file descriptor della pipe di lettura del file di input
-        close(pipe_fd[0][0]);
-        close(pipe_fd[0][1]);
+        if (!ring) {
+            close(pipe_fd[0][0]);
+            close(pipe_fd[0][1]);
+        }
 
         pid_t write_pid = fork();
         if (write_pid == 0) {
             // Chisura del lato di scrittura della pipe di scrittura su file di output
             close(pipe_fd[1][1]);
 
-            // Dimensione del buffer
-            size_t buffer_size;
-
-            // Lettura della dimensione del buffer dalla pipe
-            read(pipe_fd[1][0], &buffer_size, sizeof(buffer_size));
-
-            // Allocazione del buffer
-            wchar_t *buffer = malloc(buffer_size);
-            if (!buffer) error_handler(ERR_MEMORY_ALLOCATION);
-
-            // Totale dei byte letti
-            ssize_t total = 0;
-
-            // Continua a leggere finché non ha letto tutto il buffer
-            while (total < buffer_size) {
-                // Scrittura del buffer sulla pipe
-                ssize_t read_size = read(pipe_fd[1][0], buffer + total / sizeof(wchar_t), buffer_size - total);
-                if (read_size == -1) error_handler(ERR_PARALLELIZATION);
-
-                // Viene incrementato il totale dei byte letti
-                total += read_size;
-            }
-
-            // Conversione del buffer in una hashmap
-            hashmap_deserialize(word_frequencies, buffer);
+            // Attesa della notifica dalla pipe (se manca, il processo di processamento è terminato con un errore)
+            size_t table_size;
+            if (!pipe_read(pipe_fd[1][0], &table_size, sizeof(table_size))) exit(EXIT_FAILURE);
 
-            // Deallocazione del buffer
-            free(buffer);
-
-            // Inizializza l'ambiente per i generatori di numeri casuali
-            srand(time(NULL));
-
-            // Se la parola precedente non è stata specificata, viene scelta casualmente tra i segni di punteggiatura; altrimenti verifica se è presente nella tabella delle frequenze
-            if (wcscmp(previous_word, L"") == 0) {
-                wchar_t *punctation_marks[] = { L".", L"?", L"!" };
-                wcscpy(previous_word, get_random_string(word_frequencies, punctation_marks, 3));
-            } else {
-                if (!hashmap_get(word_frequencies, previous_word)) argument_error_handler(ERR_INVALID_OPTION_ARGUMENT, "-w");
-            }
+            // Apertura della hashmap costruita dal processo di processamento, senza copiarla
+            hashmap_destroy(word_frequencies);
+            word_frequencies = hashmap_open(table_fd);
 
             // Scrittura del testo casuale
-            write_random_text(word_frequencies, words_to_generate, previous_word, output_file);
+            generate_random_text(word_frequencies, words_to_generate, previous_word, output_file, NULL);
 
             // Chisura del lato di lettura della pipe di scrittura su file di output
             close(pipe_fd[1][0]);
@@ -226,20 +366,14 @@ void flatten(FILE *input_file, int words_to_generate, wchar_t *previous_word, FI
         close(pipe_fd[1][0]);
         close(pipe_fd[1][1]);
 
-        // Status dei processi
-        int status;
-        
-        // Attesa del processo di lettura
-        waitpid(read_pid, &status, 0);
-        if (WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS) exit(EXIT_FAILURE);
+        // Attesa dei processi di lettura, processamento e scrittura
+        pipe_wait_processes((pid_t[]){ read_pid, process_pid, write_pid }, 3);
 
-        // Attesa del processo di processamento
-        waitpid(process_pid, &status, 0);
-        if (WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS) exit(EXIT_FAILURE);
+        // Rimozione del ring buffer
+        if (ring) ring_destroy(ring);
 
-        // Attesa del processo di scrittura
-        waitpid(write_pid, &status, 0);
-        if (WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS) exit(EXIT_FAILURE);
+        // Chiusura del file della regione condivisa
+        close(table_fd);
     } else {
         // Modalità single process
         flatten_single_process(word_frequencies, input_file, words_to_generate, previous_word, output_file);
@@ -254,14 +388,14 @@ void flatten(FILE *input_file, int words_to_generate, wchar_t *previous_word, FI
  *
  * @param string La stringa da parsare.
  */
-void parse_string(wchar_t *string) {
-    wchar_t *source = string;
-    wchar_t *destination = string;
+void parse_string(char *string) {
+    char *source = string;
+    char *destination = string;
 
     // Scorrimento della stringa
     while (*source) {   
         // Se il carattere non è uno spazio, viene copiato nella stringa di destinazione
-        if (*source != L' ') {
+        if (*source != ' ') {
             *destination++ = *source;
         }
 
@@ -270,11 +404,11 @@ void parse_string(wchar_t *string) {
     }
 
     // Terminazione della stringa di destinazione
-    *destination = L'\0';
+    *destination = '\0';
 
     // Se l'ultima parola termina con un a capo, viene sostituito con il terminatore di stringa
-    if (destination > string && destination[-1] == L'\n') {
-        destination[-1] = L'\0';
+    if (destination > string && destination[-1] == '\n') {
+        destination[-1] = '\0';
     }
 }
 
@@ -283,36 +417,24 @@ void parse_string(wchar_t *string) {
  *
  * @param word_frequencies La tabella delle frequenze.
  * @param string La stringa da processare.
- * @param hash_value Il valore hash.
+ * @param entry L'entry della riga corrente.
  * @param next_word La prossima parola.
  * @param sum La somma delle frequenze.
  * @param node_counter Il contatore dei nodi.
  */
-void process_cell(HashMap *word_frequencies, wchar_t *string, unsigned int *hash_value, wchar_t *next_word, double *sum, int *node_counter) {
+void process_cell(HashMap *word_frequencies, char *string, Entry **entry, char *next_word, double *sum, int *node_counter) {
     // Parsa la stringa
     parse_string(string);
 
     switch (*node_counter) {
         case 0:
-            // Viene incrementato il numero di entry della hashmap
-            word_frequencies->usage++;
-
-            // Viene calcolato il fattore di carico
-            double load_factor = (double)word_frequencies->usage / word_frequencies->size;
-
-            // Se il fattore di carico supera il 75%, la hashmap viene ridimensionata
-            if (load_factor > 0.75) hashmap_resize(word_frequencies);
-
-            // Calcola l'hash
-            *hash_value = hash(string, word_frequencies->size);
-
             // Inserisce la parola nella tabella
-            word_frequencies->buckets[*hash_value] = hashmap_insert_entry(word_frequencies->buckets[*hash_value], string);
+            *entry = hashmap_add_entry(word_frequencies, string);
             break;
 
         case 1:
             // Copia la parola successiva
-            wcscpy(next_word, string);
+            strcpy(next_word, string);
             break;
 
         case 2:
@@ -320,14 +442,13 @@ void process_cell(HashMap *word_frequencies, wchar_t *string, unsigned int *hash
             errno = 0;
 
             // Converte la stringa in double
-            double frequency = wcstod(string, NULL);
+            double frequency = read_frequency(string);
 
             // Se la conversione non è andata a buon fine o la frequenza non è compresa tra 0 e 1, errore
             if (errno == ERANGE || frequency < 0 || frequency > 1) error_handler(ERR_INVALID_TABLE);
 
-            // Inserisce la parola successiva nella lista delle parole successive e incrementa la dimensione della lista
-            word_frequencies->buckets[*hash_value]->next_words = hashmap_insert_node(word_frequencies->buckets[*hash_value]->next_words, next_word, frequency);
-            word_frequencies->buckets[*hash_value]->size++;
+            // Inserisce la parola successiva nella lista delle parole successive (la dimensione della lista viene incrementata)
+            hashmap_add_node(word_frequencies, *entry, next_word, frequency);
 
             // Incrementa la somma delle frequenze e resetta il contatore dei nodi
             *sum += frequency;
@@ -340,6 +461,51 @@ void process_cell(HashMap *word_frequencies, wchar_t *string, unsigned int *hash
     }
 }
 
+/**
+ * Legge una frequenza da una stringa.
+ *
+ * Le frequenze scritte da tabulate sono numeri decimali con poche cifre: le cifre vengono lette
+ * come un unico intero, rappresentato esattamente, e divise per una potenza di 10 esatta, quindi
+ * il risultato è arrotondato correttamente come quello di strtod. Le altre stringhe vengono
+ * lette con strtod.
+ *
+ * @param string La stringa (senza spazi).
+ * @return La frequenza letta.
+ */
+double read_frequency(char *string) {
+    uint64_t digits_value = 0;
+    int digits = 0;
+    int decimals = 0;
+
+    char *character = string;
+
+    // Parte intera
+    while (*character >= '0' && *character <= '9') {
+        digits_value = digits_value * 10 + (*character++ - '0');
+        digits++;
+    }
+
+    // Parte decimale
+    if (*character == '.') {
+        character++;
+
+        while (*character >= '0' && *character <= '9') {
+            digits_value = digits_value * 10 + (*character++ - '0');
+            digits++;
+            decimals++;
+        }
+    }
+
+    // Se la stringa non è un numero decimale semplice o ha troppe cifre, viene letta con strtod
+    if (*character != '\0' || digits == 0 || digits > MAX_FREQUENCY_DIGITS || decimals > MAX_FREQUENCY_DECIMALS) return strtod(string, NULL);
+
+    // Divisione per la potenza di 10 delle cifre decimali (calcolata esattamente)
+    double divisor = 1;
+    for (int i = 0; i < decimals; i++) divisor *= 10;
+
+    return digits_value / divisor;
+}
+
 /**
  * Restituisce una stringa casuale.
  *
@@ -348,7 +514,7 @@ void process_cell(HashMap *word_frequencies, wchar_t *string, unsigned int *hash
  * @param size La dimensione.
  * @return La stringa casuale.
  */
-wchar_t *get_random_string(HashMap *word_frequencies, wchar_t *strings[], size_t size) {
+char *get_random_string(HashMap *word_frequencies, char *strings[], size_t size) {
     // Inizializza l'ambiente per i generatori di numeri casuali
     srand(time(NULL));
 
@@ -370,7 +536,7 @@ wchar_t *get_random_string(HashMap *word_frequencies, wchar_t *strings[], size_t
     }
 
     // Se nessuna parola è presente nella tabella delle frequenze, restituisce una stringa vuota
-    return L"";
+    return "";
 }
 
 /**
@@ -380,8 +546,9 @@ wchar_t *get_random_string(HashMap *word_frequencies, wchar_t *strings[], size_t
  * @param words_to_generate Il numero di parole da generare.
  * @param previous_word La parola precedente.
  * @param output_file Il file di output.
+ * @param lazy_table La tabella caricata su richiesta (NULL se la tabella è stata caricata interamente).
  */
-void write_random_text(HashMap *word_frequencies, int words_to_generate, wchar_t *previous_word, FILE *output_file) {
+void write_random_text(HashMap *word_frequencies, int words_to_generate, char *previous_word, FILE *output_file, LazyTable *lazy_table) {
     // Inizializza l'ambiente per i generatori di numeri casuali
     gsl_rng_env_setup();
 
@@ -389,63 +556,55 @@ void write_random_text(HashMap *word_frequencies, int words_to_generate, wchar_t
     gsl_rng *r = gsl_rng_alloc(gsl_rng_default);
     gsl_rng_set(r, time(NULL));
 
-    wchar_t word[MAX_WORD_LENGTH];
     bool first_iteration = true;
 
-    for (int i = 0; i < words_to_generate; i++) {
-        // Prende la entry della parola precedente
-        Entry *entry = hashmap_get(word_frequencies, previous_word);
+    // Prende la entry della parola precedente (le entry successive vengono raggiunte tramite la tabella compilata)
+    Entry *entry = hashmap_get(word_frequencies, previous_word);
 
-        // Array delle frequenze con dimensione uguale alla dimensione della lista delle parole successive
-        double frequencies[entry->size];
-        size_t size = 0;
-        
-        Node *next_words = entry->next_words;
-        
-        // Scorre la lista delle parole successive
-        while (next_words) {
-            // Popola l'array delle frequenze
-            frequencies[size++] = next_words->frequency;
-            next_words = next_words->next;
-        }
+    for (int i = 0; i < words_to_generate; i++) {
+        // Sceglie uno slot a caso della tabella alias, quindi la parola dello slot o quella del suo alias
+        AliasSlot *slots = hashmap_alias(word_frequencies, entry);
 
-        // Prende un indice casuale
-        gsl_ran_discrete_t *discrete_distribution = gsl_ran_discrete_preproc(size, frequencies);
-        unsigned int index = gsl_ran_discrete(r, discrete_distribution);
+        double random = gsl_rng_uniform(r) * entry->size;
+        size_t index = (size_t)random;
+        if (index >= entry->size) index = entry->size - 1;
 
-        next_words = entry->next_words;
-        
-        // Scorre la lista delle parole successive
-        for (int i = 0; i < entry->size; i++) {
-            // Se l'indice corrisponde alla parola, la copia ed esce dal ciclo
-            if (i == index) {
-                wcscpy(word, next_words->next_word);
-                break;
-            }
+        AliasSlot *slot = &slots[index];
+        if (random - index >= slot->probability) slot = &slots[slot->alias];
 
-            // Passa alla parola successiva
-            next_words = next_words->next;
+        // Se la parola scelta non è ancora stata caricata, la sua riga viene letta e lo slot collegato (se la riga manca, errore)
+        if (!slot->next_entry) {
+            if (!lazy_table || !load_lazy_entry(lazy_table, hashmap_word(word_frequencies, slot->next_word))) error_handler(ERR_INVALID_TABLE);
+            if (!hashmap_resolve_alias(word_frequencies, slot)) error_handler(ERR_INVALID_TABLE);
         }
+
+        // Passa direttamente all'entry della parola scelta (il testo resta nella regione della hashmap, quindi non viene copiato)
+        entry = hashmap_entry(word_frequencies, slot->next_entry);
+        char *word = hashmap_word(word_frequencies, entry->word);
+        bool punctuation_mark = strcmp(word, ".") == 0 || strcmp(word, "?") == 0 || strcmp(word, "!") == 0;
+        
+        // Stampa uno spazio tra le parole, tranne che per i segni di punteggiatura
+        if (!punctuation_mark && !first_iteration) fputc(' ', output_file);
         
         // Se la parola precedente è un segno di punteggiatura, la parola successiva inizia con una lettera maiuscola
-        if (wcscmp(previous_word, L".") == 0 || wcscmp(previous_word, L"?") == 0 || wcscmp(previous_word, L"!") == 0) {
-            wcscpy(previous_word, word);
-            word[0] = towupper(word[0]);
+        if (strcmp(previous_word, ".") == 0 || strcmp(previous_word, "?") == 0 || strcmp(previous_word, "!") == 0) {
+            // Il primo carattere viene decodificato, convertito in maiuscolo e ricodificato (la sua lunghezza in byte può cambiare)
+            wchar_t character;
+            size_t character_size = utf8_decode((unsigned char *)word, strlen(word), &character);
+
+            char upper[4];
+            fwrite(upper, 1, utf8_encode(towupper(character), upper), output_file);
+            fputs(word + character_size, output_file);
         } else {
-            wcscpy(previous_word, word);
+            // Stampa la parola
+            fputs(word, output_file);
         }
-        
-        // Stampa uno spazio tra le parole, tranne che per i segni di punteggiatura
-        if (wcscmp(word, L".") != 0 && wcscmp(word, L"?") != 0 && wcscmp(word, L"!") != 0 && !first_iteration) fwprintf(output_file, L" ");
-        
-        // Stampa la parola
-        fwprintf(output_file, L"%ls", word);
+
+        // La parola scelta diventa la parola precedente
+        previous_word = word;
 
         // Imposta la first_iterarion a false dopo la prima iterazione
         if (first_iteration) first_iteration = false;
-
-        // Deallocazione della distribuzione discreta
-        gsl_ran_discrete_free(discrete_distribution);
     }
     
     // Deallocazione del generatore di numeri casuali
@@ -457,20 +616,26 @@ void write_random_text(HashMap *word_frequencies, int words_to_generate, wchar_t
  *
  * @param input_file Il file di input.
  * @param pipe_fd Il descrittore della pipe.
+ * @param ring Il ring buffer (NULL se la tabella viene trasferita sulla pipe).
  */
-void read_table(FILE *input_file, int pipe_fd[2]) {
-    // Chiusura del lato di lettura della pipe
-    close(pipe_fd[0]);
+void read_table(FILE *input_file, int pipe_fd[2], RingBuffer *ring) {
+    Reader *reader = reader_open(input_file);
+
+    if (ring) {
+        // Lettura dal file e scrittura sul ring buffer
+        ring_send(ring, reader);
+    } else {
+        // Chiusura del lato di lettura della pipe
+        close(pipe_fd[0]);
 
-    wchar_t character;
+        // Lettura dal file e scrittura sulla pipe a frame
+        pipe_send(pipe_fd[1], reader);
 
-    // Lettura dal file e scrittura sulla pipe
-    while ((character = fgetwc(input_file)) != WEOF) {
-        write(pipe_fd[1], &character, sizeof(character));
+        // Chiusura del lato di scrittura della pipe
+        close(pipe_fd[1]);
     }
 
-    // Chiusura del lato di scrittura della pipe
-    close(pipe_fd[1]);
+    reader_close(reader);
 }
 
 /**
@@ -478,80 +643,233 @@ void read_table(FILE *input_file, int pipe_fd[2]) {
  *
  * @param word_frequencies La tabella delle frequenze.
  * @param pipe_fd Il descrittore della pipe.
+ * @param ring Il ring buffer (NULL se la tabella viene trasferita sulla pipe).
  */
-void process_table(HashMap *word_frequencies, int pipe_fd[2]) {
+void process_table(HashMap *word_frequencies, int pipe_fd[2], RingBuffer *ring) {
     // Chiusura del lato di scrittura della pipe
-    close(pipe_fd[1]);
+    if (!ring) close(pipe_fd[1]);
+
+    // Lettura dal ring buffer o dei frame dalla pipe e processamento della tabella
+    Reader *reader = ring ? reader_open_ring(ring) : reader_open_pipe(pipe_fd[0]);
+    process_table_input(word_frequencies, reader);
+    reader_close(reader);
+
+    // Chiusura del lato di lettura della pipe
+    if (!ring) close(pipe_fd[0]);
+}
 
-    wchar_t string[MAX_WORD_LENGTH];
-    unsigned int hash_value;
-    wchar_t next_word[MAX_WORD_LENGTH];
+/**
+ * Processa la tabella letta da un lettore.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param reader Il lettore della tabella.
+ */
+void process_table_input(HashMap *word_frequencies, Reader *reader) {
+    load_table_input(word_frequencies, reader);
 
+    // La tabella viene compilata una sola volta, prima della generazione del testo (se una parola successiva non ha un'entry, errore)
+    if (!hashmap_compile(word_frequencies)) error_handler(ERR_INVALID_TABLE);
+}
+
+/**
+ * Processa le righe della tabella lette da un lettore, verificando la somma delle frequenze di ogni riga.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param reader Il lettore della tabella.
+ */
+void load_table_input(HashMap *word_frequencies, Reader *reader) {
+    char string[MAX_WORD_BYTES];
+    Entry *entry;
+    char next_word[MAX_WORD_BYTES];
     double sum = 0;
     int node_counter = 0;
-
-    wchar_t character;
+    
+    // Lunghezza in byte e in caratteri della cella corrente
     int index = 0;
+    int length = 0;
 
-    // Lettura dalla pipe e processamento del testo
-    while (read(pipe_fd[0], &character, sizeof(character)) > 0) {
-        switch (character) {
-            case L',':
-                // Termina la stringa
-                string[index] = '\0';
+    char *data;
+    size_t size;
 
-                // Processa la cella
-                process_cell(word_frequencies, string, &hash_value, next_word, &sum, &node_counter);
+    // Lettura dei blocchi e processamento della tabella
+    while ((size = reader_read(reader, &data)) > 0) {
+        size_t offset = 0;
 
-                // Incrementa il contatore dei nodi
-                node_counter++;
+        while (offset < size) {
+            wchar_t character;
+            size_t character_size = utf8_decode((unsigned char *)data + offset, size - offset, &character);
 
-                // Resetta l'indice
-                index = 0;
-                break;
+            // Sequenza non valida o troncata alla fine della tabella
+            if (character_size == (size_t)-1 || character_size == 0) error_handler(ERR_INVALID_TABLE);
 
-            case L'\n':
-                // Termina la stringa
-                string[index] = '\0';
+            switch (character) {
+                case L',':
+                    // Termina la stringa
+                    string[index] = '\0';
 
-                // Processa la cella
-                process_cell(word_frequencies, string, &hash_value, next_word, &sum, &node_counter);
+                    // Processa la cella
+                    process_cell(word_frequencies, string, &entry, next_word, &sum, &node_counter);
 
-                // Se la somma delle frequenze non è 1, errore
-                if (round(sum) != 1) error_handler(ERR_INVALID_TABLE); 
+                    // Incrementa il contatore dei nodi
+                    node_counter++;
 
-                // Resetta la somma e il contatore dei nodi
-                sum = 0;
-                node_counter = 0;
+                    // Resetta l'indice
+                    index = 0;
+                    length = 0;
+                    break;
 
-                // Resetta l'indice
-                index = 0;
-                break;
+                case L'\n':
+                    // Termina la stringa
+                    string[index] = '\0';
 
-            // Ignora gli spazi
-            case L' ':
-                break;
+                    // Processa la cella
+                    process_cell(word_frequencies, string, &entry, next_word, &sum, &node_counter);
 
-            default:
-                // Aggiunge il carattere alla stringa
-                if (character != L'\0') string[index++] = character;
+                    // Se la somma delle frequenze non è 1, errore
+                    if (round(sum) != 1) error_handler(ERR_INVALID_TABLE); 
+
+                    // Resetta la somma e il contatore dei nodi
+                    sum = 0;
+                    node_counter = 0;
+
+                    // Resetta l'indice
+                    index = 0;
+                    length = 0;
+                    break;
+
+                // Ignora gli spazi
+                case L' ':
+                    break;
+
+                default:   
+                    // Controllo della lunghezza massima della cella
+                    if (length == MAX_WORD_LENGTH - 1) error_handler(ERR_INVALID_TABLE);
+
+                    // Aggiunge i byte del carattere alla stringa, senza ricodificarli
+                    memcpy(string + index, data + offset, character_size);
+                    index += character_size;
+                    length++;
+            }
+
+            offset += character_size;
         }
     }
 
     // Processamento dell'ultima parola
-    if (index > 0) { 
-        // Termina la stringa
+    if (index > 0) {
         string[index] = '\0';
-
-        // Processa la cella
-        process_cell(word_frequencies, string, &hash_value, next_word, &sum, &node_counter);
+        process_cell(word_frequencies, string, &entry, next_word, &sum, &node_counter);
         
         // Se la somma delle frequenze non è 1, errore
         if (round(sum) != 1) error_handler(ERR_INVALID_TABLE); 
     }
+}
 
-    // Chiusura del lato di lettura della pipe
-    close(pipe_fd[0]);
+/**
+ * Carica una tabella suddividendola tra più thread.
+ *
+ * Il file viene suddiviso in porzioni di righe intere; ogni thread processa la propria porzione in
+ * una propria hashmap (il primo direttamente nella tabella finale), poi le hashmap vengono unite
+ * nell'ordine delle porzioni, ottenendo le entry e le parole successive nello stesso ordine del
+ * caricamento a singolo processo.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param threads Il numero di thread.
+ */
+void load_table_threaded(HashMap *word_frequencies, FILE *input_file, int threads) {
+    // Se il file non è regolare o è vuoto non può essere suddiviso
+    struct stat file_stat;
+    if (fstat(fileno(input_file), &file_stat) == -1 || !S_ISREG(file_stat.st_mode) || file_stat.st_size == 0) {
+        Reader *reader = reader_open(input_file);
+        process_table_input(word_frequencies, reader);
+        reader_close(reader);
+        return;
+    }
+
+    // Confini delle porzioni, alla fine di una riga (le porzioni vuote vengono scartate)
+    off_t *boundaries = (off_t *)malloc((threads + 1) * sizeof(off_t));
+    if (!boundaries) error_handler(ERR_MEMORY_ALLOCATION);
+
+    int ranges = 1;
+    boundaries[0] = 0;
+
+    for (int i = 1; i < threads; i++) {
+        off_t offset = file_stat.st_size / threads * i;
+        if (offset < boundaries[ranges - 1]) offset = boundaries[ranges - 1];
+
+        off_t boundary = find_row_end(input_file, offset, file_stat.st_size);
+        if (boundary == file_stat.st_size) break;
+
+        boundaries[ranges++] = boundary;
+    }
+
+    boundaries[ranges] = file_stat.st_size;
+
+    // Caricamento delle porzioni
+    TableRangeTask *tasks = (TableRangeTask *)malloc(ranges * sizeof(TableRangeTask));
+    pthread_t *thread_ids = (pthread_t *)malloc(ranges * sizeof(pthread_t));
+    if (!tasks || !thread_ids) error_handler(ERR_MEMORY_ALLOCATION);
+
+    for (int i = 0; i < ranges; i++) {
+        tasks[i] = (TableRangeTask){ input_file, boundaries[i], boundaries[i + 1], i == 0 ? word_frequencies : hashmap_create() };
+
+        if (pthread_create(&thread_ids[i], NULL, load_table_range, &tasks[i]) != 0) error_handler(ERR_PARALLELIZATION);
+    }
+
+    for (int i = 0; i < ranges; i++) pthread_join(thread_ids[i], NULL);
+
+    // Unione delle porzioni nel loro ordine
+    for (int i = 1; i < ranges; i++) {
+        hashmap_merge(word_frequencies, tasks[i].word_frequencies);
+        hashmap_destroy(tasks[i].word_frequencies);
+    }
+
+    free(boundaries);
+    free(tasks);
+    free(thread_ids);
+
+    // La tabella viene compilata una sola volta, prima della generazione del testo (se una parola successiva non ha un'entry, errore)
+    if (!hashmap_compile(word_frequencies)) error_handler(ERR_INVALID_TABLE);
+}
+
+/**
+ * Cerca la fine della riga che contiene un offset.
+ *
+ * @param input_file Il file di input.
+ * @param offset L'offset da cui iniziare la ricerca.
+ * @param file_size La dimensione del file.
+ * @return L'offset successivo all'a capo, oppure la dimensione del file se non viene trovato.
+ */
+off_t find_row_end(FILE *input_file, off_t offset, off_t file_size) {
+    Reader *reader = reader_open_range(input_file, offset, file_size);
+
+    char *data;
+    size_t size = reader_read(reader, &data);
+
+    // L'a capo è un byte ASCII, quindi non fa mai parte di una sequenza multibyte
+    char *newline = size > 0 ? memchr(data, '\n', size) : NULL;
+    off_t boundary = newline ? offset + (newline - data) + 1 : file_size;
+
+    reader_close(reader);
+
+    return boundary;
+}
+
+/**
+ * Carica le righe di una porzione della tabella.
+ *
+ * @param argument La porzione (TableRangeTask).
+ * @return NULL.
+ */
+void *load_table_range(void *argument) {
+    TableRangeTask *task = (TableRangeTask *)argument;
+
+    Reader *reader = reader_open_range(task->input_file, task->start, task->end);
+    load_table_input(task->word_frequencies, reader);
+    reader_close(reader);
+
+    return NULL;
 }
 
 /**
@@ -562,80 +880,171 @@ void process_table(HashMap *word_frequencies, int pipe_fd[2]) {
  * @param previous_word La parola precedente.
  * @param output_file Il file di output.
  */
-void flatten_single_process(HashMap *word_frequencies, FILE *input_file, int words_to_generate, wchar_t *previous_word, FILE *output_file) {
-    wchar_t string[MAX_WORD_LENGTH];
-    unsigned int hash_value;
-    wchar_t next_word[MAX_WORD_LENGTH];
-    double sum = 0;
-    int node_counter = 0;
-    
-    wchar_t character;
-    int index = 0;
+void flatten_single_process(HashMap *word_frequencies, FILE *input_file, int words_to_generate, char *previous_word, FILE *output_file) {
+    // Lettura dal file e processamento della tabella
+    Reader *reader = reader_open(input_file);
+    process_table_input(word_frequencies, reader);
+    reader_close(reader);
 
-    // Lettura dal file e processamento del testo
-    while((character = fgetwc(input_file)) != WEOF) {
-        switch (character) {
-            case L',':
-                // Termina la stringa
-                string[index] = '\0';
+    // Scrittura del testo casuale
+    generate_random_text(word_frequencies, words_to_generate, previous_word, output_file, NULL);
+}
 
-                // Processa la cella
-                process_cell(word_frequencies, string, &hash_value, next_word, &sum, &node_counter);
+/**
+ * Restituisce l'entry di una parola, caricando la sua riga dalla tabella se non è ancora presente.
+ *
+ * La riga viene processata come nel caricamento completo (quindi viene verificata la somma delle
+ * frequenze) e la sua tabella alias viene costruita subito; gli slot delle parole successive non
+ * ancora caricate vengono collegati quando vengono scelti.
+ *
+ * @param lazy_table La tabella caricata su richiesta.
+ * @param word La parola.
+ * @return L'entry della parola, NULL se la parola non ha una riga nella tabella.
+ */
+Entry *load_lazy_entry(LazyTable *lazy_table, char *word) {
+    Entry *entry = hashmap_get(lazy_table->word_frequencies, word);
+    if (entry) return entry;
+
+    // Ricerca della riga della parola nell'indice
+    size_t size;
+    char *row = table_index_find(lazy_table->index, word, &size);
+    if (!row) return NULL;
 
-                // Incrementa il contatore dei nodi
-                node_counter++;
+    // Processamento della sola riga, letta dalla tabella mappata
+    Reader *reader = reader_open_memory(row, size);
+    load_table_input(lazy_table->word_frequencies, reader);
+    reader_close(reader);
 
-                // Resetta l'indice
-                index = 0;
-                break;
+    entry = hashmap_get(lazy_table->word_frequencies, word);
+    if (!entry) error_handler(ERR_INVALID_TABLE);
 
-            case L'\n':
-                // Termina la stringa
-                string[index] = '\0';
+    hashmap_compile_entry(lazy_table->word_frequencies, entry);
 
-                // Processa la cella
-                process_cell(word_frequencies, string, &hash_value, next_word, &sum, &node_counter);
+    return entry;
+}
 
-                // Se la somma delle frequenze non è 1, errore
-                if (round(sum) != 1) error_handler(ERR_INVALID_TABLE); 
+/**
+ * Genera un testo casuale caricando le righe della tabella solo quando le loro parole vengono visitate.
+ *
+ * Vengono caricate subito solo le righe delle possibili parole iniziali; il testo generato è lo
+ * stesso del caricamento completo, ma solo le righe visitate vengono verificate.
+ *
+ * @param index L'indice della tabella.
+ * @param words_to_generate Il numero di parole da generare.
+ * @param previous_word La parola precedente.
+ * @param output_file Il file di output.
+ */
+void flatten_lazy(TableIndex *index, int words_to_generate, char *previous_word, FILE *output_file) {
+    LazyTable lazy_table = { hashmap_create(), index };
+
+    // Caricamento delle righe della parola precedente o dei segni di punteggiatura, tra cui viene scelta
+    if (previous_word[0] == '\0') {
+        load_lazy_entry(&lazy_table, ".");
+        load_lazy_entry(&lazy_table, "?");
+        load_lazy_entry(&lazy_table, "!");
+    } else {
+        load_lazy_entry(&lazy_table, previous_word);
+    }
 
-                // Resetta la somma e il contatore dei nodi
-                sum = 0;
-                node_counter = 0;
+    // Scrittura del testo casuale
+    generate_random_text(lazy_table.word_frequencies, words_to_generate, previous_word, output_file, &lazy_table);
 
-                // Resetta l'indice
-                index = 0;
-                break;
+    hashmap_destroy(lazy_table.word_frequencies);
+}
 
-            // Ignora gli spazi
-            case L' ':
-                break;
+/**
+ * Genera un testo casuale dall'immagine della tabella nella cache, creandola se non è presente.
+ *
+ * Se l'immagine manca viene acquisito il lock della tabella e l'immagine viene cercata di nuovo:
+ * i processi avviati insieme attendono il primo invece di caricare ciascuno la tabella. Chi crea
+ * l'immagine genera il testo dalla propria tabella, gli altri dall'immagine mappata, condivisa tra
+ * i processi.
+ *
+ * @param cache Il riferimento all'immagine della tabella.
+ * @param input_file Il file di input.
+ * @param words_to_generate Il numero di parole da generare.
+ * @param previous_word La parola precedente.
+ * @param output_file Il file di output.
+ * @param threads Il numero di thread tra cui suddividere il caricamento della tabella, se l'immagine deve essere creata.
+ */
+void flatten_cached(TableCache *cache, FILE *input_file, int words_to_generate, char *previous_word, FILE *output_file, int threads) {
+    HashMap *word_frequencies = table_cache_open(cache);
 
-            default:   
-                // Aggiunge il carattere alla stringa
-                string[index++] = character;
-        }
+    if (!word_frequencies) {
+        table_cache_lock(cache);
+        word_frequencies = table_cache_open(cache);
     }
 
-    // Processamento dell'ultima parola
-    if (index > 0) {
-        string[index] = '\0';
-        process_cell(word_frequencies, string, &hash_value, next_word, &sum, &node_counter);
-        
-        // Se la somma delle frequenze non è 1, errore
-        if (round(sum) != 1) error_handler(ERR_INVALID_TABLE); 
+    if (!word_frequencies) {
+        // Caricamento della tabella e salvataggio dell'immagine, poi il lock viene rilasciato
+        word_frequencies = hashmap_create();
+
+        if (threads > 1) {
+            load_table_threaded(word_frequencies, input_file, threads);
+        } else {
+            Reader *reader = reader_open(input_file);
+            process_table_input(word_frequencies, reader);
+            reader_close(reader);
+        }
+
+        table_cache_store(cache, word_frequencies);
     }
 
+    table_cache_unlock(cache);
+
+    // Scrittura del testo casuale
+    generate_random_text(word_frequencies, words_to_generate, previous_word, output_file, NULL);
+
+    hashmap_destroy(word_frequencies);
+}
+
+/**
+ * Compila una tabella di frequenze in un file binario, che flatten mappa senza leggerlo.
+ *
+ * La tabella viene letta e compilata come per la generazione del testo, quindi il file contiene
+ * anche le tabelle alias e i collegamenti tra le entry.
+ *
+ * @param input_file Il file di input (tabella in formato CSV).
+ * @param output_file Il file di output.
+ */
+void flatten_compile(FILE *input_file, FILE *output_file) {
+    HashMap *word_frequencies = hashmap_create();
+
+    // Lettura dal file e processamento della tabella
+    Reader *reader = reader_open(input_file);
+    process_table_input(word_frequencies, reader);
+    reader_close(reader);
+
+    // Scrittura della tabella compilata
+    if (!table_file_write(word_frequencies, output_file)) error_handler(ERR_OUTPUT_FILE);
+
+    hashmap_destroy(word_frequencies);
+}
+
+/**
+ * Sceglie la parola precedente, se non è stata specificata, e scrive un testo casuale.
+ *
+ * @param word_frequencies La tabella delle frequenze (compilata).
+ * @param words_to_generate Il numero di parole da generare.
+ * @param previous_word La parola precedente (stringa vuota se non è stata specificata).
+ * @param output_file Il file di output.
+ * @param lazy_table La tabella caricata su richiesta (NULL se la tabella è stata caricata interamente).
+ */
+void generate_random_text(HashMap *word_frequencies, int words_to_generate, char *previous_word, FILE *output_file, LazyTable *lazy_table) {
+    // Inizializza l'ambiente per i generatori di numeri casuali
     srand(time(NULL));
 
     // Se la parola precedente non è stata specificata, viene scelta casualmente tra i segni di punteggiatura; altrimenti verifica se è presente nella tabella delle frequenze
-    if (wcscmp(previous_word, L"") == 0) {
-        wchar_t *punctation_marks[] = { L".", L"?", L"!" };
-        wcscpy(previous_word, get_random_string(word_frequencies, punctation_marks, 3));
+    if (previous_word[0] == '\0') {
+        char *punctation_marks[] = { ".", "?", "!" };
+        strcpy(previous_word, get_random_string(word_frequencies, punctation_marks, 3));
+
+        // Se la tabella non contiene segni di punteggiatura, il testo non può iniziare
+        if (previous_word[0] == '\0') error_handler(ERR_INVALID_TABLE);
     } else {
         if (!hashmap_get(word_frequencies, previous_word)) argument_error_handler(ERR_INVALID_OPTION_ARGUMENT, "-w");
     }
 
     // Scrittura del testo casuale
-    write_random_text(word_frequencies, words_to_generate, previous_word, output_file);
+    write_random_text(word_frequencies, words_to_generate, previous_word, output_file, lazy_table);
 }
\ No newline at end of file
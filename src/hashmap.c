@@ -1,74 +1,339 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <wchar.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <limits.h>
 #include <math.h>
+#include <string.h>
 
 #include "hashmap.h"
 #include "error_handler.h"
 
 /**
- * Dimensione iniziale della hashmap.
+ * Dimensione iniziale della hashmap (potenza di due).
  */
-#define INITIAL_SIZE 31
+#define INITIAL_SIZE 32
+
+/**
+ * Dimensione dei blocchi della regione da cui vengono allocate parole, entry e nodi.
+ */
+#define SLAB_SIZE (64 * 1024)
+
+/**
+ * Numero di parole successive oltre il quale vengono indicizzate (sotto la soglia la lista viene
+ * scorsa confrontando gli identificativi).
+ */
+#define SUCCESSOR_INDEX_THRESHOLD 8
+
+/**
+ * Alloca una parola, un'entry o un nodo dal blocco corrente della hashmap, allocando un nuovo blocco se necessario.
+ *
+ * @param map La hashmap.
+ * @param size La dimensione dell'oggetto (multipla di 8).
+ * @return L'offset dell'oggetto.
+ */
+size_t allocate_record(HashMap *map, size_t size);
+
+/**
+ * Calcola l'hash dell'identificativo di una parola.
+ *
+ * La funzione è biiettiva, quindi due identificativi hanno lo stesso hash solo se coincidono.
+ *
+ * @param id L'identificativo.
+ * @return L'hash dell'identificativo.
+ */
+unsigned int hash_id(unsigned int id);
+
+/**
+ * Restituisce una parola a partire dal suo identificativo.
+ *
+ * @param map La hashmap.
+ * @param id L'identificativo della parola.
+ * @return La parola.
+ */
+Word *get_word(HashMap *map, unsigned int id);
+
+/**
+ * Cerca una parola nella tabella delle parole.
+ *
+ * @param map La hashmap.
+ * @param word Il testo della parola.
+ * @param word_hash L'hash del testo.
+ * @return La parola, NULL se non è presente.
+ */
+Word *find_word(HashMap *map, char *word, unsigned int word_hash);
+
+/**
+ * Restituisce una parola, aggiungendola alla tabella delle parole se non è presente.
+ *
+ * @param map La hashmap.
+ * @param word Il testo della parola.
+ * @return La parola.
+ */
+Word *intern_word(HashMap *map, char *word);
+
+/**
+ * Aggiunge una nuova entry per una parola.
+ *
+ * @param map La hashmap.
+ * @param word La parola.
+ * @return L'entry creata.
+ */
+Entry *add_entry(HashMap *map, Word *word);
+
+/**
+ * Inserisce un nodo in testa alla lista delle parole successive di una entry.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ * @param next_word L'identificativo della parola successiva.
+ * @param frequency La frequenza della parola successiva.
+ * @return Il nodo inserito.
+ */
+Node *add_node(HashMap *map, Entry *entry, unsigned int next_word, double frequency);
+
+/**
+ * Inserisce una parola o un nodo negli slot di una tabella con probing robin hood.
+ *
+ * @param slots Gli slot della tabella.
+ * @param mask La maschera della tabella (dimensione meno uno).
+ * @param slot Lo slot da inserire.
+ */
+void place_slot(Slot *slots, size_t mask, Slot slot);
+
+/**
+ * Cerca il nodo di una parola successiva.
+ *
+ * Se l'entry ha più di SUCCESSOR_INDEX_THRESHOLD parole successive e non ha ancora un indice,
+ * l'indice viene creato.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ * @param next_word L'identificativo della parola successiva.
+ * @return Il nodo della parola successiva, NULL se non è presente.
+ */
+Node *find_node(HashMap *map, Entry *entry, unsigned int next_word);
+
+/**
+ * Inserisce un nodo nell'indice delle parole successive di una entry, ingrandendolo se necessario.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry (con indice).
+ * @param slot Lo slot del nodo.
+ */
+void index_node(HashMap *map, Entry *entry, Slot slot);
+
+/**
+ * Converte l'identificativo di una parola di un'altra hashmap, aggiungendo la parola se non è ancora stata convertita.
+ *
+ * @param map La hashmap di destinazione.
+ * @param other La hashmap sorgente.
+ * @param words La conversione degli identificativi (UINT_MAX per quelli non ancora convertiti).
+ * @param id L'identificativo della parola nella sorgente.
+ * @return L'identificativo della parola nella destinazione.
+ */
+unsigned int translate_word(HashMap *map, HashMap *other, unsigned int *words, unsigned int id);
+
+/**
+ * Costruisce la tabella alias delle parole successive di un'entry.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ * @param weights Lo spazio per i pesi delle parole successive (almeno size elementi).
+ * @param small Lo spazio per gli slot con peso minore di 1 (almeno size elementi).
+ * @param large Lo spazio per gli slot con peso almeno 1 (almeno size elementi).
+ * @return true se ogni parola successiva ha un'entry, false altrimenti.
+ */
+bool build_alias(HashMap *map, Entry *entry, double *weights, unsigned int *small, unsigned int *large);
+
+/**
+ * Verifica che un oggetto, o un array di oggetti, sia contenuto nella regione di una hashmap.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset dell'oggetto.
+ * @param count Il numero di oggetti.
+ * @param size La dimensione di un oggetto.
+ * @return true se l'offset è allineato e gli oggetti sono contenuti nella regione, false altrimenti.
+ */
+bool check_object(HashMap *map, size_t offset, size_t count, size_t size);
+
+/**
+ * Verifica una parola di una hashmap, compreso il suo testo.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset della parola.
+ * @return La parola, NULL se non è contenuta nella regione.
+ */
+Word *check_word(HashMap *map, size_t offset);
+
+/**
+ * Verifica che tutti gli offset di una hashmap caricata da un file siano validi.
+ *
+ * @param map La hashmap (compilata).
+ * @return true se la hashmap è valida, false altrimenti.
+ */
+bool check_hashmap(HashMap *map);
+
+/**
+ * Scrive una parola in un buffer binario.
+ *
+ * @param buffer Il buffer.
+ * @param offset L'offset in cui scrivere la parola.
+ * @param word La parola da scrivere.
+ * @return L'offset successivo alla parola.
+ */
+size_t serialize_word(char *buffer, size_t offset, char *word);
+
+/**
+ * Ingrandisce un buffer, se necessario, in modo che contenga almeno la dimensione richiesta.
+ *
+ * @param buffer Il buffer.
+ * @param size La dimensione del buffer, aggiornata se il buffer viene ingrandito.
+ * @param required La dimensione richiesta.
+ * @return Il buffer ingrandito.
+ */
+char *reserve_buffer(char *buffer, size_t *size, size_t required);
+
+/**
+ * Legge una parola da un buffer binario.
+ *
+ * @param position La posizione del buffer da cui leggere.
+ * @param end La fine del buffer.
+ * @param word La parola letta.
+ * @return La posizione successiva alla parola.
+ */
+char *deserialize_word(char *position, char *end, char *word);
+
+/**
+ * Legge un valore numerico da un buffer binario.
+ *
+ * @param position La posizione del buffer da cui leggere.
+ * @param end La fine del buffer.
+ * @param value Il valore letto.
+ * @param size La dimensione del valore.
+ * @return La posizione successiva al valore.
+ */
+char *deserialize_value(char *position, char *end, void *value, size_t size);
 
 /**
  * Calcola l'hash di una stringa.
  *
  * @param string La stringa di cui calcolare l'hash.
- * @param size La dimensione della hashmap.
- * @return L'hash della stringa.
+ * @return L'hash della stringa (da ridurre con la maschera della tabella).
  */
-unsigned int hash(wchar_t *string, int size) {
-    unsigned int hash = 0;
+unsigned int hash(char *string) {
+    // FNV-1a sui byte della stringa
+    unsigned int hash = 2166136261u;
 
     for (int i = 0; string[i] != '\0'; i++) {
-        hash = (hash * 31) + string[i];
+        hash = (hash ^ (unsigned char)string[i]) * 16777619u;
     }
 
-    return hash % size;
+    // Mescolamento finale, in modo che anche i bit bassi usati dalla maschera dipendano da tutti i caratteri
+    return hash_id(hash);
+}
+
+/**
+ * Calcola l'hash dell'identificativo di una parola.
+ *
+ * La funzione è biiettiva, quindi due identificativi hanno lo stesso hash solo se coincidono.
+ *
+ * @param id L'identificativo.
+ * @return L'hash dell'identificativo.
+ */
+unsigned int hash_id(unsigned int id) {
+    // Ogni passo (xor con uno shift o prodotto per un numero dispari) è invertibile
+    id ^= id >> 16;
+    id *= 0x85ebca6bu;
+    id ^= id >> 13;
+    id *= 0xc2b2ae35u;
+    id ^= id >> 16;
+
+    return id;
 }
 
 /**
  * Crea un nodo.
  *
- * @param next_word La parola successiva.
+ * @param map La hashmap in cui allocare il nodo.
+ * @param next_word L'identificativo della parola successiva.
  * @param frequency La frequenza della parola successiva.
- * @return Il nodo creato.
+ * @return L'offset del nodo creato.
  */
-Node *create_node(wchar_t *next_word, double frequency) {
+size_t create_node(HashMap *map, unsigned int next_word, double frequency) {
     // Allocazione del nodo
-    Node *node = (Node *)malloc(sizeof(Node));
-    if (!node) error_handler(ERR_MEMORY_ALLOCATION);
+    size_t offset = allocate_record(map, sizeof(Node));
+    Node *node = hashmap_node(map, offset);
 
     // Inizializzazione del nodo
-    wcscpy(node->next_word, next_word);
+    node->next_word = next_word;
     node->frequency = frequency;
-    node->next = NULL;
+    node->count = 0;
+    node->next = 0;
 
     // Restituzione del nodo
-    return node;
+    return offset;
 }
 
 /**
  * Crea una entry.
  *
- * @param word La parola.
- * @return L'entry creata.
+ * @param map La hashmap in cui allocare l'entry.
+ * @param word L'identificativo della parola.
+ * @return L'offset dell'entry creata.
  */
-Entry *crate_entry(wchar_t *word) {
+size_t crate_entry(HashMap *map, unsigned int word) {
     // Allocazione dell'entry
-    Entry *entry = (Entry *)malloc(sizeof(Entry));
-    if (!entry) error_handler(ERR_MEMORY_ALLOCATION);
+    size_t offset = allocate_record(map, sizeof(Entry));
+    Entry *entry = hashmap_entry(map, offset);
 
     // Inizializzazione dell'entry
-    wcscpy(entry->word, word);
-    entry->next_words = NULL;
+    entry->word = word;
+    entry->next_words = 0;
     entry->size = 0;
-    entry->next = NULL;
+    entry->count = 0;
+    entry->next_inserted = 0;
+    entry->successors = 0;
+    entry->successors_size = 0;
+    entry->alias = 0;
 
     // Restituzione dell'entry
-    return entry;
+    return offset;
+}
+
+/**
+ * Crea una nuova hashmap in una regione.
+ *
+ * @param region La regione.
+ * @return La hashmap creata.
+ */
+HashMap *create_hashmap(Region *region) {
+    // Allocazione della hashmap
+    HashMap *map = (HashMap *)malloc(sizeof(HashMap));
+    if (!map) error_handler(ERR_MEMORY_ALLOCATION);
+
+    map->region = region;
+
+    // Allocazione degli slot (la regione è inizializzata a zero, quindi sono vuoti)
+    map->slots = region_allocate(region, INITIAL_SIZE * sizeof(Slot));
+    map->size = INITIAL_SIZE;
+
+    // Allocazione dell'array delle parole
+    map->words = region_allocate(region, INITIAL_SIZE * sizeof(size_t));
+    map->words_size = INITIAL_SIZE;
+    map->word_count = 0;
+
+    // Lista delle entry in ordine di inserimento
+    map->usage = 0;
+    map->first = 0;
+    map->last = 0;
+
+    // Il primo blocco per parole, entry e nodi viene allocato al primo inserimento
+    map->slab = 0;
+    map->slab_end = 0;
+
+    // Restituzione della hashmap
+    return map;
 }
 
 /**
@@ -77,21 +342,356 @@ Entry *crate_entry(wchar_t *word) {
  * @return La hashmap creata.
  */
 HashMap *hashmap_create() {
+    return create_hashmap(region_create(-1));
+}
+
+/**
+ * Crea una nuova hashmap in una regione condivisa.
+ *
+ * @param fd Il file descriptor del file della regione.
+ * @return La hashmap creata.
+ */
+HashMap *hashmap_create_shared(int fd) {
+    return create_hashmap(region_create(fd));
+}
+
+/**
+ * Apre in sola lettura una hashmap pubblicata in una regione.
+ *
+ * @param region La regione.
+ * @return La hashmap aperta, NULL se la hashmap non è stata pubblicata.
+ */
+HashMap *open_hashmap(Region *region) {
+    // La hashmap deve essere stata pubblicata e la sua radice deve essere contenuta nella regione
+    RegionHeader *header = region_header(region);
+    if (!header->root || header->size > region->capacity || header->root % 8 != 0 || header->root > header->size || header->size - header->root < sizeof(HashMapRoot)) return NULL;
+
     // Allocazione della hashmap
     HashMap *map = (HashMap *)malloc(sizeof(HashMap));
     if (!map) error_handler(ERR_MEMORY_ALLOCATION);
 
-    // Allocazione dei bucket
-    map->buckets = (Entry **)calloc(INITIAL_SIZE, sizeof(Entry *));
-    if (!map->buckets) error_handler(ERR_MEMORY_ALLOCATION);
+    map->region = region;
 
-    // Dimensione iniziale
-    map->size = INITIAL_SIZE;
+    // Lettura dei campi della hashmap
+    HashMapRoot *root = region_pointer(map->region, header->root);
+    map->slots = root->slots;
+    map->size = root->size;
+    map->words = root->words;
+    map->words_size = root->word_count;
+    map->word_count = root->word_count;
+    map->usage = root->usage;
+    map->first = root->first;
+    map->last = root->last;
+
+    // La hashmap aperta è in sola lettura
+    map->slab = 0;
+    map->slab_end = 0;
 
     // Restituzione della hashmap
     return map;
 }
 
+/**
+ * Apre in sola lettura una hashmap pubblicata da un altro processo in una regione condivisa.
+ *
+ * @param fd Il file descriptor del file della regione.
+ * @return La hashmap aperta.
+ */
+HashMap *hashmap_open(int fd) {
+    // Mappatura della regione, in cui la hashmap deve essere stata pubblicata
+    HashMap *map = open_hashmap(region_attach(fd));
+    if (!map) error_handler(ERR_INTERNAL_ERROR);
+
+    return map;
+}
+
+/**
+ * Apre in sola lettura una hashmap pubblicata e salvata in un file, a partire da un offset.
+ *
+ * @param fd Il file descriptor del file.
+ * @param offset L'offset della regione della hashmap nel file (multiplo della dimensione di una pagina).
+ * @return La hashmap aperta, NULL se il file non contiene una hashmap pubblicata.
+ */
+HashMap *hashmap_load(int fd, size_t offset) {
+    // Mappatura della regione
+    Region *region = region_map(fd, offset);
+    if (!region) return NULL;
+
+    // La hashmap deve essere stata pubblicata prima del salvataggio
+    HashMap *map = open_hashmap(region);
+    if (!map) {
+        region_destroy(region);
+        return NULL;
+    }
+
+    // Il file può essere stato modificato, quindi gli offset vengono verificati prima di essere usati
+    if (!check_hashmap(map)) {
+        hashmap_destroy(map);
+        return NULL;
+    }
+
+    return map;
+}
+
+/**
+ * Verifica che un oggetto, o un array di oggetti, sia contenuto nella regione di una hashmap.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset dell'oggetto.
+ * @param count Il numero di oggetti.
+ * @param size La dimensione di un oggetto.
+ * @return true se l'offset è allineato e gli oggetti sono contenuti nella regione, false altrimenti.
+ */
+bool check_object(HashMap *map, size_t offset, size_t count, size_t size) {
+    size_t region_size = region_header(map->region)->size;
+
+    // Il numero di oggetti viene confrontato con una divisione, in modo che il prodotto non possa superare i limiti di size_t
+    return offset >= sizeof(RegionHeader) && offset % 8 == 0 && offset <= region_size && count <= (region_size - offset) / size;
+}
+
+/**
+ * Verifica una parola di una hashmap, compreso il suo testo.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset della parola.
+ * @return La parola, NULL se non è contenuta nella regione.
+ */
+Word *check_word(HashMap *map, size_t offset) {
+    if (!check_object(map, offset, 1, offsetof(Word, text))) return NULL;
+
+    // Il testo deve terminare all'interno della regione e non essere più lungo di una parola
+    Word *word = region_pointer(map->region, offset);
+    size_t available = region_header(map->region)->size - offset - offsetof(Word, text);
+    if (available > MAX_WORD_BYTES) available = MAX_WORD_BYTES;
+
+    return memchr(word->text, '\0', available) ? word : NULL;
+}
+
+/**
+ * Verifica che tutti gli offset di una hashmap caricata da un file siano validi, in modo che la
+ * generazione del testo non acceda mai fuori dalla regione.
+ *
+ * Vengono verificati l'array delle parole e i loro testi, gli slot (che devono contenere solo
+ * parole dell'array e almeno uno slot vuoto, in modo che la ricerca termini), la lista delle
+ * entry, i loro nodi (se presenti) e le loro tabelle alias, i cui collegamenti devono coincidere
+ * con le entry delle parole successive.
+ *
+ * @param map La hashmap (compilata).
+ * @return true se la hashmap è valida, false altrimenti.
+ */
+bool check_hashmap(HashMap *map) {
+    // Array delle parole e slot (la radice è stata verificata da open_hashmap)
+    if (map->word_count >= UINT_MAX || !check_object(map, map->words, map->word_count, sizeof(size_t))) return false;
+    if (map->size == 0 || (map->size & (map->size - 1)) != 0 || map->word_count >= map->size || !check_object(map, map->slots, map->size, sizeof(Slot))) return false;
+
+    // Ogni parola deve avere l'identificativo della sua posizione nell'array
+    size_t *words = region_pointer(map->region, map->words);
+
+    for (size_t id = 0; id < map->word_count; id++) {
+        Word *word = check_word(map, words[id]);
+        if (!word || word->id != id) return false;
+    }
+
+    // Gli slot occupati devono contenere parole dell'array, quindi almeno uno resta vuoto
+    Slot *slots = region_pointer(map->region, map->slots);
+    size_t occupied = 0;
+
+    for (size_t i = 0; i < map->size; i++) {
+        if (!slots[i].offset) continue;
+
+        Word *word = check_word(map, slots[i].offset);
+        if (!word || word->id >= map->word_count || words[word->id] != slots[i].offset || ++occupied > map->word_count) return false;
+    }
+
+    // Parole la cui entry è stata trovata nella lista
+    bool *linked = (bool *)calloc(map->word_count + 1, sizeof(bool));
+    if (!linked) error_handler(ERR_MEMORY_ALLOCATION);
+
+    bool valid = true;
+    size_t entries = 0;
+
+    // La lista non può contenere più entry di quelle della hashmap, altrimenti contiene un ciclo
+    for (size_t offset = map->first; offset && valid; offset = hashmap_entry(map, offset)->next_inserted) {
+        valid = ++entries <= map->usage && check_object(map, offset, 1, sizeof(Entry));
+        if (!valid) break;
+
+        Entry *entry = hashmap_entry(map, offset);
+        valid = entry->word < map->word_count && entry->size > 0 && check_object(map, entry->alias, entry->size, sizeof(AliasSlot));
+        if (!valid) break;
+
+        if (get_word(map, entry->word)->entry == offset) linked[entry->word] = true;
+
+        // La lista dei nodi, se non è stata rimossa da hashmap_compact, deve contenere esattamente le parole successive dell'entry
+        size_t nodes = 0;
+
+        for (size_t node = entry->next_words; node && valid; node = hashmap_node(map, node)->next) {
+            valid = ++nodes <= entry->size && check_object(map, node, 1, sizeof(Node)) && hashmap_node(map, node)->next_word < map->word_count;
+        }
+
+        valid = valid && (nodes == entry->size || !entry->next_words);
+    }
+
+    valid = valid && entries == map->usage;
+
+    // Ogni parola deve puntare a un'entry della lista (o a nessuna)
+    for (size_t id = 0; id < map->word_count && valid; id++) {
+        valid = !get_word(map, id)->entry || linked[id];
+    }
+
+    // Gli alias devono essere slot dell'entry e le parole successive devono essere collegate alle loro entry
+    for (Entry *entry = hashmap_entry(map, map->first); entry && valid; entry = hashmap_entry(map, entry->next_inserted)) {
+        AliasSlot *alias = hashmap_alias(map, entry);
+
+        for (size_t i = 0; i < entry->size && valid; i++) {
+            valid = alias[i].alias < entry->size && alias[i].next_word < map->word_count && alias[i].next_entry && alias[i].next_entry == get_word(map, alias[i].next_word)->entry;
+        }
+    }
+
+    free(linked);
+
+    return valid;
+}
+
+/**
+ * Pubblica una hashmap e salva la sua regione su un file, in modo che possa essere aperta con hashmap_load.
+ *
+ * Gli oggetti della regione si riferiscono tra loro tramite offset, quindi la regione viene
+ * scritta così com'è, fino all'ultimo byte occupato (per non scrivere anche gli oggetti non più
+ * usati, la hashmap va prima copiata con hashmap_compact).
+ *
+ * @param map La hashmap.
+ * @param file Il file.
+ * @return true se la regione è stata scritta, false altrimenti.
+ */
+bool hashmap_save(HashMap *map, FILE *file) {
+    hashmap_publish(map);
+
+    size_t size = region_header(map->region)->size;
+    return fwrite(map->region->base, 1, size, file) == size;
+}
+
+/**
+ * Copia una hashmap compilata in una nuova regione, con i soli oggetti usati dalla generazione del testo.
+ *
+ * Nella regione restano gli slot e gli array delle parole sostituiti dai ridimensionamenti, gli
+ * indici delle parole successive e lo spazio libero dei blocchi. La copia contiene solo l'array
+ * delle parole, i loro testi, gli slot (dimensionati sul numero di parole), le entry in ordine di
+ * inserimento e le loro tabelle alias; nodi e indici delle parole successive servono solo per gli
+ * inserimenti e per la costruzione delle tabelle alias (che contengono già le parole successive e
+ * le loro probabilità), quindi non vengono copiati.
+ *
+ * @param map La hashmap (compilata).
+ * @return La hashmap compattata (senza nodi), in una nuova regione privata.
+ */
+HashMap *hashmap_compact(HashMap *map) {
+    // Allocazione della hashmap
+    HashMap *compact = (HashMap *)malloc(sizeof(HashMap));
+    if (!compact) error_handler(ERR_MEMORY_ALLOCATION);
+
+    Region *region = region_create(-1);
+    compact->region = region;
+    compact->word_count = map->word_count;
+    compact->words_size = map->word_count;
+    compact->usage = 0;
+    compact->first = 0;
+    compact->last = 0;
+    compact->slab = 0;
+    compact->slab_end = 0;
+
+    // Array delle parole e testi, in ordine di identificativo (le entry vengono collegate dopo)
+    compact->words = region_allocate(region, (map->word_count + 1) * sizeof(size_t));
+
+    for (size_t id = 0; id < map->word_count; id++) {
+        Word *word = get_word(map, id);
+        size_t length = strlen(word->text);
+
+        size_t offset = region_allocate(region, (offsetof(Word, text) + length + 1 + 7) & ~(size_t)7);
+        Word *new_word = region_pointer(region, offset);
+        new_word->entry = 0;
+        new_word->id = id;
+        memcpy(new_word->text, word->text, length + 1);
+
+        ((size_t *)region_pointer(region, compact->words))[id] = offset;
+    }
+
+    // Slot dimensionati sul numero di parole, riempiti con gli hash memorizzati (la regione è inizializzata a zero)
+    compact->size = INITIAL_SIZE;
+    while (compact->word_count > compact->size * HASHMAP_MAX_LOAD_FACTOR) compact->size *= 2;
+
+    compact->slots = region_allocate(region, compact->size * sizeof(Slot));
+    Slot *slots = region_pointer(map->region, map->slots);
+
+    for (size_t i = 0; i < map->size; i++) {
+        if (!slots[i].offset) continue;
+
+        Word *word = region_pointer(map->region, slots[i].offset);
+        place_slot(region_pointer(region, compact->slots), compact->size - 1, (Slot){ slots[i].hash, ((size_t *)region_pointer(region, compact->words))[word->id] });
+    }
+
+    // Entry in ordine di inserimento (ogni parola viene collegata all'entry a cui è collegata nell'originale)
+    for (size_t offset = map->first; offset; offset = hashmap_entry(map, offset)->next_inserted) {
+        Entry *entry = hashmap_entry(map, offset);
+
+        size_t new_offset = region_allocate(region, sizeof(Entry));
+        Entry *new_entry = hashmap_entry(compact, new_offset);
+        *new_entry = *entry;
+        new_entry->next_words = 0;
+        new_entry->next_inserted = 0;
+        new_entry->successors = 0;
+        new_entry->successors_size = 0;
+        new_entry->alias = 0;
+
+        if (compact->last) {
+            hashmap_entry(compact, compact->last)->next_inserted = new_offset;
+        } else {
+            compact->first = new_offset;
+        }
+
+        compact->last = new_offset;
+        compact->usage++;
+
+        if (get_word(map, entry->word)->entry == offset) get_word(compact, entry->word)->entry = new_offset;
+    }
+
+    // Tabelle alias, collegate alle entry della copia
+    for (Entry *entry = hashmap_entry(map, map->first), *new_entry = hashmap_entry(compact, compact->first); entry; entry = hashmap_entry(map, entry->next_inserted), new_entry = hashmap_entry(compact, new_entry->next_inserted)) {
+        if (!entry->alias) continue;
+
+        new_entry->alias = region_allocate(region, entry->size * sizeof(AliasSlot));
+        AliasSlot *new_slots = hashmap_alias(compact, new_entry);
+        memcpy(new_slots, hashmap_alias(map, entry), entry->size * sizeof(AliasSlot));
+
+        for (size_t i = 0; i < entry->size; i++) {
+            if (new_slots[i].next_entry) new_slots[i].next_entry = get_word(compact, new_slots[i].next_word)->entry;
+        }
+    }
+
+    // Restituzione della hashmap compattata
+    return compact;
+}
+
+/**
+ * Pubblica una hashmap nella sua regione, in modo che possa essere aperta da un altro processo.
+ *
+ * @param map La hashmap da pubblicare.
+ */
+void hashmap_publish(HashMap *map) {
+    RegionHeader *header = region_header(map->region);
+
+    // Allocazione dei campi della hashmap nella regione
+    if (!header->root) header->root = region_allocate(map->region, sizeof(HashMapRoot));
+
+    // Scrittura dei campi della hashmap
+    HashMapRoot *root = region_pointer(map->region, header->root);
+    root->slots = map->slots;
+    root->size = map->size;
+    root->words = map->words;
+    root->word_count = map->word_count;
+    root->usage = map->usage;
+    root->first = map->first;
+    root->last = map->last;
+}
+
 /**
  * Ridimensiona una hashmap.
  *
@@ -101,37 +701,52 @@ void hashmap_resize(HashMap *map) {
     // Nuova dimensione
     size_t new_size = map->size * 2;
 
-    // Nuovi bucket
-    Entry **new_buckets = (Entry **)calloc(new_size, sizeof(Entry *));
-    if (!new_buckets) error_handler(ERR_MEMORY_ALLOCATION);
-    
-    // Scorrimento dei bucket
-    for (int i = 0; i < map->size; i++) {
-        Entry *entry = map->buckets[i];
-
-        // Scorrimento delle entry
-        while (entry) {
-            // Salvataggio dell'entry successiva
-            Entry *next_entry = entry->next;
+    // Nuovi slot (i vecchi restano nella regione fino alla sua distruzione)
+    size_t new_slots_offset = region_allocate(map->region, new_size * sizeof(Slot));
+    Slot *new_slots = region_pointer(map->region, new_slots_offset);
+    Slot *slots = region_pointer(map->region, map->slots);
 
-            // Calcolo del nuovo indice
-            unsigned int index = hash(entry->word, new_size);
+    // Le parole vengono reinserite usando gli hash memorizzati negli slot
+    for (size_t i = 0; i < map->size; i++) {
+        if (slots[i].offset) place_slot(new_slots, new_size - 1, slots[i]);
+    }
 
-            // Inserimento dell'entry
-            entry->next = new_buckets[index];
-            new_buckets[index] = entry;
+    // Aggiornamento della hashmap
+    map->slots = new_slots_offset;
+    map->size = new_size;
+}
 
-            // Entry successiva
-            entry = next_entry;
+/**
+ * Inserisce una parola o un nodo negli slot di una tabella con probing robin hood.
+ *
+ * @param slots Gli slot della tabella.
+ * @param mask La maschera della tabella (dimensione meno uno).
+ * @param slot Lo slot da inserire.
+ */
+void place_slot(Slot *slots, size_t mask, Slot slot) {
+    size_t index = slot.hash & mask;
+    size_t distance = 0;
+
+    // Scorrimento degli slot a partire da quello indicato dall'hash
+    while (slots[index].offset) {
+        // Distanza dell'elemento presente dal suo slot
+        size_t existing_distance = (index - slots[index].hash) & mask;
+
+        // Se l'elemento presente è più vicino al suo slot, cede il posto e viene reinserito più avanti
+        if (existing_distance < distance) {
+            Slot existing = slots[index];
+            slots[index] = slot;
+            slot = existing;
+            distance = existing_distance;
         }
-    }
 
-    // Deallocazione dei vecchi bucket
-    free(map->buckets);
+        // Slot successivo
+        index = (index + 1) & mask;
+        distance++;
+    }
 
-    // Aggiornamento della hashmap
-    map->buckets = new_buckets;
-    map->size = new_size;
+    // Inserimento nello slot vuoto
+    slots[index] = slot;
 }
 
 /**
@@ -140,77 +755,239 @@ void hashmap_resize(HashMap *map) {
  * @param map La hashmap da distruggere.
  */
 void hashmap_destroy(HashMap *map) {
-    // Scorrimento dei bucket
-    for (int i = 0; i < map->size; i++) {
-        Entry *entry = map->buckets[i];
+    // Slot, parole, entry e nodi vengono deallocati insieme alla regione
+    region_destroy(map->region);
 
-        // Scorrimento delle entry
-        while (entry) {
-            Node *node = entry->next_words;
+    // Deallocazione della hashmap
+    free(map);
+}
 
-            // Scorrimento dei nodi
-            while (node) {
-                Node *next_node = node->next;
+/**
+ * Restituisce l'identificativo di una parola, aggiungendola alla tabella delle parole se non è presente.
+ *
+ * @param map La hashmap.
+ * @param word La parola.
+ * @return L'identificativo della parola.
+ */
+unsigned int hashmap_intern(HashMap *map, char *word) {
+    return intern_word(map, word)->id;
+}
 
-                // Deallocazione del nodo
-                free(node);
+/**
+ * Restituisce il testo di una parola a partire dal suo identificativo.
+ *
+ * @param map La hashmap.
+ * @param id L'identificativo della parola.
+ * @return Il testo della parola.
+ */
+char *hashmap_word(HashMap *map, unsigned int id) {
+    return get_word(map, id)->text;
+}
 
-                node = next_node;
-            }
+/**
+ * Restituisce l'entry di una parola a partire dal suo identificativo.
+ *
+ * @param map La hashmap.
+ * @param id L'identificativo della parola.
+ * @return L'entry della parola, NULL se la parola non ha un'entry.
+ */
+Entry *hashmap_word_entry(HashMap *map, unsigned int id) {
+    return hashmap_entry(map, get_word(map, id)->entry);
+}
 
-            Entry *next_entry = entry->next;
-            
-            // Deallocazione dell'entry
-            free(entry);
+/**
+ * Restituisce una parola a partire dal suo identificativo.
+ *
+ * @param map La hashmap.
+ * @param id L'identificativo della parola.
+ * @return La parola.
+ */
+Word *get_word(HashMap *map, unsigned int id) {
+    size_t *words = (size_t *)(map->region->base + map->words);
+    return (Word *)(map->region->base + words[id]);
+}
 
-            entry = next_entry;
+/**
+ * Cerca una parola nella tabella delle parole.
+ *
+ * @param map La hashmap.
+ * @param word Il testo della parola.
+ * @param word_hash L'hash del testo.
+ * @return La parola, NULL se non è presente.
+ */
+Word *find_word(HashMap *map, char *word, unsigned int word_hash) {
+    Slot *slots = region_pointer(map->region, map->slots);
+    size_t mask = map->size - 1;
+
+    size_t index = word_hash & mask;
+    size_t distance = 0;
+
+    // Scorrimento degli slot a partire da quello indicato dall'hash
+    while (slots[index].offset) {
+        // Le parole sono ordinate per distanza, se quella presente è più vicina al suo slot la parola non c'è
+        if (((index - slots[index].hash) & mask) < distance) return NULL;
+
+        // I testi vengono confrontati solo se gli hash coincidono
+        if (slots[index].hash == word_hash) {
+            Word *found = region_pointer(map->region, slots[index].offset);
+            if (strcmp(found->text, word) == 0) return found;
         }
+
+        // Slot successivo
+        index = (index + 1) & mask;
+        distance++;
+    }
+
+    // Se la parola non è stata trovata, viene restituito NULL
+    return NULL;
+}
+
+/**
+ * Restituisce una parola, aggiungendola alla tabella delle parole se non è presente.
+ *
+ * @param map La hashmap.
+ * @param word Il testo della parola.
+ * @return La parola.
+ */
+Word *intern_word(HashMap *map, char *word) {
+    // Se la parola è già presente viene restituita
+    unsigned int word_hash = hash(word);
+
+    Word *found = find_word(map, word, word_hash);
+    if (found) return found;
+
+    // Gli identificativi sono a 32 bit
+    if (map->word_count == UINT_MAX) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Se il fattore di carico supera quello massimo, la tabella viene ridimensionata
+    map->word_count++;
+    if (map->word_count > map->size * HASHMAP_MAX_LOAD_FACTOR) hashmap_resize(map);
+
+    // Se l'array delle parole è pieno, viene raddoppiato (il vecchio resta nella regione)
+    if (map->word_count > map->words_size) {
+        size_t new_words = region_allocate(map->region, map->words_size * 2 * sizeof(size_t));
+        memcpy(region_pointer(map->region, new_words), region_pointer(map->region, map->words), map->words_size * sizeof(size_t));
+
+        map->words = new_words;
+        map->words_size *= 2;
     }
 
-    // Deallocazione dei bucket
-    free(map->buckets);
+    // Allocazione della parola con il suo testo (la dimensione viene allineata a 8 byte)
+    size_t length = strlen(word);
+    size_t offset = allocate_record(map, (offsetof(Word, text) + length + 1 + 7) & ~(size_t)7);
 
-    // Deallocazione della hashmap
-    free(map);
+    Word *new_word = region_pointer(map->region, offset);
+    new_word->entry = 0;
+    new_word->id = map->word_count - 1;
+    memcpy(new_word->text, word, length + 1);
+
+    // Inserimento della parola nella tabella e nell'array
+    place_slot(region_pointer(map->region, map->slots), map->size - 1, (Slot){ word_hash, offset });
+    ((size_t *)region_pointer(map->region, map->words))[new_word->id] = offset;
+
+    // Restituzione della parola
+    return new_word;
 }
 
 /**
- * Inserisce un nodo.
+ * Restituisce una entry a partire dal suo offset.
  *
- * @param head La testa della lista.
+ * @param map La hashmap.
+ * @param offset L'offset dell'entry.
+ * @return L'entry, NULL se l'offset è 0.
+ */
+Entry *hashmap_entry(HashMap *map, size_t offset) {
+    // Calcolato direttamente, senza passare dalla regione, perché viene usato a ogni passo delle liste
+    return offset ? (Entry *)(map->region->base + offset) : NULL;
+}
+
+/**
+ * Restituisce un nodo a partire dal suo offset.
+ *
+ * @param map La hashmap.
+ * @param offset L'offset del nodo.
+ * @return Il nodo, NULL se l'offset è 0.
+ */
+Node *hashmap_node(HashMap *map, size_t offset) {
+    return offset ? (Node *)(map->region->base + offset) : NULL;
+}
+
+/**
+ * Inserisce un nodo in testa alla lista delle parole successive di una entry.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
  * @param next_word La parola successiva.
  * @param frequency La frequenza della parola successiva.
- * @return La nuova testa della lista.
+ * @return Il nodo inserito.
  */
-Node *hashmap_insert_node(Node *head, wchar_t *next_word, double frequency) {
+Node *hashmap_add_node(HashMap *map, Entry *entry, char *next_word, double frequency) {
+    return add_node(map, entry, hashmap_intern(map, next_word), frequency);
+}
+
+/**
+ * Inserisce un nodo in testa alla lista delle parole successive di una entry.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ * @param next_word L'identificativo della parola successiva.
+ * @param frequency La frequenza della parola successiva.
+ * @return Il nodo inserito.
+ */
+Node *add_node(HashMap *map, Entry *entry, unsigned int next_word, double frequency) {
     // Viene creato il nodo
-    Node *node = create_node(next_word, frequency);
+    size_t offset = create_node(map, next_word, frequency);
+    Node *node = hashmap_node(map, offset);
 
     // Viene inserito il nodo
-    node->next = head;
-    head = node;
+    node->next = entry->next_words;
+    entry->next_words = offset;
+    entry->size++;
+
+    // Se l'entry ha un indice, il nodo viene indicizzato
+    if (entry->successors) index_node(map, entry, (Slot){ hash_id(next_word), offset });
+
+    // Viene restituito il nodo
+    return node;
+}
 
-    // Viene restituita la nuova testa
-    return head;
+/**
+ * Aggiunge una nuova entry a una hashmap.
+ *
+ * @param map La hashmap.
+ * @param word La parola (che non ha ancora un'entry).
+ * @return L'entry creata.
+ */
+Entry *hashmap_add_entry(HashMap *map, char *word) {
+    return add_entry(map, intern_word(map, word));
 }
 
 /**
- * Inserisce una entry.
+ * Aggiunge una nuova entry per una parola.
  *
- * @param head La testa della lista.
+ * @param map La hashmap.
  * @param word La parola.
- * @return La nuova testa della lista.
+ * @return L'entry creata.
  */
-Entry *hashmap_insert_entry(Entry *head, wchar_t *word) {
-    // Viene creata l'entry
-    Entry *entry = crate_entry(word);
+Entry *add_entry(HashMap *map, Word *word) {
+    // Viene incrementato il numero di entry della hashmap
+    map->usage++;
+
+    // Viene creata l'entry e associata alla parola
+    size_t offset = crate_entry(map, word->id);
+    word->entry = offset;
+
+    // Viene collegata l'entry in coda alla lista in ordine di inserimento
+    if (map->last) {
+        hashmap_entry(map, map->last)->next_inserted = offset;
+    } else {
+        map->first = offset;
+    }
 
-    // Viene inserita l'entry
-    entry->next = head;
-    head = entry;
+    map->last = offset;
 
-    // Viene restituita la nuova testa
-    return head;
+    // Viene restituita l'entry
+    return hashmap_entry(map, offset);
 }
 
 /**
@@ -220,66 +997,38 @@ Entry *hashmap_insert_entry(Entry *head, wchar_t *word) {
  * @param word La parola.
  * @param next_word La parola successiva.
  */
-void hashmap_insert(HashMap *map, wchar_t *word, wchar_t *next_word) {
-    // Viene calcolato l'hash della parola
-    unsigned int index = hash(word, map->size);
-
-    // Viene cercata l'entry della parola
-    Entry *entry = map->buckets[index];
-    
-    // Scorrimento delle entry
-    while (entry) {
-        if (wcscmp(entry->word, word) == 0) {
-            // Viene incrementato il numero di occorrenze della parola
-            entry->size++;
-
-            Node *node = entry->next_words;
-            bool found = false;
-
-            // Scorrimento dei nodi
-            while (node) {
-                // Viene calcolato il numero di occorrenze della parola successiva
-                int frequency = (int)(round(node->frequency * (entry->size - 1)));
-                
-                // Se esiste un nodo per la parola successiva, viene incrementato il numero di occorrenze
-                if (wcscmp(node->next_word, next_word) == 0) {
-                    frequency++;
-                    found = true;
-                }
-
-                // Viene aggiornata la frequenza del nodo
-                node->frequency = (double)frequency / entry->size;
-                
-                // Nodo successivo
-                node = node->next;
-            }
-
-            // Se non esiste un nodo per la parola successiva, viene creato e inserito
-            if (!found) entry->next_words = hashmap_insert_node(entry->next_words, next_word, 1.0 / entry->size);
+void hashmap_insert(HashMap *map, char *word, char *next_word) {
+    unsigned int word_id = hashmap_intern(map, word);
+    hashmap_insert_ids(map, word_id, hashmap_intern(map, next_word));
+}
 
-            // Esce
-            return;
-        }
+/**
+ * Inserisce un nodo in una hashmap a partire dagli identificativi delle parole.
+ *
+ * @param map La hashmap.
+ * @param word L'identificativo della parola.
+ * @param next_word L'identificativo della parola successiva.
+ */
+void hashmap_insert_ids(HashMap *map, unsigned int word, unsigned int next_word) {
+    // Viene cercata l'entry della parola, se non esiste viene creata
+    Word *interned = get_word(map, word);
 
-        // Entry successiva
-        entry = entry->next;
-    }
+    Entry *entry = hashmap_entry(map, interned->entry);
+    if (!entry) entry = add_entry(map, interned);
 
-    // Viene incrementato il numero di entry della hashmap
-    map->usage++;
+    // Viene incrementato il numero di occorrenze della parola
+    entry->count++;
 
-    // Viene calcolato il fattore di carico
-    double load_factor = (double)map->usage / map->size;
+    // Se esiste un nodo per la parola successiva, viene incrementato il numero di occorrenze
+    Node *node = find_node(map, entry, next_word);
 
-    // Se il fattore di carico supera il 75%, la hashmap viene ridimensionata
-    if (load_factor > 0.75) hashmap_resize(map);
-    
-    // Se non esiste un'entry per la parola, viene creata
-    map->buckets[index] = hashmap_insert_entry(map->buckets[index], word);
+    if (node) {
+        node->count++;
+        return;
+    }
 
-    // Viene inserito il nodo per la parola successiva
-    map->buckets[index]->next_words = hashmap_insert_node(map->buckets[index]->next_words, next_word, 1.0);
-    map->buckets[index]->size++;
+    // Se non esiste un nodo per la parola successiva, viene creato e inserito
+    add_node(map, entry, next_word, 0)->count = 1;
 }
 
 /**
@@ -289,241 +1038,602 @@ void hashmap_insert(HashMap *map, wchar_t *word, wchar_t *next_word) {
  * @param word La parola di cui cercare l'entry.
  * @return L'entry della parola.
  */
-Entry *hashmap_get(HashMap *map, wchar_t *word) {
-    // Viene calcolato l'indice della parola
-    unsigned int index = hash(word, map->size);
+Entry *hashmap_get(HashMap *map, char *word) {
+    // Viene cercata la parola, senza aggiungerla
+    Word *found = find_word(map, word, hash(word));
 
-    // Viene cercata l'entry della parola
-    Entry *entry = map->buckets[index];
+    // Se la parola non è presente o non ha un'entry, viene restituito NULL
+    return found ? hashmap_entry(map, found->entry) : NULL;
+}
+
+/**
+ * Cerca il nodo di una parola successiva.
+ *
+ * Se l'entry ha più di SUCCESSOR_INDEX_THRESHOLD parole successive e non ha ancora un indice,
+ * l'indice viene creato.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ * @param next_word L'identificativo della parola successiva.
+ * @return Il nodo della parola successiva, NULL se non è presente.
+ */
+Node *find_node(HashMap *map, Entry *entry, unsigned int next_word) {
+    if (!entry->successors) {
+        if (entry->size <= SUCCESSOR_INDEX_THRESHOLD) {
+            // Poche parole successive: la lista viene scorsa confrontando gli identificativi
+            for (Node *node = hashmap_node(map, entry->next_words); node; node = hashmap_node(map, node->next)) {
+                if (node->next_word == next_word) return node;
+            }
 
-    // Scorrimento delle entry
-    while (entry) {
-        // Se l'entry è stata trovata, viene restituita
-        if (wcscmp(entry->word, word) == 0) return entry;
+            return NULL;
+        }
+
+        // Creazione dell'indice, con spazio per il doppio delle parole successive attuali
+        size_t size = 1;
+        while (size < entry->size * 2) size *= 2;
+
+        entry->successors = region_allocate(map->region, size * sizeof(Slot));
+        entry->successors_size = size;
+
+        // Indicizzazione dei nodi presenti
+        Slot *slots = region_pointer(map->region, entry->successors);
 
-        // Entry successiva
-        entry = entry->next;
+        for (size_t offset = entry->next_words; offset; offset = hashmap_node(map, offset)->next) {
+            place_slot(slots, size - 1, (Slot){ hash_id(hashmap_node(map, offset)->next_word), offset });
+        }
     }
 
-    // Se l'entry non è stata trovata, viene restituita NULL
+    Slot *slots = region_pointer(map->region, entry->successors);
+    size_t mask = entry->successors_size - 1;
+
+    // L'hash è biiettivo, quindi se coincide il nodo è quello della parola successiva
+    unsigned int next_word_hash = hash_id(next_word);
+
+    size_t index = next_word_hash & mask;
+    size_t distance = 0;
+
+    // Scorrimento degli slot a partire da quello indicato dall'hash
+    while (slots[index].offset) {
+        // Se il nodo presente è più vicino al suo slot, la parola successiva non c'è
+        if (((index - slots[index].hash) & mask) < distance) return NULL;
+
+        if (slots[index].hash == next_word_hash) return hashmap_node(map, slots[index].offset);
+
+        // Slot successivo
+        index = (index + 1) & mask;
+        distance++;
+    }
+
+    // Se il nodo non è stato trovato, viene restituito NULL
     return NULL;
 }
 
 /**
- * Converte una hashmap in un buffer.
+ * Inserisce un nodo nell'indice delle parole successive di una entry, ingrandendolo se necessario.
  *
- * @param map La hashmap da convertire.
- * @return Il buffer convertito.
+ * @param map La hashmap.
+ * @param entry L'entry (con indice).
+ * @param slot Lo slot del nodo.
  */
-wchar_t *hashmap_serialize(HashMap *map) {
-    // Dimensione del buffer (inizializzata a 1 per il carattere di fine stringa)
-    size_t buffer_size = sizeof(wchar_t);
+void index_node(HashMap *map, Entry *entry, Slot slot) {
+    // Se il fattore di carico supera quello massimo, l'indice viene raddoppiato (il vecchio resta nella regione)
+    if (entry->size > entry->successors_size * HASHMAP_MAX_LOAD_FACTOR) {
+        size_t new_size = entry->successors_size * 2;
+        size_t new_successors = region_allocate(map->region, new_size * sizeof(Slot));
 
-    // Scorrimento dei bucket
-    for (int i = 0; i < map->size; i++) {
-        Entry *entry = map->buckets[i];
+        Slot *slots = region_pointer(map->region, entry->successors);
+        Slot *new_slots = region_pointer(map->region, new_successors);
 
-        // Scorrimento delle entry
-        while (entry) {
-            // Dimensione dell'entry
-            size_t entry_size = sizeof(wchar_t) * wcslen(entry->word);
+        for (size_t i = 0; i < entry->successors_size; i++) {
+            if (slots[i].offset) place_slot(new_slots, new_size - 1, slots[i]);
+        }
 
-            // Aggiornamento della dimensione del buffer
-            buffer_size += entry_size;
+        entry->successors = new_successors;
+        entry->successors_size = new_size;
+    }
 
-            Node *node = entry->next_words;
+    // Inserimento del nodo
+    place_slot(region_pointer(map->region, entry->successors), entry->successors_size - 1, slot);
+}
 
-            while (node) {
-                // Dimensione della parola successiva
-                size_t next_word_size = sizeof(wchar_t) * wcslen(node->next_word);
+/**
+ * Compila una tabella delle frequenze: costruisce la tabella alias delle parole successive di ogni
+ * entry, a partire dalle frequenze dei nodi, collegando ogni parola successiva alla sua entry.
+ *
+ * @param map La hashmap.
+ * @return true se ogni parola successiva ha un'entry, false altrimenti.
+ */
+bool hashmap_compile(HashMap *map) {
+    // Spazio di lavoro, dimensionato sull'entry con più parole successive
+    size_t size = 0;
+    for (Entry *entry = hashmap_entry(map, map->first); entry; entry = hashmap_entry(map, entry->next_inserted)) {
+        if (entry->size > size) size = entry->size;
+    }
 
-                // Dimensione della frequenza
-                size_t frequency_size = sizeof(wchar_t) * 8;
+    double *weights = (double *)malloc((size + 1) * sizeof(double));
+    unsigned int *small = (unsigned int *)malloc((size + 1) * sizeof(unsigned int));
+    unsigned int *large = (unsigned int *)malloc((size + 1) * sizeof(unsigned int));
+    if (!weights || !small || !large) error_handler(ERR_MEMORY_ALLOCATION);
 
-                // Aggiornamento della dimensione del buffer con la parola successiva, la frequenza e due spazi
-                buffer_size += next_word_size + frequency_size + sizeof(wchar_t) * 2;
+    // Costruzione delle tabelle, interrotta alla prima parola successiva senza entry
+    bool resolved = true;
 
-                // Nodo successivo
-                node = node->next;
-            }
+    for (Entry *entry = hashmap_entry(map, map->first); entry && resolved; entry = hashmap_entry(map, entry->next_inserted)) {
+        resolved = build_alias(map, entry, weights, small, large);
+    }
+
+    free(weights);
+    free(small);
+    free(large);
+
+    return resolved;
+}
+
+/**
+ * Compila una sola entry: costruisce la sua tabella alias, collegando le parole successive che hanno già un'entry.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ */
+void hashmap_compile_entry(HashMap *map, Entry *entry) {
+    // Spazio di lavoro per le parole successive dell'entry
+    double *weights = (double *)malloc((entry->size + 1) * sizeof(double));
+    unsigned int *small = (unsigned int *)malloc((entry->size + 1) * sizeof(unsigned int));
+    unsigned int *large = (unsigned int *)malloc((entry->size + 1) * sizeof(unsigned int));
+    if (!weights || !small || !large) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Le parole successive senza entry restano da collegare
+    build_alias(map, entry, weights, small, large);
+
+    free(weights);
+    free(small);
+    free(large);
+}
+
+/**
+ * Collega uno slot di una tabella alias all'entry della sua parola successiva.
+ *
+ * @param map La hashmap.
+ * @param slot Lo slot.
+ * @return true se la parola successiva ha un'entry, false altrimenti.
+ */
+bool hashmap_resolve_alias(HashMap *map, AliasSlot *slot) {
+    slot->next_entry = get_word(map, slot->next_word)->entry;
+    return slot->next_entry != 0;
+}
+
+/**
+ * Restituisce la tabella alias di un'entry.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ * @return La tabella alias (size slot), NULL se non è stata costruita.
+ */
+AliasSlot *hashmap_alias(HashMap *map, Entry *entry) {
+    return (AliasSlot *)region_pointer(map->region, entry->alias);
+}
+
+/**
+ * Costruisce la tabella alias delle parole successive di un'entry.
+ *
+ * I pesi vengono normalizzati in modo che la loro media sia 1; ogni slot con peso minore di 1
+ * viene completato da uno slot con peso almeno 1, che gli cede la differenza.
+ *
+ * @param map La hashmap.
+ * @param entry L'entry.
+ * @param weights Lo spazio per i pesi delle parole successive (almeno size elementi).
+ * @param small Lo spazio per gli slot con peso minore di 1 (almeno size elementi).
+ * @param large Lo spazio per gli slot con peso almeno 1 (almeno size elementi).
+ * @return true se ogni parola successiva ha un'entry, false altrimenti (gli slot di quelle senza entry hanno next_entry 0).
+ */
+bool build_alias(HashMap *map, Entry *entry, double *weights, unsigned int *small, unsigned int *large) {
+    if (entry->size == 0) return true;
+
+    // Allocazione della tabella
+    entry->alias = region_allocate(map->region, entry->size * sizeof(AliasSlot));
+    AliasSlot *slots = hashmap_alias(map, entry);
+
+    // Parole successive, loro entry (0 se non è ancora presente) e frequenze, nell'ordine della lista
+    size_t size = 0;
+    double total = 0;
+    bool resolved = true;
+
+    for (Node *node = hashmap_node(map, entry->next_words); node; node = hashmap_node(map, node->next)) {
+        slots[size].next_word = node->next_word;
+        slots[size].next_entry = get_word(map, node->next_word)->entry;
+        if (!slots[size].next_entry) resolved = false;
+
+        weights[size] = node->frequency;
+        total += node->frequency;
+        size++;
+    }
 
-            // Carattere di a capo
-            buffer_size += sizeof(wchar_t);
+    // Normalizzazione dei pesi e suddivisione degli slot
+    size_t small_count = 0;
+    size_t large_count = 0;
 
-            // Entry successiva
-            entry = entry->next;
+    for (size_t i = 0; i < size; i++) {
+        weights[i] = total > 0 ? weights[i] * size / total : 1;
+
+        if (weights[i] < 1) {
+            small[small_count++] = i;
+        } else {
+            large[large_count++] = i;
         }
     }
 
-    // Allocazione del buffer
-    wchar_t *buffer = (wchar_t *)malloc(buffer_size);
-    if (!buffer) error_handler(ERR_MEMORY_ALLOCATION);
-    
-    // Offset
-    size_t offset = 0;
+    // Ogni slot con peso minore di 1 prende come alias uno slot con peso almeno 1
+    while (small_count > 0 && large_count > 0) {
+        unsigned int less = small[--small_count];
+        unsigned int more = large[--large_count];
 
-    // Scorrimento dei bucket
-    for (int i = 0; i < map->size; i++) {
-        Entry *entry = map->buckets[i];
+        slots[less].probability = weights[less];
+        slots[less].alias = more;
 
-        // Scorrimento delle entry
-        while (entry) {
-            // Copia la parola nell'entry
-            size_t entry_size = wcslen(entry->word);
-            wmemcpy(buffer + offset, entry->word, entry_size);
-        
-            // Incrementa l'offset della dimensione dell'entry
-            offset += entry_size;
+        // Lo slot alias cede la differenza e viene riclassificato
+        weights[more] = (weights[more] + weights[less]) - 1;
 
-            Node *node = entry->next_words;
+        if (weights[more] < 1) {
+            small[small_count++] = more;
+        } else {
+            large[large_count++] = more;
+        }
+    }
 
-            // Scorrimento dei nodi
-            while (node) {
-                // Carattere di spazio
-                buffer[offset++] = L' ';
+    // Gli slot rimasti hanno peso 1 (a meno di errori di arrotondamento)
+    while (large_count > 0) {
+        unsigned int index = large[--large_count];
+        slots[index].probability = 1;
+        slots[index].alias = index;
+    }
 
-                // Copia la parola successiva
-                size_t next_word_size = wcslen(node->next_word);
-                wmemcpy(buffer + offset, node->next_word, next_word_size);
+    while (small_count > 0) {
+        unsigned int index = small[--small_count];
+        slots[index].probability = 1;
+        slots[index].alias = index;
+    }
 
-                // Incrementa l'offset della dimensione della parola successiva
-                offset += next_word_size;
+    return resolved;
+}
 
-                // Carattere di spazio
-                buffer[offset++] = L' ';
+/**
+ * Unisce una hashmap in un'altra.
+ *
+ * @param map La hashmap di destinazione.
+ * @param other La hashmap da unire.
+ */
+void hashmap_merge(HashMap *map, HashMap *other) {
+    // Le parole della sorgente vengono aggiunte alla destinazione una sola volta, convertendo i loro identificativi
+    unsigned int *words = (unsigned int *)malloc((other->word_count + 1) * sizeof(unsigned int));
+    if (!words) error_handler(ERR_MEMORY_ALLOCATION);
 
-                // Buffer per la frequenza
-                wchar_t frequency[9];
+    memset(words, 0xFF, (other->word_count + 1) * sizeof(unsigned int));
 
-                // Conversione della frequenza in stringa
-                swprintf(frequency, 9, L"%f", node->frequency);
+    // Scorrimento delle entry in ordine di inserimento
+    for (Entry *other_entry = hashmap_entry(other, other->first); other_entry; other_entry = hashmap_entry(other, other_entry->next_inserted)) {
+        hashmap_merge_entry(map, other, other_entry, words);
+    }
 
-                // Copia la frequenza
-                size_t frequency_size = wcslen(frequency);
-                wmemcpy(buffer + offset, frequency, frequency_size);
-                
-                // Incrementa l'offset della dimensione della frequenza
-                offset += frequency_size;
+    // Deallocazione della conversione degli identificativi
+    free(words);
+}
 
-                // Nodo successivo
-                node = node->next;
-            }
+/**
+ * Unisce un'entry di un'altra hashmap in una hashmap.
+ *
+ * @param map La hashmap di destinazione.
+ * @param other La hashmap sorgente.
+ * @param other_entry L'entry da unire.
+ * @param words La conversione degli identificativi delle parole della sorgente in quelli della destinazione (UINT_MAX per quelli non ancora convertiti).
+ * @return L'entry della destinazione.
+ */
+Entry *hashmap_merge_entry(HashMap *map, HashMap *other, Entry *other_entry, unsigned int *words) {
+    // Viene cercata l'entry della parola, se non esiste viene creata
+    Word *word = get_word(map, translate_word(map, other, words, other_entry->word));
 
-            // Carattere di a capo
-            buffer[offset++] = L'\n';
-            
-            // Entry successiva
-            entry = entry->next;
+    Entry *entry = hashmap_entry(map, word->entry);
+    if (!entry) entry = add_entry(map, word);
+
+    // Viene aggiornato il numero di occorrenze della parola
+    entry->count += other_entry->count;
+
+    // I nodi sono in ordine inverso di inserimento, la lista viene invertita
+    size_t offset = 0;
+
+    while (other_entry->next_words) {
+        Node *other_node = hashmap_node(other, other_entry->next_words);
+        size_t next_offset = other_node->next;
+
+        other_node->next = offset;
+        offset = other_entry->next_words;
+
+        other_entry->next_words = next_offset;
+    }
+
+    // Scorrimento dei nodi in ordine di inserimento
+    for (Node *other_node = hashmap_node(other, offset); other_node; other_node = hashmap_node(other, other_node->next)) {
+        // Viene cercato il nodo della parola successiva
+        unsigned int next_word = translate_word(map, other, words, other_node->next_word);
+        Node *node = find_node(map, entry, next_word);
+
+        if (node) {
+            // Se esiste, viene incrementato il numero di occorrenze
+            node->count += other_node->count;
+        } else {
+            // Altrimenti il nodo viene copiato in testa alla lista (le regioni sono distinte)
+            add_node(map, entry, next_word, other_node->frequency)->count = other_node->count;
         }
     }
 
-    // Carattere di fine stringa
-    buffer[offset] = L'\0';
+    other_entry->size = 0;
+    other_entry->count = 0;
+
+    // Viene restituita l'entry
+    return entry;
+}
+
+/**
+ * Converte l'identificativo di una parola di un'altra hashmap, aggiungendo la parola se non è ancora stata convertita.
+ *
+ * @param map La hashmap di destinazione.
+ * @param other La hashmap sorgente.
+ * @param words La conversione degli identificativi (UINT_MAX per quelli non ancora convertiti).
+ * @param id L'identificativo della parola nella sorgente.
+ * @return L'identificativo della parola nella destinazione.
+ */
+unsigned int translate_word(HashMap *map, HashMap *other, unsigned int *words, unsigned int id) {
+    if (words[id] == UINT_MAX) words[id] = hashmap_intern(map, hashmap_word(other, id));
+
+    return words[id];
+}
+
+/**
+ * Alloca una parola, un'entry o un nodo dal blocco corrente della hashmap, allocando un nuovo blocco se necessario.
+ *
+ * @param map La hashmap.
+ * @param size La dimensione dell'oggetto (multipla di 8).
+ * @return L'offset dell'oggetto.
+ */
+size_t allocate_record(HashMap *map, size_t size) {
+    // Se il blocco corrente è esaurito ne viene allocato uno nuovo (lo spazio rimasto nel vecchio non viene usato)
+    if (map->slab_end - map->slab < size) {
+        map->slab = region_allocate(map->region, SLAB_SIZE);
+        map->slab_end = map->slab + SLAB_SIZE;
+    }
+
+    // L'oggetto viene allocato spostando l'inizio dello spazio libero
+    size_t offset = map->slab;
+    map->slab += size;
+
+    return offset;
+}
+
+/**
+ * Converte una hashmap in un buffer binario.
+ *
+ * Vengono scritti prima il numero di parole e, per ogni parola in ordine di identificativo, la sua
+ * lunghezza e i suoi byte in UTF-8; poi il numero di entry e, per ogni entry in ordine di inserimento,
+ * l'identificativo della parola, il numero di occorrenze e il numero di parole successive; per ogni
+ * nodo l'identificativo della parola successiva, il numero di occorrenze e la frequenza. I numeri
+ * vengono copiati così come sono in memoria, quindi il buffer può essere letto solo su una
+ * macchina con la stessa rappresentazione.
+ *
+ * @param map La hashmap da convertire.
+ * @param size La dimensione del buffer.
+ * @return Il buffer convertito.
+ */
+char *hashmap_serialize(HashMap *map, size_t *size) {
+    // Dimensione massima di una parola o di un'entry (o di un nodo)
+    const size_t word_size = MAX_WORD_BYTES;
+    const size_t record_size = sizeof(unsigned int) + 2 * sizeof(size_t);
+
+    // Il buffer viene ingrandito durante la scrittura, in modo da scorrere la hashmap una sola volta
+    size_t buffer_size = 2 * sizeof(size_t) + word_size * (map->word_count + 1) + record_size * (map->usage + 1);
+
+    // Allocazione del buffer
+    char *buffer = (char *)malloc(buffer_size);
+    if (!buffer) error_handler(ERR_MEMORY_ALLOCATION);
+
+    size_t offset = 0;
+
+    // Numero di parole
+    memcpy(buffer, &map->word_count, sizeof(size_t));
+    offset += sizeof(size_t);
+
+    // Parole in ordine di identificativo
+    for (size_t i = 0; i < map->word_count; i++) {
+        buffer = reserve_buffer(buffer, &buffer_size, offset + word_size);
+        offset = serialize_word(buffer, offset, hashmap_word(map, i));
+    }
+
+    // Numero di entry
+    buffer = reserve_buffer(buffer, &buffer_size, offset + sizeof(size_t));
+    memcpy(buffer + offset, &map->usage, sizeof(size_t));
+    offset += sizeof(size_t);
+
+    // Scorrimento delle entry in ordine di inserimento
+    for (Entry *entry = hashmap_entry(map, map->first); entry; entry = hashmap_entry(map, entry->next_inserted)) {
+        buffer = reserve_buffer(buffer, &buffer_size, offset + record_size * (entry->size + 1));
+
+        // Parola, numero di occorrenze e numero di parole successive
+        memcpy(buffer + offset, &entry->word, sizeof(unsigned int));
+        offset += sizeof(unsigned int);
+        memcpy(buffer + offset, &entry->count, sizeof(size_t));
+        offset += sizeof(size_t);
+        memcpy(buffer + offset, &entry->size, sizeof(size_t));
+        offset += sizeof(size_t);
+
+        // Scorrimento dei nodi
+        for (Node *node = hashmap_node(map, entry->next_words); node; node = hashmap_node(map, node->next)) {
+            // Parola successiva, numero di occorrenze e frequenza
+            memcpy(buffer + offset, &node->next_word, sizeof(unsigned int));
+            offset += sizeof(unsigned int);
+            memcpy(buffer + offset, &node->count, sizeof(size_t));
+            offset += sizeof(size_t);
+            memcpy(buffer + offset, &node->frequency, sizeof(double));
+            offset += sizeof(double);
+        }
+    }
 
     // Viene restituito il buffer
+    *size = offset;
     return buffer;
 }
 
 /**
- * Carica una hashmap da un buffer.
+ * Carica una hashmap da un buffer binario.
  *
  * @param map La hashmap da caricare.
  * @param buffer Il buffer da cui caricare la hashmap.
+ * @param size La dimensione del buffer.
  */
- void hashmap_deserialize(HashMap *map, wchar_t *buffer) {
-    // Offset
-    size_t offset = 0;
+void hashmap_deserialize(HashMap *map, char *buffer, size_t size) {
+    char *position = buffer;
+    char *end = buffer + size;
 
-    // Scorrimento del buffer
-    while (buffer[offset] != '\0') {
-        // Indice delle stringhe
-        size_t index = 0;
+    // Numero di parole (ognuna occupa almeno un byte)
+    size_t word_count;
+    position = deserialize_value(position, end, &word_count, sizeof(size_t));
+    if (word_count > (size_t)(end - position)) error_handler(ERR_INTERNAL_ERROR);
 
-        // Viene incrementato il numero di entry della hashmap
-        map->usage++;
+    // Le parole vengono aggiunte alla hashmap, convertendo i loro identificativi
+    Word **words = (Word **)malloc((word_count + 1) * sizeof(Word *));
+    if (!words) error_handler(ERR_MEMORY_ALLOCATION);
 
-        // Viene calcolato il fattore di carico
-        double load_factor = (double)map->usage / map->size;
+    for (size_t i = 0; i < word_count; i++) {
+        char word[MAX_WORD_BYTES];
+        position = deserialize_word(position, end, word);
 
-        // Se il fattore di carico supera il 75%, la hashmap viene ridimensionata
-        if (load_factor > 0.75) hashmap_resize(map);
-        
-        // Parola
-        wchar_t word[MAX_WORD_LENGTH];
+        words[i] = intern_word(map, word);
+    }
 
-        // Legge la parola
-        while (buffer[offset] != L' ') {
-            word[index] = buffer[offset];
+    // Numero di entry
+    size_t entries;
+    position = deserialize_value(position, end, &entries, sizeof(size_t));
 
-            // Viene incrementato l'indice e l'offset
-            index++;
-            offset++;
-        }
+    for (size_t i = 0; i < entries; i++) {
+        // Parola
+        unsigned int word;
+        position = deserialize_value(position, end, &word, sizeof(unsigned int));
+        if (word >= word_count) error_handler(ERR_INTERNAL_ERROR);
 
-        // Viene aggiunto il carattere di fine stringa
-        word[index] = L'\0';
+        // Viene inserita l'entry
+        Entry *entry = add_entry(map, words[word]);
 
-        // Viene incrementato l'offset del carattere di spazio
-        offset++;
+        // Numero di occorrenze e numero di parole successive
+        size_t nodes;
+        position = deserialize_value(position, end, &entry->count, sizeof(size_t));
+        position = deserialize_value(position, end, &nodes, sizeof(size_t));
 
-        // Viene calcolato l'hash della parola
-        unsigned int hash_value = hash(word, map->size);
+        // Ultimo nodo della lista (i nodi vengono inseriti in coda per mantenere l'ordine del buffer)
+        Node *last_node = NULL;
 
-        // Viene inserita l'entry
-        map->buckets[hash_value] = hashmap_insert_entry(map->buckets[hash_value], word);
+        for (size_t j = 0; j < nodes; j++) {
+            // Parola successiva
+            unsigned int next_word;
+            position = deserialize_value(position, end, &next_word, sizeof(unsigned int));
+            if (next_word >= word_count) error_handler(ERR_INTERNAL_ERROR);
+
+            // Viene creato il nodo
+            size_t offset = create_node(map, words[next_word]->id, 0);
+            Node *node = hashmap_node(map, offset);
+
+            // Numero di occorrenze e frequenza
+            position = deserialize_value(position, end, &node->count, sizeof(size_t));
+            position = deserialize_value(position, end, &node->frequency, sizeof(double));
+
+            // Viene inserito il nodo in coda alla lista
+            if (last_node) {
+                last_node->next = offset;
+            } else {
+                entry->next_words = offset;
+            }
 
-        while (buffer[offset] != '\n') {
-            // Reset dell'indice
-            index = 0;
+            last_node = node;
+        }
 
-            // Parola successiva
-            wchar_t next_word[MAX_WORD_LENGTH];
+        entry->size = nodes;
+    }
 
-            // Legge la parola successiva
-            while (buffer[offset] != L' ') {
-                next_word[index] = buffer[offset];
+    // Deallocazione della conversione degli identificativi
+    free(words);
 
-                // Viene incrementato l'indice e l'offset
-                index++;
-                offset++;
-            }
+    // Il buffer deve essere stato letto completamente
+    if (position != end) error_handler(ERR_INTERNAL_ERROR);
+}
 
-            // Viene aggiunto il carattere di fine stringa
-            next_word[index] = L'\0';
+/**
+ * Scrive una parola in un buffer binario.
+ *
+ * @param buffer Il buffer.
+ * @param offset L'offset in cui scrivere la parola.
+ * @param word La parola da scrivere.
+ * @return L'offset successivo alla parola.
+ */
+size_t serialize_word(char *buffer, size_t offset, char *word) {
+    // Lunghezza della parola in byte (minore di MAX_WORD_BYTES)
+    size_t length = strlen(word);
+    buffer[offset++] = (char)length;
+
+    // Byte della parola
+    memcpy(buffer + offset, word, length);
+    return offset + length;
+}
 
-            // Reset dell'indice
-            index = 0;
+/**
+ * Ingrandisce un buffer, se necessario, in modo che contenga almeno la dimensione richiesta.
+ *
+ * @param buffer Il buffer.
+ * @param size La dimensione del buffer, aggiornata se il buffer viene ingrandito.
+ * @param required La dimensione richiesta.
+ * @return Il buffer ingrandito.
+ */
+char *reserve_buffer(char *buffer, size_t *size, size_t required) {
+    if (required <= *size) return buffer;
 
-            // Viene incrementato l'offset del carattere di spazio
-            offset++;
+    // La dimensione viene raddoppiata per mantenere costante il costo medio delle scritture
+    while (*size < required) *size *= 2;
 
-            // Frequenza
-            wchar_t frequency_string[9];
+    buffer = (char *)realloc(buffer, *size);
+    if (!buffer) error_handler(ERR_MEMORY_ALLOCATION);
 
-            // Legge la frequenza
-            while (buffer[offset] != L' ' && buffer[offset] != L'\n') {
-                frequency_string[index] = buffer[offset];
+    return buffer;
+}
 
-                // Viene incrementato l'indice e l'offset
-                index++;
-                offset++;
-            }  
+/**
+ * Legge una parola da un buffer binario.
+ *
+ * @param position La posizione del buffer da cui leggere.
+ * @param end La fine del buffer.
+ * @param word La parola letta.
+ * @return La posizione successiva alla parola.
+ */
+char *deserialize_word(char *position, char *end, char *word) {
+    // Lunghezza della parola
+    if (position >= end) error_handler(ERR_INTERNAL_ERROR);
+    size_t length = (unsigned char)*position++;
 
-            // Viene aggiunto il carattere di fine stringa
-            frequency_string[index] = L'\0';
+    if (length >= MAX_WORD_BYTES || (size_t)(end - position) < length) error_handler(ERR_INTERNAL_ERROR);
 
-            // Viene incrementato l'offset del carattere di spazio
-            if (buffer[offset] == ' ') offset++;
+    // Byte della parola
+    memcpy(word, position, length);
+    word[length] = '\0';
 
-            // Viene convertita la frequenza in double
-            double frequency_value = wcstod(frequency_string, NULL);
+    return position + length;
+}
 
-            // Viene inserito il nodo e incrementata la dimensione della lista
-            map->buckets[hash_value]->next_words = hashmap_insert_node(map->buckets[hash_value]->next_words, next_word, frequency_value);
-            map->buckets[hash_value]->size++;
-        }
+/**
+ * Legge un valore numerico da un buffer binario.
+ *
+ * @param position La posizione del buffer da cui leggere.
+ * @param end La fine del buffer.
+ * @param value Il valore letto.
+ * @param size La dimensione del valore.
+ * @return La posizione successiva al valore.
+ */
+char *deserialize_value(char *position, char *end, void *value, size_t size) {
+    if ((size_t)(end - position) < size) error_handler(ERR_INTERNAL_ERROR);
 
-        // Viene aggiornato l'offset del carattere di a capo
-        offset++;
-    }
+    memcpy(value, position, size);
+    return position + size;
 }
\ No newline at end of file
@@ -1,11 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <wchar.h>
 #include <string.h>
 #include <ctype.h>
 #include <stdbool.h>
 #include <locale.h>
+#include <limits.h>
+#include <errno.h>
 
 #include "tabulate.h"
 #include "flatten.h"
@@ -16,7 +17,7 @@
 /**
  * Stringa delle opzioni consentite.
  */
-#define ALLOWED_OPTIONS ":o:w:mh"
+#define ALLOWED_OPTIONS ":o:w:j:t:e:M:blcmsh"
 
 /**
  * Variabili globali per la gestione delle opzioni.
@@ -47,11 +48,27 @@ typedef struct {
  */
 typedef struct {
     char *output_filename;
-    wchar_t previous_word[MAX_WORD_LENGTH]; 
+    char previous_word[MAX_WORD_BYTES]; 
     bool multiprocess_mode;
+    bool shared_memory_mode;
+    int jobs;
+    int threads;
+    char *engine;
+    int max_memory;
+    bool binary_mode;
+    bool lazy_mode;
+    bool cache_mode;
     bool help_mode;
 } Options;
 
+/**
+ * Struttura che rappresenta un motore della modalità a più thread.
+ */
+typedef struct {
+    TabulateEngine code;
+    char *name;
+} Engine;
+
 /**
  * Array dei comandi.
  */
@@ -60,6 +77,16 @@ Command commands[] = {
     { FLATTEN, "flatten" },
 };
 
+/**
+ * Array dei motori della modalità a più thread.
+ */
+Engine engines[] = {
+    { ENGINE_MERGE, "merge" },
+    { ENGINE_SHARED, "shared" },
+    { ENGINE_SHUFFLE, "shuffle" },
+    { ENGINE_SORT, "sort" },
+};
+
 /**
  * Nome del programma.
  */
@@ -73,6 +100,14 @@ char *program_name;
  */
 CommandCode get_command(char *command);
 
+/**
+ * Restituisce il motore della modalità a più thread corrispondente a una stringa.
+ *
+ * @param engine La stringa da confrontare con i motori (NULL per il motore di default).
+ * @return Il motore corrispondente alla stringa, -1 se la stringa non corrisponde a un motore.
+ */
+int get_engine(char *engine);
+
 /**
  * Verifica se una stringa termina con un suffisso specifico.
  *
@@ -91,6 +126,15 @@ bool ends_with(char *string, char *suffix);
  */
 char *append_suffix(char *string, char *suffix);
 
+/**
+ * Rimuove un suffisso da una stringa, se la stringa termina con il suffisso.
+ *
+ * @param string La stringa da cui rimuovere il suffisso.
+ * @param suffix Il suffisso da rimuovere.
+ * @return La stringa senza il suffisso.
+ */
+char *remove_suffix(char *string, char *suffix);
+
 /**
  * Legge un numero da una stringa.
  *
@@ -160,12 +204,54 @@ int main(int argc, char *argv[]) {
     // Gestisce l'opzione per la parola precedente.
     if (previous_word) {
         if (command == FLATTEN) {
-            if (wcscmp(options.previous_word, L"") == 0) argument_error_handler(ERR_MISSING_OPTION_ARGUMENT, "-w");
+            if (strcmp(options.previous_word, "") == 0) argument_error_handler(ERR_MISSING_OPTION_ARGUMENT, "-w");
         } else {
             argument_error_handler(ERR_UNKNOWN_OPTION, "-w");
         }
     }
 
+    // Gestisce l'opzione per il numero di processi.
+    if (options.jobs && command != TABULATE) argument_error_handler(ERR_UNKNOWN_OPTION, "-j");
+
+    // La suddivisione tra processi sostituisce il multiprocessing, quindi le opzioni non possono essere combinate.
+    if (options.jobs && options.multiprocess_mode) argument_error_handler(ERR_CONFLICTING_OPTION, "-j");
+
+    // Gestisce l'opzione per il numero di thread.
+    if (options.threads && command != TABULATE && command != FLATTEN) argument_error_handler(ERR_UNKNOWN_OPTION, "-t");
+
+    // I thread sostituiscono la suddivisione tra processi e il multiprocessing, quindi le opzioni non possono essere combinate.
+    if (options.threads && (options.jobs || options.multiprocess_mode)) argument_error_handler(ERR_CONFLICTING_OPTION, "-t");
+
+    // Gestisce l'opzione per il motore della modalità a più thread.
+    if (options.engine && command != TABULATE) argument_error_handler(ERR_UNKNOWN_OPTION, "-e");
+
+    // Il motore si applica solo alla modalità a più thread.
+    if (options.engine && options.threads < 2) argument_error_handler(ERR_CONFLICTING_OPTION, "-e");
+
+    // Gestisce l'opzione per la memoria massima.
+    if (options.max_memory && command != TABULATE) argument_error_handler(ERR_UNKNOWN_OPTION, "-M");
+
+    // La memoria limitata richiede la modalità a singolo processo, quindi non può essere combinata con thread, processi e multiprocessing.
+    if (options.max_memory && (options.threads || options.engine || options.jobs || options.multiprocess_mode)) argument_error_handler(ERR_CONFLICTING_OPTION, "-M");
+
+    // Gestisce l'opzione per la tabella compilata.
+    if (options.binary_mode && command != TABULATE) argument_error_handler(ERR_UNKNOWN_OPTION, "-b");
+
+    // La tabella compilata viene costruita rileggendo l'intera tabella in memoria, quindi non rispetta il limite di memoria.
+    if (options.binary_mode && options.max_memory) argument_error_handler(ERR_CONFLICTING_OPTION, "-b");
+
+    // Gestisce l'opzione per il caricamento su richiesta.
+    if (options.lazy_mode && command != FLATTEN) argument_error_handler(ERR_UNKNOWN_OPTION, "-l");
+
+    // Il caricamento su richiesta sostituisce il caricamento a più thread e il multiprocessing, e una tabella compilata non ha bisogno dell'indice, quindi non possono essere combinati.
+    if (options.lazy_mode && (options.threads || options.multiprocess_mode || ends_with(argv[optind], ".bin"))) argument_error_handler(ERR_CONFLICTING_OPTION, "-l");
+
+    // Gestisce l'opzione per la cache delle tabelle.
+    if (options.cache_mode && command != FLATTEN) argument_error_handler(ERR_UNKNOWN_OPTION, "-c");
+
+    // L'immagine della cache sostituisce il caricamento su richiesta e il multiprocessing, e una tabella compilata è già mappata direttamente, quindi non possono essere combinati.
+    if (options.cache_mode && (options.lazy_mode || options.multiprocess_mode || ends_with(argv[optind], ".bin"))) argument_error_handler(ERR_CONFLICTING_OPTION, "-c");
+
     // Gestisce l'opzione di aiuto.
     if (options.help_mode) help_handler(command, command_name);
 
@@ -181,14 +267,29 @@ int main(int argc, char *argv[]) {
             output_file = open_file(options.output_filename, ".csv", 'w');
 
             // Esegue il comando tabulate
-            tabulate(input_file, output_file, options.multiprocess_mode);
+            tabulate(input_file, output_file, options.multiprocess_mode, options.shared_memory_mode, options.jobs, options.threads, get_engine(options.engine), (size_t)options.max_memory * 1024 * 1024);
+
+            if (options.binary_mode) {
+                // La tabella scritta viene riletta e compilata nel file binario con lo stesso nome
+                if (fflush(output_file) == EOF) error_handler(ERR_OUTPUT_FILE);
+
+                char *table_filename = remove_suffix(strcmp(options.output_filename, "") == 0 ? "output" : options.output_filename, ".csv");
+                FILE *table_file = open_file(table_filename, ".csv", 'r');
+                FILE *binary_file = open_file(table_filename, ".bin", 'w');
+
+                flatten_compile(table_file, binary_file);
+
+                fclose(table_file);
+                if (fclose(binary_file) == EOF) error_handler(ERR_OUTPUT_FILE);
+            }
 
             printf("Tabulazione completata\n\n");
             break;
 
         case FLATTEN:
-            // Apre il file di input in lettura
-            input_file = open_file(argv[optind++], ".csv", 'r');
+            // Apre il file di input in lettura (una tabella compilata ha estensione '.bin')
+            input_file = open_file(argv[optind], ends_with(argv[optind], ".bin") ? ".bin" : ".csv", 'r');
+            optind++;
 
             // Legge il numero di parole da generare
             int words_to_generate;
@@ -197,8 +298,14 @@ int main(int argc, char *argv[]) {
             // Apre il file di output in scrittura
             output_file = open_file(options.output_filename, ".txt", 'w');
 
+            // Percorso della tabella, con l'estensione aggiunta all'apertura
+            char *table_filename = ends_with(argv[optind - 1], ".csv") ? argv[optind - 1] : append_suffix(argv[optind - 1], ".csv");
+
+            // L'indice della tabella ha lo stesso nome della tabella, con estensione '.idx'
+            char *index_filename = options.lazy_mode ? append_suffix(table_filename, ".idx") : NULL;
+
             // Esegue il comando flatten
-            flatten(input_file, words_to_generate, options.previous_word, output_file, options.multiprocess_mode);
+            flatten(input_file, words_to_generate, options.previous_word, output_file, options.multiprocess_mode, options.shared_memory_mode, options.threads, index_filename, options.cache_mode ? table_filename : NULL);
 
             printf("Generazione del testo completata\n\n");
             break;
@@ -241,6 +348,26 @@ CommandCode get_command(char *command) {
     return INVALID;
 }
 
+/**
+ * Restituisce il motore della modalità a più thread corrispondente a una stringa.
+ *
+ * @param engine La stringa da confrontare con i motori (NULL per il motore di default).
+ * @return Il motore corrispondente alla stringa, -1 se la stringa non corrisponde a un motore.
+ */
+int get_engine(char *engine) {
+    // Se non è stata specificata alcuna stringa, restituisce il motore di default
+    if (!engine) return ENGINE_MERGE;
+
+    // Scorre l'array dei motori
+    for (int i = 0; i < sizeof(engines) / sizeof(Engine); i++) {
+        // Se la stringa corrisponde a un motore, restituisce il codice del motore
+        if (strcmp(engine, engines[i].name) == 0) return engines[i].code;
+    }
+
+    // Restituisce il motore non valido
+    return -1;
+}
+
 /**
  * Verifica se una stringa termina con un suffisso specifico.
  *
@@ -283,6 +410,31 @@ char *append_suffix(char *string, char *suffix) {
     return result;
 }
 
+/**
+ * Rimuove un suffisso da una stringa, se la stringa termina con il suffisso.
+ *
+ * @param string La stringa da cui rimuovere il suffisso.
+ * @param suffix Il suffisso da rimuovere.
+ * @return La stringa senza il suffisso.
+ */
+char *remove_suffix(char *string, char *suffix) {
+    // Se la stringa non termina con il suffisso, la restituisce così com'è
+    if (!ends_with(string, suffix)) return string;
+
+    // Alloca la memoria per la nuova stringa
+    size_t length = strlen(string) - strlen(suffix);
+
+    char *result = malloc(length + 1);
+    if (!result) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Copia la stringa senza il suffisso
+    memcpy(result, string, length);
+    result[length] = '\0';
+
+    // Restituisce la nuova stringa
+    return result;
+}
+
 /**
  * Legge un numero da una stringa.
  *
@@ -299,8 +451,16 @@ int read_number(char *string) {
         if (!isdigit(string[i])) return -1;
     }
 
+    // Una stringa vuota non rappresenta un numero
+    if (string[0] == '\0') return -1;
+
+    // Legge il numero, restituendo -1 se non è rappresentabile come intero
+    errno = 0;
+    long number = strtol(string, NULL, 10);
+    if (errno == ERANGE || number > INT_MAX) return -1;
+
     // Restituisce il numero letto
-    return atoi(string);
+    return (int)number;
 }
 
 /**
@@ -359,7 +519,7 @@ FILE *open_file(char *filename, char *extension, char mode) {
  */
 Options parse_options(char *arguments[], int size, bool *previous_word) {
     // Opzioni di default
-    Options options = { "", L"", false, false };
+    Options options = { "", "", false, false, 0, 0, NULL, 0, false, false, false, false };
 
     // Opzione corrente
     int option;
@@ -373,18 +533,61 @@ Options parse_options(char *arguments[], int size, bool *previous_word) {
                 break;
 
             case 'w':
-                // Imposta la parola precedente
-                if (mbstowcs(options.previous_word, optarg, MAX_WORD_LENGTH) == -1) error_handler(ERR_INTERNAL_ERROR);
+                // Imposta la parola precedente (le parole della tabella sono in UTF-8, quindi viene copiata così com'è)
+                if (strlen(optarg) >= MAX_WORD_BYTES) argument_error_handler(ERR_INVALID_OPTION_ARGUMENT, "-w");
+                strcpy(options.previous_word, optarg);
 
                 // Indica che è stata specificata la parola precedente
                 *previous_word = true;
                 break;
 
+            case 'j':
+                // Imposta il numero di processi tra cui suddividere il testo
+                if ((options.jobs = read_number(optarg)) < 1 || options.jobs > MAX_JOBS) argument_error_handler(ERR_INVALID_OPTION_ARGUMENT, "-j");
+                break;
+
+            case 't':
+                // Imposta il numero di thread tra cui suddividere il testo
+                if ((options.threads = read_number(optarg)) < 1 || options.threads > MAX_THREADS) argument_error_handler(ERR_INVALID_OPTION_ARGUMENT, "-t");
+                break;
+
+            case 'e':
+                // Imposta il motore della modalità a più thread
+                if (get_engine(optarg) == -1) argument_error_handler(ERR_INVALID_OPTION_ARGUMENT, "-e");
+                options.engine = optarg;
+                break;
+
+            case 'M':
+                // Imposta la memoria massima per la tabella, in megabyte
+                if ((options.max_memory = read_number(optarg)) < 1) argument_error_handler(ERR_INVALID_OPTION_ARGUMENT, "-M");
+                break;
+
+            case 'b':
+                // Abilita la scrittura della tabella compilata
+                options.binary_mode = true;
+                break;
+
+            case 'l':
+                // Abilita il caricamento su richiesta delle righe della tabella
+                options.lazy_mode = true;
+                break;
+
+            case 'c':
+                // Abilita la cache delle tabelle in memoria condivisa
+                options.cache_mode = true;
+                break;
+
             case 'm':
                 // Abilita la modalità multiprocesso
                 options.multiprocess_mode = true;
                 break;
 
+            case 's':
+                // Abilita la modalità multiprocesso con il trasferimento del file di input in memoria condivisa
+                options.multiprocess_mode = true;
+                options.shared_memory_mode = true;
+                break;
+
             case 'h':
                 // Abilita la modalità di aiuto
                 options.help_mode = true;
@@ -422,13 +625,19 @@ void help_handler(CommandCode command, char *command_name) {
     switch (command) {
         case TABULATE:
             // Visualizza l'aiuto per il comando tabulate
-            printf("usage: %s tabulate [-h] [-o <output_file>] [m] <input_file>\n\n", program_name);
+            printf("usage: %s tabulate [-h] [-o <output_file>] [m] [s] [-j <jobs>] [-t <threads>] [-e <engine>] [-M <megabytes>] [-b] <input_file>\n\n", program_name);
             printf("Descrizione:\n");
             printf("  converte un file di testo in una tabella di frequenze.\n\n");
             printf("Opzioni:\n");
             printf("  -h     Visualizza questo messaggio di aiuto ed esce.\n");
             printf("  -o     Specifica il percorso per il file di output (default './output.csv').\n");
-            printf("  -m     Abilita il multiprocessing.\n\n");
+            printf("  -m     Abilita il multiprocessing.\n");
+            printf("  -s     Abilita il multiprocessing con il testo trasferito in memoria condivisa.\n");
+            printf("  -j     Suddivide il testo tra il numero di processi specificato, al massimo 256 (non combinabile con '-m' e '-s').\n");
+            printf("  -t     Suddivide il testo tra il numero di thread specificato, al massimo 256 (non combinabile con '-j', '-m' e '-s').\n");
+            printf("  -e     Specifica il motore della modalità a più thread: 'merge' (default, unisce le tabelle dei thread), 'shared' (tabella condivisa), 'shuffle' (coppie inviate ai thread proprietari) o 'sort' (coppie ordinate e contate); richiede '-t' con almeno 2 thread.\n");
+            printf("  -M     Limita la memoria della tabella ai megabyte specificati, scrivendola su disco quando li supera (non combinabile con '-j', '-t', '-e', '-m', '-s' e '-b').\n");
+            printf("  -b     Scrive anche la tabella compilata in un file '.bin' con lo stesso nome, che flatten mappa senza leggerla (non combinabile con '-M').\n\n");
             printf("Argomenti:\n");
             printf("  input_file    File di input.\n\n");
 
@@ -436,29 +645,34 @@ void help_handler(CommandCode command, char *command_name) {
 
         case FLATTEN:
             // Visualizza l'aiuto per il comando flatten
-            printf("usage: %s flatten [-h] [-w <previous_word] [-o <output_file>] [m] <input_file> <words_to_generate>\n\n", program_name);
+            printf("usage: %s flatten [-h] [-w <previous_word] [-o <output_file>] [m] [s] [-t <threads>] [-l] [-c] <input_file> <words_to_generate>\n\n", program_name);
             printf("Descrizione:\n");
             printf("  genera un testo casuale a partire da una tabella di frequenze.\n\n");
             printf("Opzioni:\n");
             printf("  -h                   Visualizza questo messaggio di aiuto ed esce.\n");
             printf("  -w                   Specifica la parola precedente (default '.', '?' o '!').\n");
             printf("  -o                   Specifica il percorso per il file di output (default './output.txt').\n");
-            printf("  -m                   Abilita il multiprocessing.\n\n");
+            printf("  -m                   Abilita il multiprocessing.\n");
+            printf("  -s                   Abilita il multiprocessing con la tabella trasferita in memoria condivisa.\n");
+            printf("  -t                   Suddivide il caricamento della tabella tra il numero di thread specificato, al massimo 256 (non combinabile con '-m' e '-s').\n");
+            printf("  -l                   Carica solo le righe della tabella visitate, tramite un indice salvato in un file '.idx' accanto alla tabella (non combinabile con '-m', '-s', '-t', '-c' e una tabella compilata).\n");
+            printf("  -c                   Condivide la tabella caricata con le esecuzioni successive tramite un'immagine in '/dev/shm/wftable-<uid>' (non combinabile con '-l', '-m', '-s' e una tabella compilata).\n\n");
             printf("Argomenti:\n");
-            printf("  input_file           File di input.\n");
+            printf("  input_file           File di input (tabella CSV o tabella compilata '.bin', usata senza multiprocessing).\n");
             printf("  words_to_generate    Numero di parole da generare.\n\n");
 
             break;
 
         case EMPTY:
             // Se non è stato specificato alcun comando, visualizza l'aiuto generale
-            printf("usage: %s [-h] [-o <output_file>] [m] <command>\n\n", program_name); 
+            printf("usage: %s [-h] [-o <output_file>] [m] [s] <command>\n\n", program_name); 
             printf("Descrizione:\n");
             printf("  gestisce la realizzazione dei compiti tabulate e flatten fornendo un'implementazione a singolo processo e multiprocesso.\n\n"); // Scrivere descrizione
             printf("Opzioni:\n");
             printf("  -h          Visualizza un messaggio di aiuto relativo a un comando.\n");
             printf("  -o          Specifica il percorso per il file di output (default './output').\n");
-            printf("  -m          Abilita il multiprocessing.\n\n");
+            printf("  -m          Abilita il multiprocessing.\n");
+            printf("  -s          Abilita il multiprocessing con il file di input trasferito in memoria condivisa.\n\n");
             printf("Comandi:\n");
             printf("  tabulate    Converte un file di testo in una tabella di frequenze.\n");
             printf("  flatten     Genera un testo casuale a partire da una tabella di frequenze.\n\n");
@@ -0,0 +1,161 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "pipe_io.h"
+#include "error_handler.h"
+#include "utf8.h"
+
+/**
+ * Crea una pipe e ne aumenta la capacità.
+ *
+ * @param pipe_fd I file descriptor della pipe.
+ */
+void pipe_open(int pipe_fd[2]) {
+    if (pipe(pipe_fd) == -1) error_handler(ERR_PARALLELIZATION);
+
+    // Una capacità maggiore riduce i cambi di contesto tra i processi (se non viene concessa si usa quella predefinita)
+    fcntl(pipe_fd[1], F_SETPIPE_SZ, PIPE_CAPACITY);
+}
+
+/**
+ * Scrive un buffer su un file descriptor, gestendo le scritture parziali.
+ *
+ * @param fd Il file descriptor.
+ * @param buffer Il buffer da scrivere.
+ * @param size La dimensione del buffer in byte.
+ */
+void pipe_write(int fd, const void *buffer, size_t size) {
+    // Totale dei byte scritti
+    size_t total = 0;
+
+    // Continua a scrivere finché non ha scritto tutto il buffer
+    while (total < size) {
+        ssize_t written_size = write(fd, (const char *)buffer + total, size - total);
+        if (written_size == -1) {
+            if (errno == EINTR) continue;
+            error_handler(ERR_PARALLELIZATION);
+        }
+
+        // Viene incrementato il totale dei byte scritti
+        total += written_size;
+    }
+}
+
+/**
+ * Legge un buffer da un file descriptor, gestendo le letture parziali.
+ *
+ * @param fd Il file descriptor.
+ * @param buffer Il buffer in cui leggere.
+ * @param size La dimensione del buffer in byte.
+ * @return true se il buffer è stato letto completamente, false altrimenti.
+ */
+bool pipe_read(int fd, void *buffer, size_t size) {
+    // Totale dei byte letti
+    size_t total = 0;
+
+    // Continua a leggere finché non ha letto tutto il buffer
+    while (total < size) {
+        ssize_t read_size = read(fd, (char *)buffer + total, size - total);
+        if (read_size == -1 && errno == EINTR) continue;
+        if (read_size <= 0) return false;
+
+        // Viene incrementato il totale dei byte letti
+        total += read_size;
+    }
+
+    return true;
+}
+
+/**
+ * Scrive su una pipe il contenuto di un file suddiviso in frame.
+ *
+ * @param fd Il file descriptor del lato di scrittura della pipe.
+ * @param reader Il lettore del file.
+ */
+void pipe_send(int fd, Reader *reader) {
+    char *data;
+    size_t size;
+
+    // I blocchi del lettore non dividono i caratteri, ma possono essere più grandi di un frame
+    while ((size = reader_read(reader, &data)) > 0) {
+        size_t offset = 0;
+
+        while (offset < size) {
+            size_t frame_size = size - offset;
+
+            // Un frame che non termina il blocco viene accorciato all'ultimo carattere completo
+            if (frame_size > PIPE_FRAME_SIZE) {
+                frame_size = PIPE_FRAME_SIZE;
+                frame_size -= utf8_incomplete_suffix((unsigned char *)data + offset, frame_size);
+            }
+
+            // Scrittura della dimensione e del contenuto del frame
+            pipe_write(fd, &frame_size, sizeof(frame_size));
+            pipe_write(fd, data + offset, frame_size);
+
+            offset += frame_size;
+        }
+    }
+
+    // Frame vuoto di fine file
+    size = 0;
+    pipe_write(fd, &size, sizeof(size));
+}
+
+/**
+ * Legge un frame da una pipe.
+ *
+ * @param fd Il file descriptor del lato di lettura della pipe.
+ * @param buffer Il buffer in cui leggere il contenuto (di almeno PIPE_FRAME_SIZE byte).
+ * @return La dimensione del contenuto, 0 alla fine del file.
+ */
+size_t pipe_receive(int fd, char *buffer) {
+    size_t size;
+
+    // Se la pipe viene chiusa prima del frame di fine file, il processo di scrittura è terminato con un errore
+    if (!pipe_read(fd, &size, sizeof(size)) || size > PIPE_FRAME_SIZE) error_handler(ERR_PARALLELIZATION);
+    if (size > 0 && !pipe_read(fd, buffer, size)) error_handler(ERR_PARALLELIZATION);
+
+    return size;
+}
+
+/**
+ * Attende i processi di una pipeline.
+ *
+ * @param pids Gli identificatori dei processi.
+ * @param count Il numero di processi.
+ */
+void pipe_wait_processes(pid_t pids[], int count) {
+    // Status dei processi
+    int status;
+
+    // I processi vengono attesi nell'ordine in cui terminano
+    for (int remaining = count; remaining > 0; remaining--) {
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid == -1) error_handler(ERR_PARALLELIZATION);
+
+        // Il processo terminato non deve più essere segnalato
+        for (int i = 0; i < count; i++) {
+            if (pids[i] == pid) pids[i] = 0;
+        }
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            // Terminazione dei processi rimanenti
+            for (int i = 0; i < count; i++) {
+                if (pids[i] > 0) kill(pids[i], SIGKILL);
+            }
+
+            // Attesa dei processi rimanenti
+            while (--remaining > 0) waitpid(-1, &status, 0);
+
+            exit(EXIT_FAILURE);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "reader.h"
+#include "error_handler.h"
+#include "utf8.h"
+#include "pipe_io.h"
+#include "ring.h"
+
+/**
+ * Dimensione dei blocchi letti dai file non regolari.
+ */
+#define READ_BUFFER_SIZE 65536
+
+/**
+ * Crea un lettore per un file.
+ *
+ * @param file Il file da leggere.
+ * @return Il lettore creato.
+ */
+Reader *reader_open(FILE *file) {
+    // Informazioni sul file
+    struct stat file_stat;
+    if (fstat(fileno(file), &file_stat) == -1) error_handler(ERR_INTERNAL_ERROR);
+
+    // Se il file è regolare viene mappato per intero (i file vuoti o di dimensione sconosciuta vengono letti a blocchi)
+    if (S_ISREG(file_stat.st_mode) && file_stat.st_size > 0) return reader_open_range(file, 0, file_stat.st_size);
+
+    // Allocazione del lettore
+    Reader *reader = (Reader *)malloc(sizeof(Reader));
+    if (!reader) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Allocazione del buffer
+    reader->buffer = (char *)malloc(READ_BUFFER_SIZE);
+    if (!reader->buffer) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Inizializzazione del lettore
+    reader->fd = fileno(file);
+    reader->mapped = false;
+    reader->framed = false;
+    reader->ring = NULL;
+    reader->mapping = NULL;
+    reader->mapping_size = 0;
+    reader->data = NULL;
+    reader->size = 0;
+    reader->pending = 0;
+    reader->finished = false;
+
+    // Restituzione del lettore
+    return reader;
+}
+
+/**
+ * Crea un lettore per una porzione di un file regolare.
+ *
+ * @param file Il file da leggere.
+ * @param start L'offset di inizio della porzione.
+ * @param end L'offset di fine della porzione.
+ * @return Il lettore creato.
+ */
+Reader *reader_open_range(FILE *file, off_t start, off_t end) {
+    // Allocazione del lettore
+    Reader *reader = (Reader *)malloc(sizeof(Reader));
+    if (!reader) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Inizializzazione del lettore
+    reader->fd = fileno(file);
+    reader->mapped = true;
+    reader->framed = false;
+    reader->ring = NULL;
+    reader->mapping = NULL;
+    reader->mapping_size = 0;
+    reader->data = NULL;
+    reader->size = end > start ? end - start : 0;
+    reader->buffer = NULL;
+    reader->pending = 0;
+    reader->finished = false;
+
+    if (reader->size > 0) {
+        // L'offset della mappatura deve essere allineato alla dimensione della pagina
+        off_t page_size = sysconf(_SC_PAGESIZE);
+        off_t aligned_start = start - start % page_size;
+
+        // Mappatura della porzione del file
+        reader->mapping_size = end - aligned_start;
+        reader->mapping = mmap(NULL, reader->mapping_size, PROT_READ, MAP_PRIVATE, reader->fd, aligned_start);
+        if (reader->mapping == MAP_FAILED) error_handler(ERR_MEMORY_ALLOCATION);
+
+        // La porzione viene letta in modo sequenziale
+        madvise(reader->mapping, reader->mapping_size, MADV_SEQUENTIAL);
+
+        reader->data = reader->mapping + (start - aligned_start);
+    }
+
+    // Restituzione del lettore
+    return reader;
+}
+
+/**
+ * Crea un lettore per dati già in memoria (che non vengono copiati né deallocati).
+ *
+ * @param data I dati da leggere.
+ * @param size La dimensione dei dati.
+ * @return Il lettore creato.
+ */
+Reader *reader_open_memory(char *data, size_t size) {
+    // Allocazione del lettore
+    Reader *reader = (Reader *)malloc(sizeof(Reader));
+    if (!reader) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // I dati vengono restituiti in un unico blocco, come quelli di un file mappato
+    reader->fd = -1;
+    reader->mapped = true;
+    reader->framed = false;
+    reader->ring = NULL;
+    reader->mapping = NULL;
+    reader->mapping_size = 0;
+    reader->data = data;
+    reader->size = size;
+    reader->buffer = NULL;
+    reader->pending = 0;
+    reader->finished = false;
+
+    // Restituzione del lettore
+    return reader;
+}
+
+/**
+ * Crea un lettore per i frame scritti su una pipe.
+ *
+ * @param fd Il file descriptor del lato di lettura della pipe.
+ * @return Il lettore creato.
+ */
+Reader *reader_open_pipe(int fd) {
+    // Allocazione del lettore
+    Reader *reader = (Reader *)malloc(sizeof(Reader));
+    if (!reader) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Allocazione del buffer di un frame
+    reader->buffer = (char *)malloc(PIPE_FRAME_SIZE);
+    if (!reader->buffer) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Inizializzazione del lettore
+    reader->fd = fd;
+    reader->mapped = false;
+    reader->framed = true;
+    reader->ring = NULL;
+    reader->mapping = NULL;
+    reader->mapping_size = 0;
+    reader->data = NULL;
+    reader->size = 0;
+    reader->pending = 0;
+    reader->finished = false;
+
+    // Restituzione del lettore
+    return reader;
+}
+
+/**
+ * Crea un lettore per i dati pubblicati su un ring buffer.
+ *
+ * @param ring Il ring buffer.
+ * @return Il lettore creato.
+ */
+Reader *reader_open_ring(RingBuffer *ring) {
+    // Allocazione del lettore
+    Reader *reader = (Reader *)malloc(sizeof(Reader));
+    if (!reader) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Inizializzazione del lettore (i blocchi vengono letti direttamente dal ring buffer)
+    reader->fd = -1;
+    reader->mapped = false;
+    reader->framed = false;
+    reader->ring = ring;
+    reader->mapping = NULL;
+    reader->mapping_size = 0;
+    reader->data = NULL;
+    reader->size = 0;
+    reader->buffer = NULL;
+    reader->pending = 0;
+    reader->finished = false;
+
+    // Restituzione del lettore
+    return reader;
+}
+
+/**
+ * Restituisce il blocco successivo del file.
+ *
+ * @param reader Il lettore.
+ * @param data Il puntatore al blocco letto.
+ * @return La dimensione del blocco, 0 se il file è terminato.
+ */
+size_t reader_read(Reader *reader, char **data) {
+    // Se il file è terminato non ci sono altri blocchi
+    if (reader->finished) return 0;
+
+    // Il file mappato viene restituito in un unico blocco
+    if (reader->mapped) {
+        reader->finished = true;
+
+        *data = reader->data;
+        return reader->size;
+    }
+
+    // Il blocco precedente viene rilasciato prima di attendere i dati successivi del ring buffer
+    if (reader->ring) {
+        ring_release(reader->ring, reader->size);
+
+        reader->size = ring_acquire(reader->ring, data);
+        if (reader->size == 0) reader->finished = true;
+
+        return reader->size;
+    }
+
+    // Ogni frame della pipe è un blocco (il frame vuoto indica la fine del file)
+    if (reader->framed) {
+        reader->size = pipe_receive(reader->fd, reader->buffer);
+        if (reader->size == 0) reader->finished = true;
+
+        *data = reader->buffer;
+        return reader->size;
+    }
+
+    // Se il blocco letto contiene solo un carattere incompleto si continua a leggere
+    do {
+        // I byte del carattere incompleto del blocco precedente vengono spostati all'inizio del buffer
+        memmove(reader->buffer, reader->buffer + reader->size, reader->pending);
+
+        // Lettura di un blocco nel buffer
+        ssize_t read_size;
+        do {
+            read_size = read(reader->fd, reader->buffer + reader->pending, READ_BUFFER_SIZE - reader->pending);
+        } while (read_size == -1 && errno == EINTR);
+
+        if (read_size == -1) error_handler(ERR_INTERNAL_ERROR);
+
+        size_t available = reader->pending + read_size;
+
+        if (read_size == 0) {
+            // Alla fine del file gli eventuali byte rimasti vengono restituiti così come sono
+            reader->finished = true;
+            reader->size = available;
+        } else {
+            // Il carattere incompleto alla fine del blocco viene conservato per il blocco successivo
+            reader->size = available - utf8_incomplete_suffix((unsigned char *)reader->buffer, available);
+        }
+
+        reader->pending = available - reader->size;
+    } while (reader->size == 0 && !reader->finished);
+
+    *data = reader->buffer;
+    return reader->size;
+}
+
+/**
+ * Distrugge un lettore.
+ *
+ * @param reader Il lettore da distruggere.
+ */
+void reader_close(Reader *reader) {
+    // Rimozione della mappatura
+    if (reader->mapping) munmap(reader->mapping, reader->mapping_size);
+
+    // Deallocazione del buffer
+    free(reader->buffer);
+
+    // Deallocazione del lettore
+    free(reader);
+}
\ No newline at end of file
@@ -0,0 +1,224 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "region.h"
+#include "error_handler.h"
+
+/**
+ * Spazio di indirizzamento riservato per una regione (viene ridotto se il sistema non lo concede).
+ */
+#define REGION_RESERVED_SIZE ((size_t)1 << 36)
+
+/**
+ * Spazio di indirizzamento minimo per una regione.
+ */
+#define REGION_MINIMUM_RESERVED_SIZE ((size_t)1 << 26)
+
+/**
+ * Capacità iniziale di una regione (pagine accessibili della regione privata, dimensione del file di quella condivisa).
+ */
+#define REGION_INITIAL_CAPACITY ((size_t)1 << 20)
+
+/**
+ * Allineamento degli oggetti di una regione.
+ */
+#define REGION_ALIGNMENT 8
+
+/**
+ * Crea il file in memoria che contiene una regione condivisa (da creare prima della fork dei processi che la usano).
+ *
+ * @return Il file descriptor del file.
+ */
+int region_create_file() {
+    int fd = memfd_create("program-region", MFD_CLOEXEC);
+    if (fd == -1) error_handler(ERR_PARALLELIZATION);
+
+    return fd;
+}
+
+/**
+ * Crea una regione.
+ *
+ * @param fd Il file descriptor del file della regione condivisa, -1 per una regione privata.
+ * @return La regione creata.
+ */
+Region *region_create(int fd) {
+    // Allocazione della regione
+    Region *region = (Region *)malloc(sizeof(Region));
+    if (!region) error_handler(ERR_MEMORY_ALLOCATION);
+
+    region->fd = fd;
+
+    // Le pagine vengono allocate solo quando vengono usate, lo spazio riservato viene ridotto finché il sistema non lo concede
+    region->reserved = REGION_RESERVED_SIZE;
+
+    do {
+        if (fd == -1) {
+            // Lo spazio della regione privata non è accessibile, quindi non viene conteggiato come memoria impegnata nemmeno se il sistema non consente l'overcommit
+            region->base = mmap(NULL, region->reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        } else {
+            region->base = mmap(NULL, region->reserved, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+        }
+    } while (region->base == MAP_FAILED && (region->reserved /= 2) >= REGION_MINIMUM_RESERVED_SIZE);
+
+    if (region->base == MAP_FAILED) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Le pagine grandi riducono i page fault e i TLB miss durante la crescita e lo scorrimento della regione (è solo un suggerimento)
+    madvise(region->base, region->reserved, MADV_HUGEPAGE);
+
+    // La regione privata può crescere fino alle pagine rese accessibili, quella condivisa fino alla dimensione del file
+    region->capacity = REGION_INITIAL_CAPACITY < region->reserved ? REGION_INITIAL_CAPACITY : region->reserved;
+
+    if (fd == -1) {
+        if (mprotect(region->base, region->capacity, PROT_READ | PROT_WRITE) == -1) error_handler(ERR_MEMORY_ALLOCATION);
+    } else {
+        if (ftruncate(fd, region->capacity) == -1) error_handler(ERR_MEMORY_ALLOCATION);
+    }
+
+    // Inizializzazione dell'intestazione
+    RegionHeader *header = region_header(region);
+    header->size = sizeof(RegionHeader);
+    header->root = 0;
+
+    // Restituzione della regione
+    return region;
+}
+
+/**
+ * Mappa in sola lettura una regione condivisa creata da un altro processo.
+ *
+ * @param fd Il file descriptor del file della regione.
+ * @return La regione mappata.
+ */
+Region *region_attach(int fd) {
+    // Allocazione della regione
+    Region *region = (Region *)malloc(sizeof(Region));
+    if (!region) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Dimensione del file della regione
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1 || file_stat.st_size < sizeof(RegionHeader)) error_handler(ERR_PARALLELIZATION);
+
+    // Mappatura del file (l'indirizzo può essere diverso da quello del processo che ha creato la regione)
+    region->fd = fd;
+    region->capacity = file_stat.st_size;
+    region->reserved = file_stat.st_size;
+    region->base = mmap(NULL, region->reserved, PROT_READ, MAP_SHARED, fd, 0);
+    if (region->base == MAP_FAILED) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Restituzione della regione
+    return region;
+}
+
+/**
+ * Mappa in sola lettura una regione salvata in un file, a partire da un offset.
+ *
+ * La regione viene mappata così com'è, senza leggerla: le pagine vengono caricate solo quando
+ * vengono usate e restano condivise con la cache dei file.
+ *
+ * @param fd Il file descriptor del file.
+ * @param offset L'offset della regione nel file (multiplo della dimensione di una pagina).
+ * @return La regione mappata, NULL se il file non contiene una regione.
+ */
+Region *region_map(int fd, size_t offset) {
+    // Dimensione del file, che deve contenere almeno l'intestazione della regione (senza superare i limiti di size_t nel calcolo)
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1 || file_stat.st_size < sizeof(RegionHeader) || offset > file_stat.st_size - sizeof(RegionHeader)) return NULL;
+
+    // Allocazione della regione
+    Region *region = (Region *)malloc(sizeof(Region));
+    if (!region) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Mappatura del file (le scritture non sono consentite, quindi la regione non cresce)
+    region->fd = -1;
+    region->capacity = file_stat.st_size - offset;
+    region->reserved = file_stat.st_size - offset;
+    region->base = mmap(NULL, region->reserved, PROT_READ, MAP_SHARED, fd, offset);
+    if (region->base == MAP_FAILED) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // La regione deve essere contenuta nel file e contenere la sua intestazione
+    if (region_header(region)->size > region->capacity || region_header(region)->size < sizeof(RegionHeader)) {
+        region_destroy(region);
+        return NULL;
+    }
+
+    // Restituzione della regione
+    return region;
+}
+
+/**
+ * Distrugge una regione, deallocando tutti i suoi oggetti.
+ *
+ * @param region La regione da distruggere.
+ */
+void region_destroy(Region *region) {
+    // Rimozione della mappatura
+    munmap(region->base, region->reserved);
+
+    // Deallocazione della regione
+    free(region);
+}
+
+/**
+ * Alloca un oggetto in una regione.
+ *
+ * @param region La regione.
+ * @param size La dimensione dell'oggetto.
+ * @return L'offset dell'oggetto.
+ */
+size_t region_allocate(Region *region, size_t size) {
+    RegionHeader *header = region_header(region);
+
+    // Gli oggetti vengono allocati in sequenza
+    size_t offset = (header->size + REGION_ALIGNMENT - 1) & ~(size_t)(REGION_ALIGNMENT - 1);
+    size_t end = offset + size;
+
+    if (end > region->capacity) {
+        // La regione non può superare lo spazio riservato
+        if (end > region->reserved) error_handler(ERR_MEMORY_ALLOCATION);
+
+        // La capacità viene raddoppiata fino a contenere l'oggetto (gli oggetti non vengono spostati)
+        size_t capacity = region->capacity;
+        while (capacity < end) capacity *= 2;
+        if (capacity > region->reserved) capacity = region->reserved;
+
+        // Le pagine della regione privata vengono rese accessibili, il file di quella condivisa viene ingrandito
+        if (region->fd == -1) {
+            if (mprotect(region->base, capacity, PROT_READ | PROT_WRITE) == -1) error_handler(ERR_MEMORY_ALLOCATION);
+        } else {
+            if (ftruncate(region->fd, capacity) == -1) error_handler(ERR_MEMORY_ALLOCATION);
+        }
+
+        region->capacity = capacity;
+    }
+
+    header->size = end;
+
+    return offset;
+}
+
+/**
+ * Restituisce l'indirizzo di un oggetto di una regione.
+ *
+ * @param region La regione.
+ * @param offset L'offset dell'oggetto.
+ * @return L'indirizzo dell'oggetto, NULL se l'offset è 0.
+ */
+void *region_pointer(Region *region, size_t offset) {
+    return offset ? region->base + offset : NULL;
+}
+
+/**
+ * Restituisce l'intestazione di una regione.
+ *
+ * @param region La regione.
+ * @return L'intestazione della regione.
+ */
+RegionHeader *region_header(Region *region) {
+    return (RegionHeader *)region->base;
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "ring.h"
+#include "error_handler.h"
+#include "utf8.h"
+
+/**
+ * Crea un ring buffer in memoria condivisa (da creare prima della fork dei processi che lo usano).
+ *
+ * @param capacity La capacità del buffer.
+ * @return Il ring buffer creato.
+ */
+RingBuffer *ring_create(size_t capacity) {
+    // Allocazione del ring buffer
+    RingBuffer *ring = (RingBuffer *)malloc(sizeof(RingBuffer));
+    if (!ring) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Il nome viene rimosso subito dopo la creazione, la memoria resta accessibile tramite le mappature
+    char name[64];
+    snprintf(name, sizeof(name), "/program-ring-%d", getpid());
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) error_handler(ERR_PARALLELIZATION);
+    shm_unlink(name);
+
+    // La struttura di controllo occupa le prime pagine, seguita dall'area dei dati
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    ring->control_size = (sizeof(RingControl) + page_size - 1) / page_size * page_size;
+    ring->capacity = capacity;
+
+    if (ftruncate(fd, ring->control_size + capacity) == -1) error_handler(ERR_PARALLELIZATION);
+
+    // Mappatura della struttura di controllo
+    ring->control = mmap(NULL, ring->control_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ring->control == MAP_FAILED) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Riserva dello spazio di indirizzamento per le due mappature dell'area dei dati
+    ring->data = mmap(NULL, 2 * capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring->data == MAP_FAILED) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // L'area dei dati viene mappata due volte consecutivamente
+    for (int i = 0; i < 2; i++) {
+        if (mmap(ring->data + i * capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, ring->control_size) == MAP_FAILED) error_handler(ERR_MEMORY_ALLOCATION);
+    }
+
+    close(fd);
+
+    // Inizializzazione della struttura di controllo (la memoria creata con ftruncate è azzerata)
+    atomic_init(&ring->control->head, 0);
+    atomic_init(&ring->control->tail, 0);
+    atomic_init(&ring->control->closed, false);
+    atomic_init(&ring->control->data_signal, 0);
+    atomic_init(&ring->control->space_signal, 0);
+    atomic_init(&ring->control->consumer_waiting, false);
+    atomic_init(&ring->control->producer_waiting, false);
+
+    // Restituzione del ring buffer
+    return ring;
+}
+
+/**
+ * Distrugge un ring buffer.
+ *
+ * @param ring Il ring buffer da distruggere.
+ */
+void ring_destroy(RingBuffer *ring) {
+    // Rimozione delle mappature
+    munmap(ring->data, 2 * ring->capacity);
+    munmap(ring->control, ring->control_size);
+
+    // Deallocazione del ring buffer
+    free(ring);
+}
+
+/**
+ * Scrive sul ring buffer il contenuto di un file e lo chiude.
+ *
+ * @param ring Il ring buffer.
+ * @param reader Il lettore del file.
+ */
+void ring_send(RingBuffer *ring, Reader *reader) {
+    RingControl *control = ring->control;
+
+    // Solo il produttore modifica head
+    size_t head = atomic_load(&control->head);
+
+    char *data;
+    size_t size;
+
+    // I blocchi del lettore non dividono i caratteri
+    while ((size = reader_read(reader, &data)) > 0) {
+        size_t offset = 0;
+
+        while (offset < size) {
+            size_t remaining = size - offset;
+            if (remaining > RING_CHUNK_SIZE) remaining = RING_CHUNK_SIZE;
+
+            // Attesa dello spazio necessario per la porzione o almeno per un carattere
+            size_t space;
+            while ((space = ring->capacity - (head - atomic_load(&control->tail))) < remaining && space < 4) {
+                atomic_store(&control->producer_waiting, true);
+
+                // Il segnale viene letto prima di ricontrollare lo spazio, quindi un rilascio successivo non viene perso
+                uint32_t signal = atomic_load(&control->space_signal);
+                space = ring->capacity - (head - atomic_load(&control->tail));
+                if (space < remaining && space < 4) futex_wait(&control->space_signal, signal);
+
+                atomic_store(&control->producer_waiting, false);
+            }
+
+            // Una porzione che non termina il blocco viene accorciata all'ultimo carattere completo
+            size_t chunk_size = remaining;
+            if (chunk_size > space) chunk_size = space;
+            if (offset + chunk_size < size) chunk_size -= utf8_incomplete_suffix((unsigned char *)data + offset, chunk_size);
+
+            // Copia nel buffer (la doppia mappatura rende contigua la porzione)
+            memcpy(ring->data + head % ring->capacity, data + offset, chunk_size);
+
+            // Pubblicazione dei dati
+            head += chunk_size;
+            atomic_store(&control->head, head);
+            atomic_fetch_add(&control->data_signal, 1);
+            if (atomic_load(&control->consumer_waiting)) futex_wake(&control->data_signal);
+
+            offset += chunk_size;
+        }
+    }
+
+    // Chiusura del buffer
+    atomic_store(&control->closed, true);
+    atomic_fetch_add(&control->data_signal, 1);
+    if (atomic_load(&control->consumer_waiting)) futex_wake(&control->data_signal);
+}
+
+/**
+ * Attende e restituisce i dati pubblicati e non ancora letti, senza copiarli.
+ *
+ * @param ring Il ring buffer.
+ * @param data Il puntatore ai dati.
+ * @return La dimensione dei dati, 0 se il buffer è stato chiuso ed è vuoto.
+ */
+size_t ring_acquire(RingBuffer *ring, char **data) {
+    RingControl *control = ring->control;
+
+    // Solo il consumatore modifica tail
+    size_t tail = atomic_load(&control->tail);
+    size_t head;
+
+    // Attesa di nuovi dati o della chiusura (closed viene letto prima di head, quindi i dati finali non vengono persi)
+    bool closed = atomic_load(&control->closed);
+    while ((head = atomic_load(&control->head)) == tail && !closed) {
+        atomic_store(&control->consumer_waiting, true);
+
+        // Il segnale viene letto prima di ricontrollare head, quindi una pubblicazione successiva non viene persa
+        uint32_t signal = atomic_load(&control->data_signal);
+        closed = atomic_load(&control->closed);
+        if (atomic_load(&control->head) == tail && !closed) futex_wait(&control->data_signal, signal);
+
+        atomic_store(&control->consumer_waiting, false);
+        closed = atomic_load(&control->closed);
+    }
+
+    *data = ring->data + tail % ring->capacity;
+    return head - tail;
+}
+
+/**
+ * Libera i dati letti, rendendo lo spazio disponibile al produttore.
+ *
+ * @param ring Il ring buffer.
+ * @param size La dimensione dei dati letti.
+ */
+void ring_release(RingBuffer *ring, size_t size) {
+    RingControl *control = ring->control;
+
+    if (size == 0) return;
+
+    // Avanzamento di tail e risveglio del produttore
+    atomic_fetch_add(&control->tail, size);
+    atomic_fetch_add(&control->space_signal, 1);
+    if (atomic_load(&control->producer_waiting)) futex_wake(&control->space_signal);
+}
+
+/**
+ * Attende che il valore di una parola condivisa cambi.
+ *
+ * @param address L'indirizzo della parola.
+ * @param value Il valore atteso.
+ */
+void futex_wait(_Atomic uint32_t *address, uint32_t value) {
+    // La futex non è privata perché la parola è condivisa tra processi
+    syscall(SYS_futex, address, FUTEX_WAIT, value, NULL, NULL, 0);
+}
+
+/**
+ * Risveglia i processi o i thread in attesa su una parola condivisa.
+ *
+ * @param address L'indirizzo della parola.
+ */
+void futex_wake(_Atomic uint32_t *address) {
+    syscall(SYS_futex, address, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
\ No newline at end of file
@@ -0,0 +1,389 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spill.h"
+#include "error_handler.h"
+
+/**
+ * Unisce tutti i run di un elenco in un unico run.
+ *
+ * @param runs L'elenco.
+ */
+void compact_spill_runs(SpillRuns *runs);
+
+/**
+ * Legge il record successivo di un run.
+ *
+ * @param run Il run.
+ * @param lines Indica se il run contiene righe invece di coppie di parole.
+ * @return true se il record è stato letto, false se il run è terminato.
+ */
+bool read_spill_record(SpillRun *run, bool lines);
+
+/**
+ * Legge una parola da un run.
+ *
+ * @param file Il run.
+ * @param word La parola letta (MAX_WORD_BYTES byte).
+ * @return true se la parola è stata letta, false se il run è terminato.
+ */
+bool read_spill_word(FILE *file, char *word);
+
+/**
+ * Confronta i record correnti di due run di un'unione.
+ *
+ * @param merge L'unione.
+ * @param first L'indice del primo run.
+ * @param second L'indice del secondo run.
+ * @return true se il record del primo run precede quello del secondo, false altrimenti.
+ */
+bool spill_record_precedes(SpillMerge *merge, int first, int second);
+
+/**
+ * Sposta verso il basso un run nel min-heap di un'unione, fino a ripristinare l'ordinamento.
+ *
+ * @param merge L'unione.
+ * @param index La posizione del run nel min-heap.
+ */
+void sift_spill_run(SpillMerge *merge, int index);
+
+/**
+ * Avanza il run restituito per ultimo da un'unione e restituisce il run con il record minore.
+ *
+ * @param merge L'unione.
+ * @return L'indice del run, -1 se i run sono terminati.
+ */
+int next_spill_run(SpillMerge *merge);
+
+/**
+ * Crea un file temporaneo per un run (eliminato alla chiusura).
+ *
+ * @return Il file creato.
+ */
+FILE *spill_create() {
+    FILE *file = tmpfile();
+    if (!file) error_handler(ERR_TEMPORARY_FILE);
+
+    return file;
+}
+
+/**
+ * Scrive una coppia di parole su un run (le coppie devono essere ordinate per parola e parola successiva).
+ *
+ * Le parole vengono scritte precedute dalla loro lunghezza (minore di MAX_WORD_BYTES, quindi di un byte).
+ *
+ * @param file Il run.
+ * @param pair La coppia.
+ */
+void spill_write_pair(FILE *file, SpillPair *pair) {
+    unsigned char word_length = strlen(pair->word);
+    unsigned char next_word_length = strlen(pair->next_word);
+
+    // Scrittura delle parole e dei contatori
+    fputc(word_length, file);
+    fwrite(pair->word, 1, word_length, file);
+    fputc(next_word_length, file);
+    fwrite(pair->next_word, 1, next_word_length, file);
+    fwrite(&pair->count, sizeof(size_t), 1, file);
+    fwrite(&pair->order, sizeof(size_t), 1, file);
+
+    if (fwrite(&pair->entry_order, sizeof(size_t), 1, file) != 1) error_handler(ERR_TEMPORARY_FILE);
+}
+
+/**
+ * Scrive una riga su un run (le righe devono essere ordinate per ordine).
+ *
+ * @param file Il run.
+ * @param order L'ordine della riga.
+ * @param text Il testo della riga.
+ * @param length La lunghezza della riga.
+ */
+void spill_write_line(FILE *file, size_t order, char *text, size_t length) {
+    fwrite(&order, sizeof(size_t), 1, file);
+    fwrite(&length, sizeof(size_t), 1, file);
+
+    if (fwrite(text, 1, length, file) != length) error_handler(ERR_TEMPORARY_FILE);
+}
+
+/**
+ * Inizializza un elenco di run vuoto.
+ *
+ * @param runs L'elenco.
+ * @param lines Indica se i run contengono righe invece di coppie di parole.
+ */
+void spill_runs_init(SpillRuns *runs, bool lines) {
+    runs->files = NULL;
+    runs->count = 0;
+    runs->capacity = 0;
+    runs->lines = lines;
+}
+
+/**
+ * Aggiunge un run a un elenco; se i run raggiungono SPILL_MAX_RUNS vengono uniti in un unico run.
+ *
+ * In questo modo il numero di file aperti e di record letti contemporaneamente dall'unione resta
+ * limitato, qualunque sia la dimensione del testo.
+ *
+ * @param runs L'elenco.
+ * @param file Il run.
+ */
+void spill_runs_add(SpillRuns *runs, FILE *file) {
+    // Se l'elenco è pieno la capacità viene raddoppiata
+    if (runs->count == runs->capacity) {
+        runs->capacity = runs->capacity ? runs->capacity * 2 : 8;
+
+        runs->files = (FILE **)realloc(runs->files, runs->capacity * sizeof(FILE *));
+        if (!runs->files) error_handler(ERR_MEMORY_ALLOCATION);
+    }
+
+    runs->files[runs->count++] = file;
+
+    if (runs->count == SPILL_MAX_RUNS) compact_spill_runs(runs);
+}
+
+/**
+ * Distrugge un elenco di run, chiudendo i run rimasti.
+ *
+ * @param runs L'elenco.
+ */
+void spill_runs_destroy(SpillRuns *runs) {
+    for (int i = 0; i < runs->count; i++) fclose(runs->files[i]);
+
+    free(runs->files);
+    spill_runs_init(runs, runs->lines);
+}
+
+/**
+ * Crea l'unione dei run di un elenco, che viene svuotato.
+ *
+ * @param runs L'elenco (i run vengono chiusi alla distruzione dell'unione).
+ * @return L'unione creata.
+ */
+SpillMerge *spill_merge_create(SpillRuns *runs) {
+    int count = runs->count;
+
+    // Allocazione dell'unione
+    SpillMerge *merge = (SpillMerge *)malloc(sizeof(SpillMerge));
+    if (!merge) error_handler(ERR_MEMORY_ALLOCATION);
+
+    merge->runs = (SpillRun *)calloc(count + 1, sizeof(SpillRun));
+    merge->heap = (int *)malloc((count + 1) * sizeof(int));
+    if (!merge->runs || !merge->heap) error_handler(ERR_MEMORY_ALLOCATION);
+
+    merge->count = count;
+    merge->size = 0;
+    merge->last = -1;
+    merge->lines = runs->lines;
+
+    // Lettura del primo record di ogni run (i run non vuoti entrano nel min-heap)
+    for (int i = 0; i < count; i++) {
+        merge->runs[i].file = runs->files[i];
+        if (fflush(runs->files[i]) == EOF || fseek(runs->files[i], 0, SEEK_SET) == -1) error_handler(ERR_TEMPORARY_FILE);
+
+        if (read_spill_record(&merge->runs[i], merge->lines)) merge->heap[merge->size++] = i;
+    }
+
+    runs->count = 0;
+
+    // Costruzione del min-heap
+    for (int i = merge->size / 2 - 1; i >= 0; i--) sift_spill_run(merge, i);
+
+    // Restituzione dell'unione
+    return merge;
+}
+
+/**
+ * Restituisce la coppia di parole successiva di un'unione, in ordine di parola e parola successiva.
+ *
+ * @param merge L'unione.
+ * @return La coppia (valida fino alla chiamata successiva), NULL se i run sono terminati.
+ */
+SpillPair *spill_merge_pair(SpillMerge *merge) {
+    int run = next_spill_run(merge);
+
+    return run == -1 ? NULL : &merge->runs[run].pair;
+}
+
+/**
+ * Restituisce la riga successiva di un'unione, in ordine di riga.
+ *
+ * @param merge L'unione.
+ * @return La riga (valida fino alla chiamata successiva), NULL se i run sono terminati.
+ */
+SpillLine *spill_merge_line(SpillMerge *merge) {
+    int run = next_spill_run(merge);
+
+    return run == -1 ? NULL : &merge->runs[run].line;
+}
+
+/**
+ * Distrugge un'unione di run, chiudendo i run.
+ *
+ * @param merge L'unione da distruggere.
+ */
+void spill_merge_destroy(SpillMerge *merge) {
+    for (int i = 0; i < merge->count; i++) {
+        fclose(merge->runs[i].file);
+        free(merge->runs[i].line.text);
+    }
+
+    free(merge->runs);
+    free(merge->heap);
+    free(merge);
+}
+
+/**
+ * Unisce tutti i run di un elenco in un unico run.
+ *
+ * @param runs L'elenco.
+ */
+void compact_spill_runs(SpillRuns *runs) {
+    FILE *file = spill_create();
+    SpillMerge *merge = spill_merge_create(runs);
+
+    // I record vengono copiati in ordine (le coppie uguali di run diversi vengono unite solo alla fine)
+    if (merge->lines) {
+        SpillLine *line;
+        while ((line = spill_merge_line(merge))) spill_write_line(file, line->order, line->text, line->length);
+    } else {
+        SpillPair *pair;
+        while ((pair = spill_merge_pair(merge))) spill_write_pair(file, pair);
+    }
+
+    spill_merge_destroy(merge);
+
+    runs->files[runs->count++] = file;
+}
+
+/**
+ * Legge il record successivo di un run.
+ *
+ * @param run Il run.
+ * @param lines Indica se il run contiene righe invece di coppie di parole.
+ * @return true se il record è stato letto, false se il run è terminato.
+ */
+bool read_spill_record(SpillRun *run, bool lines) {
+    if (lines) {
+        SpillLine *line = &run->line;
+
+        if (fread(&line->order, sizeof(size_t), 1, run->file) != 1) return false;
+        if (fread(&line->length, sizeof(size_t), 1, run->file) != 1) error_handler(ERR_TEMPORARY_FILE);
+
+        // Il buffer della riga viene ingrandito se necessario
+        if (line->length > line->capacity) {
+            line->capacity = line->length;
+            line->text = (char *)realloc(line->text, line->capacity);
+            if (!line->text) error_handler(ERR_MEMORY_ALLOCATION);
+        }
+
+        if (fread(line->text, 1, line->length, run->file) != line->length) error_handler(ERR_TEMPORARY_FILE);
+
+        return true;
+    }
+
+    SpillPair *pair = &run->pair;
+
+    if (!read_spill_word(run->file, pair->word)) return false;
+
+    // Un run non può terminare a metà di una coppia
+    if (!read_spill_word(run->file, pair->next_word)) error_handler(ERR_TEMPORARY_FILE);
+
+    if (fread(&pair->count, sizeof(size_t), 1, run->file) != 1 ||
+        fread(&pair->order, sizeof(size_t), 1, run->file) != 1 ||
+        fread(&pair->entry_order, sizeof(size_t), 1, run->file) != 1) error_handler(ERR_TEMPORARY_FILE);
+
+    return true;
+}
+
+/**
+ * Legge una parola da un run.
+ *
+ * @param file Il run.
+ * @param word La parola letta (MAX_WORD_BYTES byte).
+ * @return true se la parola è stata letta, false se il run è terminato.
+ */
+bool read_spill_word(FILE *file, char *word) {
+    int length = fgetc(file);
+    if (length == EOF) return false;
+
+    if (length >= MAX_WORD_BYTES || fread(word, 1, length, file) != (size_t)length) error_handler(ERR_TEMPORARY_FILE);
+    word[length] = '\0';
+
+    return true;
+}
+
+/**
+ * Confronta i record correnti di due run di un'unione.
+ *
+ * A parità di record precede il run con l'indice minore, cioè quello scritto prima.
+ *
+ * @param merge L'unione.
+ * @param first L'indice del primo run.
+ * @param second L'indice del secondo run.
+ * @return true se il record del primo run precede quello del secondo, false altrimenti.
+ */
+bool spill_record_precedes(SpillMerge *merge, int first, int second) {
+    int comparison;
+
+    if (merge->lines) {
+        size_t first_order = merge->runs[first].line.order;
+        size_t second_order = merge->runs[second].line.order;
+
+        comparison = (first_order > second_order) - (first_order < second_order);
+    } else {
+        SpillPair *first_pair = &merge->runs[first].pair;
+        SpillPair *second_pair = &merge->runs[second].pair;
+
+        if ((comparison = strcmp(first_pair->word, second_pair->word)) == 0) comparison = strcmp(first_pair->next_word, second_pair->next_word);
+    }
+
+    return comparison < 0 || (comparison == 0 && first < second);
+}
+
+/**
+ * Sposta verso il basso un run nel min-heap di un'unione, fino a ripristinare l'ordinamento.
+ *
+ * @param merge L'unione.
+ * @param index La posizione del run nel min-heap.
+ */
+void sift_spill_run(SpillMerge *merge, int index) {
+    int *heap = merge->heap;
+
+    while (true) {
+        // Il run viene scambiato con il figlio minore, finché ne esiste uno che lo precede
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+
+        if (left < merge->size && spill_record_precedes(merge, heap[left], heap[smallest])) smallest = left;
+        if (right < merge->size && spill_record_precedes(merge, heap[right], heap[smallest])) smallest = right;
+
+        if (smallest == index) return;
+
+        int run = heap[index];
+        heap[index] = heap[smallest];
+        heap[smallest] = run;
+
+        index = smallest;
+    }
+}
+
+/**
+ * Avanza il run restituito per ultimo da un'unione e restituisce il run con il record minore.
+ *
+ * @param merge L'unione.
+ * @return L'indice del run, -1 se i run sono terminati.
+ */
+int next_spill_run(SpillMerge *merge) {
+    // Il run restituito per ultimo è in cima al min-heap: se è terminato viene sostituito dall'ultimo
+    if (merge->last != -1) {
+        if (!read_spill_record(&merge->runs[merge->last], merge->lines)) merge->heap[0] = merge->heap[--merge->size];
+
+        sift_spill_run(merge, 0);
+    }
+
+    merge->last = merge->size > 0 ? merge->heap[0] : -1;
+
+    return merge->last;
+}
\ No newline at end of file
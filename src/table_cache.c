@@ -0,0 +1,428 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#include "table_cache.h"
+#include "table_file.h"
+#include "error_handler.h"
+
+/**
+ * Calcola l'hash a 64 bit (FNV-1a) di un percorso.
+ *
+ * @param path Il percorso.
+ * @return L'hash del percorso.
+ */
+uint64_t hash_table_path(char *path);
+
+/**
+ * Scrive il nome dell'immagine di una tabella (senza la directory).
+ *
+ * @param buffer Il buffer.
+ * @param size La dimensione del buffer.
+ * @param stem L'hash del percorso della tabella.
+ * @param table_stat Le informazioni sul file della tabella.
+ */
+void format_image_name(char *buffer, size_t size, char *stem, struct stat *table_stat);
+
+/**
+ * Elimina le immagini e i file temporanei di una tabella, tranne l'immagine indicata.
+ *
+ * @param directory La directory della cache.
+ * @param stem L'hash del percorso della tabella.
+ * @param image_name Il nome dell'immagine da mantenere, NULL per eliminarle tutte.
+ */
+void remove_table_images(char *directory, char *stem, char *image_name);
+
+/**
+ * Elimina le immagini delle altre tabelle della cache che non sono più valide.
+ *
+ * @param cache Il riferimento all'immagine.
+ */
+void sweep_table_cache(TableCache *cache);
+
+/**
+ * Elimina le immagini di una tabella eliminata o modificata, o non usate da più di TABLE_CACHE_MAX_AGE secondi.
+ *
+ * @param directory La directory della cache.
+ * @param stem L'hash del percorso della tabella.
+ */
+void sweep_table_images(char *directory, char *stem);
+
+/**
+ * Crea, se non esiste, la directory della cache dell'utente e verifica che sia accessibile solo all'utente.
+ *
+ * @param directory Il percorso della directory.
+ * @return true se la directory può essere usata, false altrimenti.
+ */
+bool open_cache_directory(char *directory);
+
+/**
+ * Crea il riferimento all'immagine di una tabella nella cache.
+ *
+ * @param table_file Il file della tabella.
+ * @param table_filename Il percorso della tabella.
+ * @return Il riferimento all'immagine, NULL se la tabella non è un file regolare o la cache dell'utente non è disponibile.
+ */
+TableCache *table_cache_create(FILE *table_file, char *table_filename) {
+    // La tabella deve essere un file regolare, identificato da dimensione e data di modifica
+    struct stat table_stat;
+    if (fstat(fileno(table_file), &table_stat) == -1 || !S_ISREG(table_stat.st_mode)) return NULL;
+
+    // Directory della cache dell'utente (gli altri utenti non possono né leggere né sostituire le sue immagini)
+    char directory[strlen(TABLE_CACHE_DIRECTORY) + strlen(TABLE_CACHE_PREFIX) + 32];
+    sprintf(directory, "%s/%s%ld", TABLE_CACHE_DIRECTORY, TABLE_CACHE_PREFIX, (long)getuid());
+
+    if (!open_cache_directory(directory)) return NULL;
+
+    // Allocazione del riferimento
+    TableCache *cache = (TableCache *)malloc(sizeof(TableCache));
+    if (!cache) error_handler(ERR_MEMORY_ALLOCATION);
+
+    cache->directory = strdup(directory);
+    if (!cache->directory) error_handler(ERR_MEMORY_ALLOCATION);
+
+    cache->lock_fd = -1;
+
+    // Lo stesso file raggiunto da percorsi diversi condivide l'immagine
+    cache->table_path = realpath(table_filename, NULL);
+    if (!cache->table_path) cache->table_path = strdup(table_filename);
+    if (!cache->table_path) error_handler(ERR_MEMORY_ALLOCATION);
+
+    uint64_t path_hash = hash_table_path(cache->table_path);
+
+    // Nomi dei file della cache
+    size_t size = strlen(directory) + 128;
+
+    cache->stem = (char *)malloc(size);
+    cache->image_filename = (char *)malloc(size);
+    cache->lock_filename = (char *)malloc(size);
+    if (!cache->stem || !cache->image_filename || !cache->lock_filename) error_handler(ERR_MEMORY_ALLOCATION);
+
+    snprintf(cache->stem, size, "%016llx", (unsigned long long)path_hash);
+    snprintf(cache->lock_filename, size, "%s/%s.lock", directory, cache->stem);
+
+    int length = snprintf(cache->image_filename, size, "%s/", directory);
+    format_image_name(cache->image_filename + length, size - length, cache->stem, &table_stat);
+
+    // Restituzione del riferimento
+    return cache;
+}
+
+/**
+ * Mappa in sola lettura l'immagine di una tabella, se è presente nella cache.
+ *
+ * Le immagini vengono create con un nome temporaneo e rinominate solo quando sono complete, quindi
+ * un'immagine presente è completa; viene comunque usata solo se appartiene all'utente e non può
+ * essere modificata da altri, e solo se i suoi offset sono validi. Un'immagine non valida viene
+ * trattata come assente, quindi viene sostituita da quella creata dal chiamante.
+ *
+ * @param cache Il riferimento all'immagine.
+ * @return La tabella delle frequenze, NULL se l'immagine non è presente, non appartiene all'utente o non è valida.
+ */
+HashMap *table_cache_open(TableCache *cache) {
+    int fd = open(cache->image_filename, O_RDONLY | O_NOFOLLOW);
+    if (fd == -1) return NULL;
+
+    struct stat image_stat;
+    if (fstat(fd, &image_stat) == -1 || !S_ISREG(image_stat.st_mode) || image_stat.st_uid != getuid() || (image_stat.st_mode & (S_IWGRP | S_IWOTH))) {
+        close(fd);
+        return NULL;
+    }
+
+    // La mappatura resta valida anche dopo la chiusura del file e la sua eliminazione
+    HashMap *word_frequencies = table_file_load(fd);
+
+    // La data di modifica dell'immagine indica il suo ultimo uso
+    if (word_frequencies) futimens(fd, NULL);
+
+    close(fd);
+
+    return word_frequencies;
+}
+
+/**
+ * Acquisisce il lock per la creazione delle immagini della tabella (attendendo gli altri processi).
+ *
+ * Se il file di lock non può essere creato, l'immagine viene creata senza lock: la ridenominazione
+ * garantisce comunque che un'immagine presente sia completa. Se il file viene eliminato mentre si
+ * attende il lock, viene ricreato e il lock riacquisito. Acquisito il lock, nel file viene scritto
+ * il percorso della tabella.
+ *
+ * @param cache Il riferimento all'immagine.
+ */
+void table_cache_lock(TableCache *cache) {
+    while (true) {
+        cache->lock_fd = open(cache->lock_filename, O_RDWR | O_CREAT | O_NOFOLLOW, 0600);
+        if (cache->lock_fd == -1) return;
+
+        if (flock(cache->lock_fd, LOCK_EX) == -1) {
+            close(cache->lock_fd);
+            cache->lock_fd = -1;
+            return;
+        }
+
+        // Il lock vale solo se il file ha ancora il nome del lock: la pulizia di un'altra esecuzione può averlo eliminato durante l'attesa
+        struct stat lock_stat;
+        struct stat path_stat;
+        if (fstat(cache->lock_fd, &lock_stat) == 0 && stat(cache->lock_filename, &path_stat) == 0 &&
+            lock_stat.st_dev == path_stat.st_dev && lock_stat.st_ino == path_stat.st_ino) break;
+
+        close(cache->lock_fd);
+    }
+
+    // Percorso della tabella, letto dalla pulizia delle altre esecuzioni (se non viene scritto, la pulizia tratta la tabella come eliminata)
+    size_t length = strlen(cache->table_path);
+    if (ftruncate(cache->lock_fd, 0) == -1 || pwrite(cache->lock_fd, cache->table_path, length, 0) != (ssize_t)length) return;
+}
+
+/**
+ * Rilascia il lock per la creazione delle immagini della tabella.
+ *
+ * @param cache Il riferimento all'immagine.
+ */
+void table_cache_unlock(TableCache *cache) {
+    if (cache->lock_fd == -1) return;
+
+    // La chiusura del file rilascia il lock
+    close(cache->lock_fd);
+    cache->lock_fd = -1;
+}
+
+/**
+ * Salva l'immagine di una tabella nella cache, eliminando le immagini non più valide.
+ *
+ * L'immagine viene scritta in un file temporaneo e poi rinominata; se non può essere scritta
+ * (ad esempio perché la memoria condivisa è piena), la cache resta invariata. Una volta salvata
+ * l'immagine, vengono eliminate le altre immagini della tabella e quelle delle tabelle eliminate,
+ * modificate o non usate da più di TABLE_CACHE_MAX_AGE secondi.
+ *
+ * @param cache Il riferimento all'immagine.
+ * @param word_frequencies La tabella delle frequenze (compilata).
+ */
+void table_cache_store(TableCache *cache, HashMap *word_frequencies) {
+    // Percorso del file temporaneo, unico per il processo
+    char temporary_filename[strlen(cache->image_filename) + 32];
+    sprintf(temporary_filename, "%s.%ld.tmp", cache->image_filename, (long)getpid());
+
+    // Il file viene creato accessibile solo all'utente (se esiste già non viene sovrascritto)
+    int fd = open(temporary_filename, O_WRONLY | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) return;
+
+    FILE *image_file = fdopen(fd, "w");
+    if (!image_file) {
+        close(fd);
+        unlink(temporary_filename);
+        return;
+    }
+
+    bool written = table_file_write(word_frequencies, image_file);
+    if (fclose(image_file) == EOF) written = false;
+
+    // Il file temporaneo diventa l'immagine solo se è completo
+    if (!written || rename(temporary_filename, cache->image_filename) == -1) {
+        unlink(temporary_filename);
+        return;
+    }
+
+    // Senza lock un file temporaneo della tabella potrebbe essere ancora in scrittura
+    if (cache->lock_fd == -1) return;
+
+    remove_table_images(cache->directory, cache->stem, cache->image_filename + strlen(cache->directory) + 1);
+    sweep_table_cache(cache);
+}
+
+/**
+ * Distrugge il riferimento all'immagine di una tabella, rilasciando il lock se è stato acquisito.
+ *
+ * @param cache Il riferimento all'immagine.
+ */
+void table_cache_destroy(TableCache *cache) {
+    table_cache_unlock(cache);
+
+    free(cache->directory);
+    free(cache->table_path);
+    free(cache->stem);
+    free(cache->image_filename);
+    free(cache->lock_filename);
+    free(cache);
+}
+
+/**
+ * Crea, se non esiste, la directory della cache dell'utente e verifica che sia accessibile solo all'utente.
+ *
+ * Il nome della directory è prevedibile, quindi può essere stata creata da un altro utente: in quel
+ * caso (o se è un collegamento simbolico o è accessibile ad altri) la cache non viene usata.
+ *
+ * @param directory Il percorso della directory.
+ * @return true se la directory può essere usata, false altrimenti.
+ */
+bool open_cache_directory(char *directory) {
+    if (mkdir(directory, 0700) == -1 && errno != EEXIST) return false;
+
+    struct stat directory_stat;
+    return lstat(directory, &directory_stat) == 0 && S_ISDIR(directory_stat.st_mode) && directory_stat.st_uid == getuid() && (directory_stat.st_mode & (S_IRWXG | S_IRWXO)) == 0;
+}
+
+/**
+ * Calcola l'hash a 64 bit (FNV-1a) di un percorso.
+ *
+ * @param path Il percorso.
+ * @return L'hash del percorso.
+ */
+uint64_t hash_table_path(char *path) {
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (unsigned char *c = (unsigned char *)path; *c; c++) {
+        hash ^= *c;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * Scrive il nome dell'immagine di una tabella (senza la directory).
+ *
+ * @param buffer Il buffer.
+ * @param size La dimensione del buffer.
+ * @param stem L'hash del percorso della tabella.
+ * @param table_stat Le informazioni sul file della tabella.
+ */
+void format_image_name(char *buffer, size_t size, char *stem, struct stat *table_stat) {
+    snprintf(buffer, size, "%s-%lld-%lld.%09ld-v%d", stem, (long long)table_stat->st_size, (long long)table_stat->st_mtim.tv_sec, (long)table_stat->st_mtim.tv_nsec, TABLE_FILE_VERSION);
+}
+
+/**
+ * Elimina le immagini e i file temporanei di una tabella, tranne l'immagine indicata.
+ *
+ * Le immagini eliminate restano valide per i processi che le hanno già mappate; i file temporanei
+ * possono essere eliminati perché vengono creati solo da chi ha acquisito il lock (che deve essere
+ * acquisito dal chiamante).
+ *
+ * @param directory La directory della cache.
+ * @param stem L'hash del percorso della tabella.
+ * @param image_name Il nome dell'immagine da mantenere, NULL per eliminarle tutte.
+ */
+void remove_table_images(char *directory, char *stem, char *image_name) {
+    DIR *cache_directory = opendir(directory);
+    if (!cache_directory) return;
+
+    size_t stem_length = strlen(stem);
+
+    struct dirent *directory_entry;
+    while ((directory_entry = readdir(cache_directory))) {
+        char *name = directory_entry->d_name;
+
+        // Solo i file della stessa tabella (il file di lock ha un punto dopo lo stem)
+        if (strncmp(name, stem, stem_length) != 0 || name[stem_length] != '-' || (image_name && strcmp(name, image_name) == 0)) continue;
+
+        char filename[strlen(directory) + strlen(name) + 2];
+        sprintf(filename, "%s/%s", directory, name);
+        unlink(filename);
+    }
+
+    closedir(cache_directory);
+}
+
+/**
+ * Elimina le immagini delle altre tabelle della cache che non sono più valide.
+ *
+ * Le tabelle vengono riconosciute dai file di lock; i file di una tabella senza file di lock sono
+ * resti di una tabella già eliminata e vengono eliminati direttamente.
+ *
+ * @param cache Il riferimento all'immagine.
+ */
+void sweep_table_cache(TableCache *cache) {
+    DIR *cache_directory = opendir(cache->directory);
+    if (!cache_directory) return;
+
+    size_t stem_length = strlen(cache->stem);
+
+    struct dirent *directory_entry;
+    while ((directory_entry = readdir(cache_directory))) {
+        char *name = directory_entry->d_name;
+
+        // Le immagini della tabella corrente sono già state eliminate
+        if (name[0] == '.' || strncmp(name, cache->stem, stem_length) == 0) continue;
+
+        // Lo stem termina al primo trattino (immagini e file temporanei) o punto (file di lock)
+        size_t length = strcspn(name, "-.");
+        char stem[length + 1];
+        memcpy(stem, name, length);
+        stem[length] = '\0';
+
+        if (strcmp(name + length, ".lock") == 0) {
+            sweep_table_images(cache->directory, stem);
+            continue;
+        }
+
+        char lock_filename[strlen(cache->directory) + length + 7];
+        sprintf(lock_filename, "%s/%s.lock", cache->directory, stem);
+
+        if (access(lock_filename, F_OK) == -1 && errno == ENOENT) {
+            char filename[strlen(cache->directory) + strlen(name) + 2];
+            sprintf(filename, "%s/%s", cache->directory, name);
+            unlink(filename);
+        }
+    }
+
+    closedir(cache_directory);
+}
+
+/**
+ * Elimina le immagini di una tabella eliminata o modificata, o non usate da più di TABLE_CACHE_MAX_AGE secondi.
+ *
+ * Se un altro processo sta creando un'immagine della tabella, la tabella viene saltata. Se non
+ * resta alcuna immagine, viene eliminato anche il file di lock.
+ *
+ * @param directory La directory della cache.
+ * @param stem L'hash del percorso della tabella.
+ */
+void sweep_table_images(char *directory, char *stem) {
+    char lock_filename[strlen(directory) + strlen(stem) + 7];
+    sprintf(lock_filename, "%s/%s.lock", directory, stem);
+
+    int fd = open(lock_filename, O_RDWR | O_NOFOLLOW);
+    if (fd == -1) return;
+
+    if (flock(fd, LOCK_EX | LOCK_NB) == -1) {
+        close(fd);
+        return;
+    }
+
+    // Percorso della tabella, scritto nel file di lock
+    char path[PATH_MAX + 1];
+    ssize_t length = pread(fd, path, PATH_MAX, 0);
+    path[length > 0 ? length : 0] = '\0';
+
+    // L'immagine corrente della tabella viene mantenuta solo se esiste ed è stata usata di recente
+    char image_name[strlen(stem) + 128];
+    char *kept = NULL;
+
+    struct stat table_stat;
+    if (length > 0 && stat(path, &table_stat) == 0 && S_ISREG(table_stat.st_mode)) {
+        format_image_name(image_name, sizeof(image_name), stem, &table_stat);
+
+        char image_filename[strlen(directory) + strlen(image_name) + 2];
+        sprintf(image_filename, "%s/%s", directory, image_name);
+
+        struct stat image_stat;
+        if (stat(image_filename, &image_stat) == 0 && time(NULL) - image_stat.st_mtime < TABLE_CACHE_MAX_AGE) kept = image_name;
+    }
+
+    remove_table_images(directory, stem, kept);
+
+    // Il file di lock viene eliminato mentre è ancora acquisito, quindi nessun altro processo sta creando immagini (i processi in attesa del lock lo ricreano)
+    if (!kept) unlink(lock_filename);
+
+    close(fd);
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "table_file.h"
+#include "error_handler.h"
+#include "constants.h"
+
+/**
+ * Valore usato per verificare l'ordine dei byte.
+ */
+#define BYTE_ORDER_MARK 0x01020304
+
+/**
+ * Scrive una tabella delle frequenze compilata su un file.
+ *
+ * @param word_frequencies La tabella delle frequenze (compilata).
+ * @param file Il file.
+ * @return true se la tabella è stata scritta, false altrimenti.
+ */
+bool table_file_write(HashMap *word_frequencies, FILE *file) {
+    // Vengono scritti solo gli oggetti usati, copiati in una nuova regione pubblicata prima di leggerne la dimensione
+    HashMap *compact = hashmap_compact(word_frequencies);
+    hashmap_publish(compact);
+
+    // Intestazione
+    TableFileHeader header;
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, TABLE_FILE_MAGIC, sizeof(TABLE_FILE_MAGIC));
+    header.version = TABLE_FILE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.size_bytes = sizeof(size_t);
+    header.word_bytes = MAX_WORD_BYTES;
+    header.region_offset = sysconf(_SC_PAGESIZE);
+    header.region_size = region_header(compact->region)->size;
+
+    // La regione inizia alla pagina successiva all'intestazione, in modo che possa essere mappata
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fseek(file, header.region_offset, SEEK_SET) != -1 && hashmap_save(compact, file) && fflush(file) != EOF;
+
+    hashmap_destroy(compact);
+
+    return written;
+}
+
+/**
+ * Apre in sola lettura la tabella delle frequenze compilata contenuta in un file, senza leggerla.
+ *
+ * @param fd Il file descriptor del file.
+ * @return La tabella delle frequenze, NULL se il file non contiene una tabella compilata.
+ */
+HashMap *table_file_open(int fd) {
+    // Lettura dell'intestazione (senza spostare la posizione del file, che può essere letto come CSV)
+    TableFileHeader header;
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header)) return NULL;
+
+    // Se l'identificativo non corrisponde, il file non è una tabella compilata
+    if (memcmp(header.magic, TABLE_FILE_MAGIC, sizeof(TABLE_FILE_MAGIC)) != 0) return NULL;
+
+    // Una tabella compilata che non può essere mappata è un errore
+    HashMap *word_frequencies = table_file_load(fd);
+    if (!word_frequencies) error_handler(ERR_INVALID_TABLE);
+
+    return word_frequencies;
+}
+
+/**
+ * Apre in sola lettura la tabella delle frequenze compilata contenuta in un file, se è valida.
+ *
+ * @param fd Il file descriptor del file.
+ * @return La tabella delle frequenze, NULL se il file non contiene una tabella compilata valida.
+ */
+HashMap *table_file_load(int fd) {
+    TableFileHeader header;
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header)) return NULL;
+
+    // Una tabella compilata con un formato diverso non può essere mappata
+    if (memcmp(header.magic, TABLE_FILE_MAGIC, sizeof(TABLE_FILE_MAGIC)) != 0) return NULL;
+    if (header.version != TABLE_FILE_VERSION || header.byte_order != BYTE_ORDER_MARK || header.size_bytes != sizeof(size_t) || header.word_bytes != MAX_WORD_BYTES) return NULL;
+
+    // La regione deve iniziare a un offset allineato alle pagine, dopo l'intestazione
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (header.region_offset < sizeof(header) || header.region_offset % page_size != 0) return NULL;
+
+    // Mappatura della hashmap (la regione deve essere completa e i suoi offset validi)
+    HashMap *word_frequencies = hashmap_load(fd, header.region_offset);
+    if (word_frequencies && region_header(word_frequencies->region)->size != header.region_size) {
+        hashmap_destroy(word_frequencies);
+        return NULL;
+    }
+
+    return word_frequencies;
+}
\ No newline at end of file
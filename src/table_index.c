@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "table_index.h"
+#include "hashmap.h"
+#include "error_handler.h"
+#include "constants.h"
+
+/**
+ * Numero minimo di slot di un indice.
+ */
+#define MIN_INDEX_SLOTS 16
+
+/**
+ * Legge la parola di una riga, ignorando gli spazi come il caricamento della tabella.
+ *
+ * @param row L'inizio della riga.
+ * @param end La fine della tabella.
+ * @param word La parola letta (troncata a MAX_WORD_BYTES - 1 byte).
+ */
+void read_row_word(char *row, char *end, char *word);
+
+/**
+ * Cerca lo slot di una parola.
+ *
+ * @param index L'indice.
+ * @param word La parola.
+ * @return L'indice dello slot della parola, o di quello vuoto in cui inserirla.
+ */
+size_t find_index_slot(TableIndex *index, char *word);
+
+/**
+ * Costruisce l'indice scorrendo le righe della tabella.
+ *
+ * @param index L'indice (con la tabella mappata).
+ */
+void build_table_index(TableIndex *index);
+
+/**
+ * Mappa il file di un indice, se corrisponde alla tabella.
+ *
+ * @param index L'indice (con la tabella mappata).
+ * @param index_filename Il percorso del file dell'indice.
+ * @param table_stat Le informazioni sul file della tabella.
+ * @return true se il file è stato mappato, false se manca o non corrisponde alla tabella.
+ */
+bool load_table_index(TableIndex *index, char *index_filename, struct stat *table_stat);
+
+/**
+ * Salva un indice su file, scrivendo un file temporaneo che viene poi rinominato.
+ *
+ * @param index L'indice.
+ * @param index_filename Il percorso del file dell'indice.
+ * @param table_stat Le informazioni sul file della tabella.
+ */
+void save_table_index(TableIndex *index, char *index_filename, struct stat *table_stat);
+
+/**
+ * Apre l'indice di una tabella, riusando il file dell'indice se corrisponde alla tabella e
+ * costruendolo e salvandolo altrimenti.
+ *
+ * @param table_file Il file della tabella.
+ * @param index_filename Il percorso del file dell'indice.
+ * @return L'indice, NULL se la tabella non è un file regolare.
+ */
+TableIndex *table_index_open(FILE *table_file, char *index_filename) {
+    // La tabella deve essere un file regolare, per poter essere mappata
+    struct stat table_stat;
+    if (fstat(fileno(table_file), &table_stat) == -1 || !S_ISREG(table_stat.st_mode)) return NULL;
+
+    // Allocazione dell'indice
+    TableIndex *index = (TableIndex *)malloc(sizeof(TableIndex));
+    if (!index) error_handler(ERR_MEMORY_ALLOCATION);
+
+    index->table = NULL;
+    index->table_size = table_stat.st_size;
+    index->slots = NULL;
+    index->slot_count = 0;
+    index->mapping = NULL;
+    index->mapping_size = 0;
+
+    // Mappatura della tabella, letta solo nelle righe visitate
+    if (index->table_size > 0) {
+        index->table = mmap(NULL, index->table_size, PROT_READ, MAP_PRIVATE, fileno(table_file), 0);
+        if (index->table == MAP_FAILED) error_handler(ERR_MEMORY_ALLOCATION);
+
+        madvise(index->table, index->table_size, MADV_RANDOM);
+    }
+
+    // Se il file dell'indice non corrisponde alla tabella, l'indice viene ricostruito e salvato
+    if (!load_table_index(index, index_filename, &table_stat)) {
+        build_table_index(index);
+        save_table_index(index, index_filename, &table_stat);
+    }
+
+    // Restituzione dell'indice
+    return index;
+}
+
+/**
+ * Cerca la riga di una parola.
+ *
+ * @param index L'indice.
+ * @param word La parola.
+ * @param size La dimensione della riga (compreso l'eventuale a capo).
+ * @return L'inizio della riga nella tabella mappata, NULL se la parola non ha una riga.
+ */
+char *table_index_find(TableIndex *index, char *word, size_t *size) {
+    uint64_t slot = index->slots[find_index_slot(index, word)];
+    if (!slot) return NULL;
+
+    // La riga termina dopo l'a capo o alla fine della tabella
+    char *row = index->table + slot - 1;
+    char *end = index->table + index->table_size;
+
+    char *newline = memchr(row, '\n', end - row);
+    *size = newline ? newline - row + 1 : end - row;
+
+    return row;
+}
+
+/**
+ * Chiude un indice, rimuovendo le mappature.
+ *
+ * @param index L'indice.
+ */
+void table_index_close(TableIndex *index) {
+    // Gli slot sono mappati dal file dell'indice oppure allocati
+    if (index->mapping) {
+        munmap(index->mapping, index->mapping_size);
+    } else {
+        free(index->slots);
+    }
+
+    if (index->table) munmap(index->table, index->table_size);
+
+    free(index);
+}
+
+/**
+ * Legge la parola di una riga, ignorando gli spazi come il caricamento della tabella.
+ *
+ * @param row L'inizio della riga.
+ * @param end La fine della tabella.
+ * @param word La parola letta (troncata a MAX_WORD_BYTES - 1 byte).
+ */
+void read_row_word(char *row, char *end, char *word) {
+    size_t length = 0;
+
+    // Virgola, a capo e spazio sono byte ASCII, quindi non fanno mai parte di sequenze multibyte
+    while (row < end && *row != ',' && *row != '\n') {
+        if (*row != ' ' && length < MAX_WORD_BYTES - 1) word[length++] = *row;
+        row++;
+    }
+
+    word[length] = '\0';
+}
+
+/**
+ * Cerca lo slot di una parola.
+ *
+ * @param index L'indice.
+ * @param word La parola.
+ * @return L'indice dello slot della parola, o di quello vuoto in cui inserirla.
+ */
+size_t find_index_slot(TableIndex *index, char *word) {
+    size_t mask = index->slot_count - 1;
+    size_t slot = hash(word) & mask;
+
+    char row_word[MAX_WORD_BYTES];
+
+    // Scansione lineare fino alla riga della parola o a uno slot vuoto
+    while (index->slots[slot]) {
+        read_row_word(index->table + index->slots[slot] - 1, index->table + index->table_size, row_word);
+        if (strcmp(row_word, word) == 0) break;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * Costruisce l'indice scorrendo le righe della tabella.
+ *
+ * Le righe vengono cercate senza essere processate; se una parola ha più righe, l'indice contiene
+ * l'ultima, come nel caricamento completo della tabella.
+ *
+ * @param index L'indice (con la tabella mappata).
+ */
+void build_table_index(TableIndex *index) {
+    char *end = index->table + index->table_size;
+
+    // Numero di righe (l'ultima può non terminare con un a capo)
+    size_t rows = 0;
+    for (char *row = index->table; row && row < end; rows++) {
+        row = memchr(row, '\n', end - row);
+        if (row) row++;
+    }
+
+    // Slot per almeno il doppio delle righe
+    index->slot_count = MIN_INDEX_SLOTS;
+    while (index->slot_count < rows * 2) index->slot_count *= 2;
+
+    index->slots = (uint64_t *)calloc(index->slot_count, sizeof(uint64_t));
+    if (!index->slots) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Inserimento delle righe (una parola ripetuta sovrascrive lo slot della riga precedente)
+    char word[MAX_WORD_BYTES];
+
+    for (char *row = index->table; row && row < end; ) {
+        read_row_word(row, end, word);
+        index->slots[find_index_slot(index, word)] = row - index->table + 1;
+
+        row = memchr(row, '\n', end - row);
+        if (row) row++;
+    }
+}
+
+/**
+ * Mappa il file di un indice, se corrisponde alla tabella.
+ *
+ * @param index L'indice (con la tabella mappata).
+ * @param index_filename Il percorso del file dell'indice.
+ * @param table_stat Le informazioni sul file della tabella.
+ * @return true se il file è stato mappato, false se manca o non corrisponde alla tabella.
+ */
+bool load_table_index(TableIndex *index, char *index_filename, struct stat *table_stat) {
+    FILE *index_file = fopen(index_filename, "r");
+    if (!index_file) return false;
+
+    // L'intestazione deve corrispondere alla tabella e il file deve contenere tutti gli slot
+    TableIndexHeader header;
+    struct stat index_stat;
+
+    bool valid = fread(&header, sizeof(header), 1, index_file) == 1 && fstat(fileno(index_file), &index_stat) != -1
+        && memcmp(header.magic, TABLE_INDEX_MAGIC, sizeof(TABLE_INDEX_MAGIC)) == 0 && header.version == TABLE_INDEX_VERSION
+        && header.table_size == table_stat->st_size && header.table_mtime == table_stat->st_mtim.tv_sec && header.table_mtime_nsec == table_stat->st_mtim.tv_nsec
+        && header.slot_count >= MIN_INDEX_SLOTS && (header.slot_count & (header.slot_count - 1)) == 0
+        && index_stat.st_size == sizeof(header) + header.slot_count * sizeof(uint64_t);
+
+    if (valid) {
+        // Mappatura degli slot, senza leggerli
+        index->mapping_size = index_stat.st_size;
+        index->mapping = mmap(NULL, index->mapping_size, PROT_READ, MAP_PRIVATE, fileno(index_file), 0);
+
+        if (index->mapping == MAP_FAILED) {
+            index->mapping = NULL;
+            valid = false;
+        } else {
+            index->slots = (uint64_t *)(index->mapping + sizeof(header));
+            index->slot_count = header.slot_count;
+        }
+    }
+
+    fclose(index_file);
+
+    return valid;
+}
+
+/**
+ * Salva un indice su file, scrivendo un file temporaneo che viene poi rinominato.
+ *
+ * Il file dell'indice viene così sostituito in un solo passo, anche se più processi lo
+ * salvano insieme; se non può essere scritto, l'indice resta solo in memoria.
+ *
+ * @param index L'indice.
+ * @param index_filename Il percorso del file dell'indice.
+ * @param table_stat Le informazioni sul file della tabella.
+ */
+void save_table_index(TableIndex *index, char *index_filename, struct stat *table_stat) {
+    // Percorso del file temporaneo, unico per il processo
+    char temporary_filename[strlen(index_filename) + 32];
+    sprintf(temporary_filename, "%s.%ld.tmp", index_filename, (long)getpid());
+
+    FILE *index_file = fopen(temporary_filename, "w");
+    if (!index_file) return;
+
+    // Intestazione
+    TableIndexHeader header;
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, TABLE_INDEX_MAGIC, sizeof(TABLE_INDEX_MAGIC));
+    header.version = TABLE_INDEX_VERSION;
+    header.table_size = table_stat->st_size;
+    header.table_mtime = table_stat->st_mtim.tv_sec;
+    header.table_mtime_nsec = table_stat->st_mtim.tv_nsec;
+    header.slot_count = index->slot_count;
+
+    // Scrittura dell'intestazione e degli slot
+    bool written = fwrite(&header, sizeof(header), 1, index_file) == 1 && fwrite(index->slots, sizeof(uint64_t), index->slot_count, index_file) == index->slot_count;
+
+    if (fclose(index_file) == EOF) written = false;
+
+    // Il file temporaneo sostituisce l'indice solo se è completo
+    if (!written || rename(temporary_filename, index_filename) == -1) unlink(temporary_filename);
+}
\ No newline at end of file
@@ -1,39 +1,242 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
-#include <wchar.h>
-#include <wctype.h>
 #include <stdbool.h>
+#include <ctype.h>
 #include <sys/wait.h>
+#include <sys/stat.h>
 #include <errno.h>
+#include <limits.h>
+#include <pthread.h>
 
 #include "tabulate.h"
 #include "hashmap.h"
 #include "error_handler.h"
 #include "constants.h"
+#include "reader.h"
+#include "pipe_io.h"
+#include "ring.h"
+#include "region.h"
+#include "tokenizer.h"
+#include "concurrent_hashmap.h"
+#include "bigram_queue.h"
+#include "bigram_sort.h"
+#include "spill.h"
 
 #define BUFFER_SIZE 1024
 
 /**
- * Verifica se un carattere è una punteggiatura non valida.
+ * Identificativo che indica l'assenza di una parola (non viene mai assegnato, perché le parole sono meno di UINT_MAX).
+ */
+#define NO_WORD UINT_MAX
+
+/**
+ * Struttura che rappresenta un'entry della tabella di una porzione assegnata a una partizione.
+ *
+ * entry è l'offset dell'entry, order la sua posizione nell'ordine di inserimento della porzione.
+ */
+typedef struct {
+    size_t entry;
+    size_t order;
+} PartitionItem;
+
+/**
+ * Struttura che rappresenta una porzione del testo elaborata da un thread.
+ *
+ * Il thread costruisce la tabella della porzione (word_frequencies) e suddivide le sue entry tra
+ * partition_count partizioni in base all'hash della parola: partitions[i] contiene le
+ * partition_sizes[i] entry della partizione i in ordine di inserimento.
+ */
+typedef struct {
+    FILE *input_file;
+    off_t start;
+    off_t end;
+    char terminator;
+    HashMap *word_frequencies;
+    unsigned int previous_word;
+    unsigned int first_word;
+    int partition_count;
+    PartitionItem **partitions;
+    size_t *partition_sizes;
+} RangeTask;
+
+/**
+ * Struttura che rappresenta una partizione delle parole unita da un thread.
+ *
+ * Il thread unisce nella tabella della partizione (word_frequencies) le entry della partizione di
+ * tutte le porzioni, nell'ordine delle porzioni; orders contiene, per ogni entry della tabella in
+ * ordine di inserimento, la sua posizione nell'ordine di inserimento dell'intero testo
+ * (range_orders indica la posizione della prima entry di ogni porzione).
+ */
+typedef struct {
+    RangeTask *ranges;
+    int range_count;
+    size_t *range_orders;
+    int partition;
+    HashMap *word_frequencies;
+    size_t *orders;
+} PartitionTask;
+
+/**
+ * Struttura che rappresenta una porzione del testo inserita da un thread nella tabella condivisa.
+ *
+ * previous_word e first_word sono l'ultima e la prima parola della porzione (NULL se assenti).
+ * Se queues non è NULL, le coppie di parole non vengono inserite ma inviate sulla coda del
+ * thread proprietario della parola (uno per ognuna delle owner_count code); se bigrams non è
+ * NULL, vengono aggiunte all'array con gli identificativi delle parole.
+ */
+typedef struct {
+    FILE *input_file;
+    off_t start;
+    off_t end;
+    char terminator;
+    ConcurrentHashMap *word_frequencies;
+    ConcurrentWord *previous_word;
+    ConcurrentWord *first_word;
+    BigramQueue **queues;
+    int owner_count;
+    BigramArray *bigrams;
+} SharedRangeTask;
+
+/**
+ * Struttura che rappresenta una coppia di parole distinta, ottenuta da una sequenza di coppie ordinate uguali.
+ *
+ * count è il numero di occorrenze della coppia, position la posizione della sua prima occorrenza.
+ */
+typedef struct {
+    unsigned int next_word;
+    size_t count;
+    size_t position;
+} BigramRun;
+
+/**
+ * Struttura che rappresenta una parola con le sue coppie distinte (runs[first_run], ..., runs[first_run + run_count - 1]).
+ *
+ * count è il numero di occorrenze della parola, position la posizione della sua prima occorrenza.
+ */
+typedef struct {
+    unsigned int word;
+    size_t count;
+    size_t position;
+    size_t first_run;
+    size_t run_count;
+} BigramGroup;
+
+/**
+ * Struttura che rappresenta una tabella delle frequenze scritta su disco a run quando supera la memoria massima.
+ *
+ * word_frequencies è la tabella del run corrente, runs i run già scritti; entry_order e pair_order
+ * sono i primi ordini di prima occorrenza ancora liberi per le entry e per i nodi.
+ */
+typedef struct {
+    HashMap *word_frequencies;
+    size_t max_memory;
+    SpillRuns runs;
+    size_t entry_order;
+    size_t pair_order;
+    unsigned int previous_word;
+    unsigned int first_word;
+} ExternalTable;
+
+/**
+ * Struttura che rappresenta un'entry da scrivere su disco, con il testo della parola e l'ordine della prima occorrenza.
+ */
+typedef struct {
+    char *word;
+    Entry *entry;
+    size_t order;
+} SpilledEntry;
+
+/**
+ * Struttura che rappresenta un nodo da scrivere su disco, con il testo della parola successiva e l'ordine della prima occorrenza.
+ */
+typedef struct {
+    char *next_word;
+    size_t count;
+    size_t order;
+} SpilledNode;
+
+/**
+ * Struttura che rappresenta una parola successiva ottenuta dall'unione dei run.
+ */
+typedef struct {
+    char next_word[MAX_WORD_BYTES];
+    size_t count;
+    size_t order;
+} MergedSuccessor;
+
+/**
+ * Struttura che rappresenta una parola ottenuta dall'unione dei run, con le sue parole successive (size, di capacity allocate).
+ */
+typedef struct {
+    char word[MAX_WORD_BYTES];
+    size_t count;
+    size_t order;
+    MergedSuccessor *successors;
+    size_t size;
+    size_t capacity;
+} MergedGroup;
+
+/**
+ * Struttura che rappresenta una riga della tabella delle frequenze in un buffer (offset e length nel testo del buffer).
+ */
+typedef struct {
+    size_t order;
+    size_t offset;
+    size_t length;
+} BufferedLine;
+
+/**
+ * Struttura che rappresenta un buffer delle righe della tabella delle frequenze.
+ *
+ * text contiene il testo delle righe (size byte, di capacity allocati), lines le righe (count, di
+ * lines_capacity allocate), start l'inizio della riga in corso. Quando il buffer supera la
+ * memoria massima le righe vengono scritte in un run ordinato.
+ */
+typedef struct {
+    char *text;
+    size_t size;
+    size_t capacity;
+    BufferedLine *lines;
+    size_t count;
+    size_t lines_capacity;
+    size_t start;
+    size_t max_memory;
+    SpillRuns runs;
+} LineBuffer;
+
+/**
+ * Struttura che rappresenta un thread proprietario di una partizione delle parole.
+ *
+ * Il thread inserisce nella tabella condivisa le coppie di parole ricevute sulle code (una per
+ * porzione, queue_count in tutto), modificando da solo le entry delle sue parole.
+ */
+typedef struct {
+    ConcurrentHashMap *word_frequencies;
+    BigramQueue **queues;
+    int queue_count;
+    BigramSignal signal;
+} OwnerTask;
+
+/**
+ * Inserisce nella tabella delle frequenze una parola del testo.
  *
- * @param character Il carattere da verificare.
- * @return true se il carattere è una punteggiatura non valida, false altrimenti.
+ * @param word_frequencies La tabella delle frequenze.
+ * @param token La parola.
+ * @param previous_word L'identificativo della parola precedente (NO_WORD all'inizio del testo).
+ * @param first_word L'identificativo della prima parola del testo.
  */
-bool is_invalid_punctuation(wchar_t character);
+void process_token(HashMap *word_frequencies, Token *token, unsigned int *previous_word, unsigned int *first_word);
 
 /**
- * Processa un carattere.
+ * Collega l'ultima parola del testo alla prima.
  *
  * @param word_frequencies La tabella delle frequenze.
- * @param character Il carattere da processare.
- * @param previous_word La parola precedente.
- * @param current_word La parola corrente.
- * @param index L'indice della parola corrente.
- * @param first_word La prima parola del testo.
- * @param first_iteration Indica se è la prima iterazione.
+ * @param previous_word L'identificativo dell'ultima parola (NO_WORD se il testo non contiene parole).
+ * @param first_word L'identificativo della prima parola.
  */
-void process_character(HashMap *word_frequencies, wchar_t character, wchar_t *previous_word, wchar_t *current_word, int *index, wchar_t *first_word);
+void link_last_word(HashMap *word_frequencies, unsigned int previous_word, unsigned int first_word);
 
 /**
  * Scrive una tabella di frequenze su un file CSV.
@@ -43,21 +246,32 @@ void process_character(HashMap *word_frequencies, wchar_t character, wchar_t *pr
  */
 void hashmap_to_csv(HashMap *word_frequencies, FILE *output_file);
 
+/**
+ * Scrive la riga di un'entry della tabella delle frequenze su un file CSV.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param entry L'entry da stampare.
+ * @param output_file Il file su cui stampare la riga.
+ */
+void entry_to_csv(HashMap *word_frequencies, Entry *entry, FILE *output_file);
+
 /*
  * Legge il testo da un file e lo scrive su un pipe.
  *
  * @param input_file Il file di input.
  * @param pipe_fd Il file descriptor del pipe.  
+ * @param ring Il ring buffer (NULL se il testo viene trasferito sulla pipe).
 */
-void read_text(FILE *input_file, int pipe_fd[2]);
+void read_text(FILE *input_file, int pipe_fd[2], RingBuffer *ring);
 
 /*
  * Legge il testo da un pipe e lo processa.
  *
  * @param word_frequencies La tabella delle frequenze.
  * @param pipe_fd Il file descriptor del pipe.
+ * @param ring Il ring buffer (NULL se il testo viene trasferito sulla pipe).
 */
-void process_text(HashMap *word_frequencies, int pipe_fd[2]);
+void process_text(HashMap *word_frequencies, int pipe_fd[2], RingBuffer *ring);
 
 /**
  * Converte un file di testo in una tabella di frequenze utilizzando un singolo processo.
@@ -68,23 +282,358 @@ void process_text(HashMap *word_frequencies, int pipe_fd[2]);
  */
 void tabulate_single_process(HashMap *word_frequencies, FILE *input_file, FILE *output_file);
 
+/**
+ * Cerca il confine di una porzione del testo a partire da un offset.
+ *
+ * Il confine segue un terminatore di frase preceduto da una lettera o da una cifra, in modo
+ * che la porzione successiva inizi con il terminatore come parola precedente.
+ *
+ * @param input_file Il file di input.
+ * @param offset L'offset da cui iniziare la ricerca.
+ * @param file_size La dimensione del file.
+ * @param terminator Il terminatore trovato.
+ * @return L'offset del confine, oppure la dimensione del file se non viene trovato.
+ */
+off_t find_boundary(FILE *input_file, off_t offset, off_t file_size, char *terminator);
+
+/**
+ * Cerca la fine della prima parola del testo.
+ *
+ * La prima parola non viene inserita nella tabella insieme al carattere che la termina, quindi
+ * nessuna porzione può iniziare prima della sua fine.
+ *
+ * @param input_file Il file di input.
+ * @param file_size La dimensione del file.
+ * @return L'offset del carattere successivo alla prima parola.
+ */
+off_t find_first_word_end(FILE *input_file, off_t file_size);
+
+/**
+ * Processa il testo letto da un lettore.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param reader Il lettore del testo.
+ * @param previous_word L'identificativo della parola precedente (NO_WORD all'inizio del testo).
+ * @param first_word L'identificativo della prima parola del testo.
+ * @param first_word_only Indica se fermarsi dopo aver letto la prima parola.
+ * @return Il numero di byte processati.
+ */
+off_t process_input(HashMap *word_frequencies, Reader *reader, unsigned int *previous_word, unsigned int *first_word, bool first_word_only);
+
+/**
+ * Converte un file di testo in una tabella di frequenze suddividendolo tra più processi.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param jobs Il numero di processi.
+ */
+void tabulate_parallel(HashMap *word_frequencies, FILE *input_file, FILE *output_file, int jobs);
+
+/**
+ * Suddivide un file di testo in porzioni che terminano con un terminatore di frase.
+ *
+ * @param input_file Il file di input.
+ * @param parts Il numero massimo di porzioni.
+ * @param boundaries Restituisce i confini delle porzioni (porzioni + 1 elementi, l'ultimo è la dimensione del file; da deallocare, NULL se il file non può essere suddiviso).
+ * @param terminators Restituisce i terminatori che precedono le porzioni (da deallocare, NULL se il file non può essere suddiviso).
+ * @return Il numero di porzioni non vuote, 0 se il file non è regolare o è vuoto e non può essere suddiviso.
+ */
+int split_text(FILE *input_file, int parts, off_t **boundaries, char **terminators);
+
+/**
+ * Costruisce la tabella di una porzione del testo e ne suddivide le entry tra le partizioni.
+ *
+ * @param argument La porzione (RangeTask).
+ * @return NULL.
+ */
+void *tokenize_range(void *argument);
+
+/**
+ * Unisce le entry di una partizione di tutte le porzioni nella tabella della partizione.
+ *
+ * @param argument La partizione (PartitionTask).
+ * @return NULL.
+ */
+void *merge_partition(void *argument);
+
+/**
+ * Converte un file di testo in una tabella di frequenze suddividendolo tra più thread.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param threads Il numero di thread.
+ */
+void tabulate_threaded(HashMap *word_frequencies, FILE *input_file, FILE *output_file, int threads);
+
+/**
+ * Inserisce nella tabella condivisa le parole di una porzione del testo.
+ *
+ * @param argument La porzione (SharedRangeTask).
+ * @return NULL.
+ */
+void *tokenize_shared_range(void *argument);
+
+/**
+ * Inserisce nella tabella condivisa una parola del testo.
+ *
+ * @param task La porzione, che contiene la parola precedente (NULL all'inizio del testo) e la prima parola.
+ * @param writer Il thread che inserisce.
+ * @param token La parola.
+ * @param offset L'offset nel file del carattere successivo alla parola, che ne determina la posizione nel testo.
+ */
+void process_shared_token(SharedRangeTask *task, ConcurrentWriter *writer, Token *token, off_t offset);
+
+/**
+ * Inserisce nella tabella condivisa una coppia di parole, oppure la invia al thread proprietario della parola.
+ *
+ * @param task La porzione.
+ * @param writer Il thread che inserisce.
+ * @param word La parola.
+ * @param next_word La parola successiva.
+ * @param position La posizione della coppia nel testo.
+ */
+void insert_bigram(SharedRangeTask *task, ConcurrentWriter *writer, ConcurrentWord *word, ConcurrentWord *next_word, size_t position);
+
+/**
+ * Inserisce nella tabella condivisa le coppie di parole ricevute da un thread proprietario.
+ *
+ * @param argument Il thread proprietario (OwnerTask).
+ * @return NULL.
+ */
+void *aggregate_partition(void *argument);
+
+/**
+ * Collega l'ultima parola del testo alla prima e scrive la tabella condivisa su un file CSV.
+ *
+ * @param word_frequencies La tabella condivisa.
+ * @param range_tasks Le porzioni del testo.
+ * @param ranges Il numero di porzioni.
+ * @param file_size La dimensione del file.
+ * @param output_file Il file di output.
+ */
+void write_shared_table(ConcurrentHashMap *word_frequencies, SharedRangeTask *range_tasks, int ranges, off_t file_size, FILE *output_file);
+
+/**
+ * Scrive la tabella condivisa su un file CSV.
+ *
+ * @param word_frequencies La tabella delle frequenze da stampare.
+ * @param output_file Il file su cui stampare la tabella delle frequenze.
+ */
+void concurrent_hashmap_to_csv(ConcurrentHashMap *word_frequencies, FILE *output_file);
+
+/**
+ * Converte un file di testo in una tabella di frequenze suddividendolo tra più thread che inseriscono in una tabella condivisa.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param threads Il numero di thread.
+ */
+void tabulate_shared(HashMap *word_frequencies, FILE *input_file, FILE *output_file, int threads);
+
+/**
+ * Converte un file di testo in una tabella di frequenze suddividendolo tra thread che leggono il testo e thread proprietari delle parole.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param threads Il numero di thread che leggono il testo (e di thread proprietari, al massimo uno per porzione).
+ */
+void tabulate_shuffle(HashMap *word_frequencies, FILE *input_file, FILE *output_file, int threads);
+
+/**
+ * Converte un file di testo in una tabella di frequenze ordinando le coppie di parole invece di inserirle in una hashmap.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param threads Il numero di thread.
+ */
+void tabulate_sort(HashMap *word_frequencies, FILE *input_file, FILE *output_file, int threads);
+
+/**
+ * Scrive su un file CSV la tabella delle frequenze ottenuta dalle coppie di parole ordinate.
+ *
+ * @param words Le parole indicizzate per identificativo.
+ * @param records Le coppie ordinate (vengono deallocate).
+ * @param size Il numero di coppie.
+ * @param output_file Il file di output.
+ */
+void sorted_bigrams_to_csv(ConcurrentWord **words, BigramRecord *records, size_t size, FILE *output_file);
+
+/**
+ * Confronta due parole in base alla loro prima occorrenza nel testo.
+ *
+ * @param first La prima parola (BigramGroup).
+ * @param second La seconda parola (BigramGroup).
+ * @return Un numero negativo, nullo o positivo se la prima parola precede, coincide o segue la seconda.
+ */
+int compare_groups(const void *first, const void *second);
+
+/**
+ * Confronta due coppie distinte in ordine inverso di prima occorrenza nel testo.
+ *
+ * @param first La prima coppia (BigramRun).
+ * @param second La seconda coppia (BigramRun).
+ * @return Un numero negativo, nullo o positivo se la prima coppia precede, coincide o segue la seconda.
+ */
+int compare_runs(const void *first, const void *second);
+
+/**
+ * Converte un file di testo in una tabella di frequenze usando al massimo una quantità di memoria indicata.
+ *
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param max_memory La memoria massima in byte.
+ */
+void tabulate_external(FILE *input_file, FILE *output_file, size_t max_memory);
+
+/**
+ * Processa il testo letto da un lettore, scrivendo la tabella su disco quando supera la memoria massima.
+ *
+ * @param table La tabella.
+ * @param reader Il lettore del testo.
+ */
+void process_external_input(ExternalTable *table, Reader *reader);
+
+/**
+ * Scrive su disco la tabella corrente come run e la sostituisce con una tabella vuota.
+ *
+ * @param table La tabella.
+ */
+void spill_table(ExternalTable *table);
+
+/**
+ * Unisce i run di una tabella scritta su disco e scrive la tabella delle frequenze su un file CSV.
+ *
+ * @param table La tabella.
+ * @param output_file Il file di output.
+ */
+void merge_spilled_runs(ExternalTable *table, FILE *output_file);
+
+/**
+ * Aggiunge a un buffer la riga di una parola ottenuta dall'unione dei run.
+ *
+ * @param group La parola con le sue parole successive.
+ * @param lines Il buffer delle righe.
+ */
+void buffer_group(MergedGroup *group, LineBuffer *lines);
+
+/**
+ * Aggiunge del testo alla riga in corso di un buffer, ingrandendolo se necessario.
+ *
+ * @param lines Il buffer delle righe.
+ * @param text Il testo.
+ * @param length La lunghezza del testo.
+ */
+void append_line_text(LineBuffer *lines, char *text, size_t length);
+
+/**
+ * Termina la riga in corso di un buffer; se il buffer supera la memoria massima, le righe vengono scritte in un run.
+ *
+ * @param lines Il buffer delle righe.
+ * @param order L'ordine della riga.
+ */
+void end_line(LineBuffer *lines, size_t order);
+
+/**
+ * Scrive le righe di un buffer in ordine di riga e svuota il buffer.
+ *
+ * @param lines Il buffer delle righe.
+ * @param file Il file su cui scrivere.
+ * @param run Indica se scrivere le righe come run (con il loro ordine) invece che come testo.
+ */
+void flush_lines(LineBuffer *lines, FILE *file, bool run);
+
+/**
+ * Confronta due entry scritte su disco in base alla parola.
+ *
+ * @param first La prima entry (SpilledEntry).
+ * @param second La seconda entry (SpilledEntry).
+ * @return Un numero negativo, nullo o positivo se la prima entry precede, coincide o segue la seconda.
+ */
+int compare_spilled_entries(const void *first, const void *second);
+
+/**
+ * Confronta due nodi scritti su disco in base alla parola successiva.
+ *
+ * @param first Il primo nodo (SpilledNode).
+ * @param second Il secondo nodo (SpilledNode).
+ * @return Un numero negativo, nullo o positivo se il primo nodo precede, coincide o segue il secondo.
+ */
+int compare_spilled_nodes(const void *first, const void *second);
+
+/**
+ * Confronta due parole successive in ordine inverso di prima occorrenza nel testo.
+ *
+ * @param first La prima parola successiva (MergedSuccessor).
+ * @param second La seconda parola successiva (MergedSuccessor).
+ * @return Un numero negativo, nullo o positivo se la prima parola precede, coincide o segue la seconda.
+ */
+int compare_merged_successors(const void *first, const void *second);
+
+/**
+ * Confronta due righe in base al loro ordine.
+ *
+ * @param first La prima riga (BufferedLine).
+ * @param second La seconda riga (BufferedLine).
+ * @return Un numero negativo, nullo o positivo se la prima riga precede, coincide o segue la seconda.
+ */
+int compare_buffered_lines(const void *first, const void *second);
+
 /**
  * Converte un file di testo in una tabella di frequenze.
  *
  * @param input_file Il file di input.
  * @param output_file Il file di output.
  * @param multiprocess_mode La modalità multiprocessore.
+ * @param shared_memory_mode Indica se trasferire il testo su un ring buffer in memoria condivisa invece che su una pipe.
+ * @param jobs Il numero di processi tra cui suddividere il testo.
+ * @param threads Il numero di thread tra cui suddividere il testo.
+ * @param engine Il motore della modalità a più thread.
+ * @param max_memory La memoria massima in byte per la tabella (0 se non è limitata).
  */
-void tabulate(FILE *input_file, FILE *output_file, bool multiprocess_mode) {
+void tabulate(FILE *input_file, FILE *output_file, bool multiprocess_mode, bool shared_memory_mode, int jobs, int threads, TabulateEngine engine, size_t max_memory) {
     // Creazione della hashmap
     HashMap *word_frequencies = hashmap_create();
 
-    if (multiprocess_mode) {
+    if (max_memory > 0) {
+        // Modalità a singolo processo con la tabella scritta su disco quando supera la memoria massima
+        tabulate_external(input_file, output_file, max_memory);
+    } else if (engine == ENGINE_SHARED) {
+        // Modalità a più thread con una tabella condivisa
+        tabulate_shared(word_frequencies, input_file, output_file, threads);
+    } else if (engine == ENGINE_SHUFFLE) {
+        // Modalità a più thread con le coppie di parole inviate ai thread proprietari
+        tabulate_shuffle(word_frequencies, input_file, output_file, threads);
+    } else if (engine == ENGINE_SORT) {
+        // Modalità a più thread con le coppie di parole ordinate
+        tabulate_sort(word_frequencies, input_file, output_file, threads);
+    } else if (threads > 1) {
+        // Modalità a più thread con suddivisione del testo
+        tabulate_threaded(word_frequencies, input_file, output_file, threads);
+    } else if (jobs > 1) {
+        // Modalità a più processi con suddivisione del testo
+        tabulate_parallel(word_frequencies, input_file, output_file, jobs);
+    } else if (multiprocess_mode) {
         // Modalità multiprocess
 
         // Creazione della pipe (pipe_fd[0] per la lettura del file di input, pipe_fd[1] per la scrittura su file di output)
-        int pipe_fd[2][2];
-        if (pipe(pipe_fd[0]) == -1 || pipe(pipe_fd[1]) == - 1) error_handler(ERR_PARALLELIZATION);
+        int pipe_fd[2][2] = { { -1, -1 }, { -1, -1 } };
+        pipe_open(pipe_fd[1]);
+
+        // La hashmap viene costruita in una regione condivisa, sulla pipe di scrittura viene solo notificato che è pronta
+        int table_fd = region_create_file();
+
+        // Il file di input viene trasferito su un ring buffer in memoria condivisa oppure sulla pipe
+        RingBuffer *ring = NULL;
+        if (shared_memory_mode) {
+            ring = ring_create(RING_CAPACITY);
+        } else {
+            pipe_open(pipe_fd[0]);
+        }
 
         // Creazione di un processo per la lettura del testo
         pid_t read_pid = fork();
@@ -94,7 +643,7 @@ void tabulate(FILE *input_file, FILE *output_file, bool multiprocess_mode) {
             close(pipe_fd[1][1]);
 
             // Lettura del testo e scrittura sulla pipe
-            read_text(input_file, pipe_fd[0]);
+            read_text(input_file, pipe_fd[0], ring);
 
             // Fine del processo di lettura
             exit(EXIT_SUCCESS);
@@ -108,34 +657,18 @@ void tabulate(FILE *input_file, FILE *output_file, bool multiprocess_mode) {
             // Chisura del lato di lettura della pipe di scrittura su file di output
             close(pipe_fd[1][0]);
 
-            // Processamento del testo
-            process_text(word_frequencies, pipe_fd[0]);
-
-            // Conversione della hashmap in un buffer
-            wchar_t *buffer = hashmap_serialize(word_frequencies);
-
-            // Dimensione del buffer
-            size_t buffer_size = sizeof(wchar_t) * (wcslen(buffer) + 1);
-
-            // Scrittura della dimensione del buffer sulla pipe
-            write(pipe_fd[1][1], &buffer_size, sizeof(buffer_size));
-            
-            // Totale dei byte scritti
-            ssize_t total = 0;
+            // Processamento del testo in una hashmap nella regione condivisa
+            hashmap_destroy(word_frequencies);
+            word_frequencies = hashmap_create_shared(table_fd);
+            process_text(word_frequencies, pipe_fd[0], ring);
 
-            // Continua a scrivere finché non ha scritto tutto il buffer
-            while (total < buffer_size) {
-                // Scrittura del buffer sulla pipe
-                ssize_t written_size = write(pipe_fd[1][1], buffer + total / sizeof(wchar_t), buffer_size - total);
-                if (written_size == -1) error_handler(ERR_PARALLELIZATION);
+            // Pubblicazione della hashmap, che il processo di scrittura legge direttamente dalla regione
+            hashmap_publish(word_frequencies);
 
-                // Viene incrementato il totale dei byte scritti
-                total += written_size;
-            }
+            // Notifica della dimensione della regione sulla pipe
+            size_t table_size = region_header(word_frequencies->region)->size;
+            pipe_write(pipe_fd[1][1], &table_size, sizeof(table_size));
 
-            // Deallocazione del buffer
-            free(buffer);
-            
             // Chisura del lato di scrittura della pipe di scrittura su file di output
             close(pipe_fd[1][1]);
 
@@ -146,8 +679,10 @@ void tabulate(FILE *input_file, FILE *output_file, bool multiprocess_mode) {
         }
 
         // Chiusura dei file descriptor della pipe di lettura del file di input
-        close(pipe_fd[0][0]);
-        close(pipe_fd[0][1]);
+        if (!ring) {
+            close(pipe_fd[0][0]);
+            close(pipe_fd[0][1]);
+        }
 
         // Creazione di un processo per la scrittura della tabella delle frequenze
         pid_t write_pid = fork();
@@ -155,34 +690,13 @@ void tabulate(FILE *input_file, FILE *output_file, bool multiprocess_mode) {
             // Chisura del lato di scrittura della pipe di scrittura su file di output
             close(pipe_fd[1][1]);
 
-            // Dimensione del buffer
-            size_t buffer_size;
-
-            // Lettura della dimensione del buffer dalla pipe
-            read(pipe_fd[1][0], &buffer_size, sizeof(buffer_size));
-
-            // Allocazione del buffer
-            wchar_t *buffer = malloc(buffer_size);
-            if (!buffer) error_handler(ERR_MEMORY_ALLOCATION);
-            
-            // Totale dei byte letti
-            ssize_t total = 0;
-
-            // Continua a leggere finché non ha letto tutto il buffer
-            while (total < buffer_size) {
-                // Scrittura del buffer sulla pipe
-                ssize_t read_size = read(pipe_fd[1][0], buffer + total / sizeof(wchar_t), buffer_size - total);
-                if (read_size == -1) error_handler(ERR_PARALLELIZATION);
+            // Attesa della notifica dalla pipe (se manca, il processo di processamento è terminato con un errore)
+            size_t table_size;
+            if (!pipe_read(pipe_fd[1][0], &table_size, sizeof(table_size))) exit(EXIT_FAILURE);
 
-                // Viene incrementato il totale dei byte letti
-                total += read_size;
-            }
-
-            // Conversione del buffer in una hashmap
-            hashmap_deserialize(word_frequencies, buffer);
-            
-            // Deallocazione del buffer
-            free(buffer);
+            // Apertura della hashmap costruita dal processo di processamento, senza copiarla
+            hashmap_destroy(word_frequencies);
+            word_frequencies = hashmap_open(table_fd);
 
             // Scrittura della hashmap su file di output
             hashmap_to_csv(word_frequencies, output_file);
@@ -200,20 +714,14 @@ void tabulate(FILE *input_file, FILE *output_file, bool multiprocess_mode) {
         close(pipe_fd[1][0]);
         close(pipe_fd[1][1]);
 
-        // Status dei processi
-        int status;
-        
-        // Attesa del processo di lettura
-        waitpid(read_pid, &status, 0);
-        if (WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS) exit(EXIT_FAILURE);
+        // Attesa dei processi di lettura, processamento e scrittura
+        pipe_wait_processes((pid_t[]){ read_pid, process_pid, write_pid }, 3);
 
-        // Attesa del processo di processamento
-        waitpid(process_pid, &status, 0);
-        if (WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS) exit(EXIT_FAILURE);
+        // Rimozione del ring buffer
+        if (ring) ring_destroy(ring);
 
-        // Attesa del processo di scrittura
-        waitpid(write_pid, &status, 0);
-        if (WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS) exit(EXIT_FAILURE);
+        // Chiusura del file della regione condivisa
+        close(table_fd);
     } else {
         // Modalità single process
         tabulate_single_process(word_frequencies, input_file, output_file);
@@ -224,189 +732,1639 @@ void tabulate(FILE *input_file, FILE *output_file, bool multiprocess_mode) {
 }
 
 /**
- * Verifica se un carattere è una punteggiatura non valida.
+ * Scrive una tabella di frequenze su un file CSV.
  *
- * @param character Il carattere da verificare.
- * @return true se il carattere è una punteggiatura non valida, false altrimenti.
+ * @param word_frequencies La tabella delle frequenze da stampare.
+ * @param output_file Il file su cui stampare la tabella delle frequenze.
  */
-bool is_invalid_punctuation(wchar_t character) {
-    // Array dei segni di punteggiatura
-    const wchar_t punctation[] = {L',', L';', L':', L'-', L'(', L')', L'[', L']', L'{', L'}', L'<', L'>', L'"', L'/', L'\\', L'|', L'@', L'#', L'$', L'%', L'^', L'&', L'*', L'_', L'+', L'=', L'~', L'`'};
-
-    // Scorre l'array
-    for (int i = 0; i < sizeof(punctation) / sizeof(wchar_t); i++) {
-        // Se il carattere è un segno di punteggiatura, restituisce true
-        if (character == punctation[i]) return true;
+void hashmap_to_csv(HashMap *word_frequencies, FILE *output_file) {
+    // Scorre le entry in ordine di inserimento (l'ordine non dipende dalla disposizione della tabella)
+    for (Entry *entry = hashmap_entry(word_frequencies, word_frequencies->first); entry; entry = hashmap_entry(word_frequencies, entry->next_inserted)) {
+        entry_to_csv(word_frequencies, entry, output_file);
     }
-
-    // Altrimenti restituisce false
-    return false;
 }
 
 /**
- * Processa un carattere.
+ * Scrive la riga di un'entry della tabella delle frequenze su un file CSV.
  *
  * @param word_frequencies La tabella delle frequenze.
- * @param character Il carattere da processare.
- * @param previous_word La parola precedente.
- * @param current_word La parola corrente.
- * @param index L'indice della parola corrente.
- * @param first_word La prima parola del testo.
- */
-void process_character(HashMap *word_frequencies, wchar_t character, wchar_t *previous_word, wchar_t *current_word, int *index, wchar_t *first_word) {
-    // Controllo della lunghezza massima della parola
-    if (*index == MAX_WORD_LENGTH) error_handler(ERR_INVALID_TEXT);
-
-    if (*index != 0 && (iswblank(character) || character == '\'' || character == '.' || character == '?' || character == '!' || character == '\n' || character == '\0')) {
-        // Se la parola corrente è un'apostrofo, viene concatenata alla parola precedente
-        if (character == '\'') current_word[(*index)++] = character;
-        
-        // Terminazione della parola corrente
-        current_word[*index] = '\0';
-
-        // Se la parola precedente è non è vuota allora viene effettuato l'inserimento, altrimenti la imposta (e imposta la prima parola come la parola corrente)
-        if (wcscmp(previous_word, L"") != 0) {
-            // Inserimento della parola corrente nella tabella delle frequenze
-            hashmap_insert(word_frequencies, previous_word, current_word);
-
-            // Se il carattere è un segno di punteggiatura, viene inserito nella tabella delle frequenze
-            if (character == '.' || character == '?' || character == '!') {
-                wcscpy(previous_word, (wchar_t[]){ character, '\0' });
-                hashmap_insert(word_frequencies, current_word, previous_word);
-            } else {
-                wcscpy(previous_word, current_word);
-            }
-        } else {
-            wcscpy(previous_word, current_word);
-            wcscpy(first_word, current_word);
-        }
+ * @param entry L'entry da stampare.
+ * @param output_file Il file su cui stampare la riga.
+ */
+void entry_to_csv(HashMap *word_frequencies, Entry *entry, FILE *output_file) {
+    // Stampa nel file la parola relativa all'entry
+    fputs(hashmap_word(word_frequencies, entry->word), output_file);
+
+    Node *node = hashmap_node(word_frequencies, entry->next_words);
 
-        *index = 0;
-    } else if (!(is_invalid_punctuation(character) || iswblank(character) || character == '\n' || character == '\0')) {
-        // Inserimento del carattere nella parola corrente
-        current_word[(*index)++] = towlower(character);
+    // Scorre i nodi
+    while (node) {
+        // Stampa nel file la parola successiva e la frequenza, calcolata dal numero di occorrenze
+        fprintf(output_file, ",%s,%.5f", hashmap_word(word_frequencies, node->next_word), (double)node->count / entry->count);
+
+        // Nodo successivo
+        node = hashmap_node(word_frequencies, node->next);
     }
+
+    // Stampa nel file un carattere di nuova riga
+    fputc('\n', output_file);
 }
 
-/**
- * Scrive una tabella di frequenze su un file CSV.
+/*
+ * Legge il testo da un file e lo scrive su un pipe.
  *
- * @param word_frequencies La tabella delle frequenze da stampare.
- * @param output_file Il file su cui stampare la tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param pipe_fd Il file descriptor del pipe.  
+ * @param ring Il ring buffer (NULL se il testo viene trasferito sulla pipe).
+*/
+void read_text(FILE *input_file, int pipe_fd[2], RingBuffer *ring) {
+    Reader *reader = reader_open(input_file);
+
+    if (ring) {
+        // Lettura dal file e scrittura sul ring buffer
+        ring_send(ring, reader);
+    } else {
+        // Chiusura del lato di lettura della pipe
+        close(pipe_fd[0]);
+
+        // Lettura dal file e scrittura sulla pipe a frame
+        pipe_send(pipe_fd[1], reader);
+
+        // Chiusura del lato di scrittura della pipe
+        close(pipe_fd[1]);
+    }
+
+    reader_close(reader);
+}
+
+/*
+ * Legge il testo da un pipe e lo processa.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param pipe_fd Il file descriptor del pipe.
+ * @param ring Il ring buffer (NULL se il testo viene trasferito sulla pipe).
+*/
+void process_text(HashMap *word_frequencies, int pipe_fd[2], RingBuffer *ring) {
+    // Chisura del lato di scrittura della pipe
+    if (!ring) close(pipe_fd[1]);
+
+    unsigned int previous_word = NO_WORD;
+    unsigned int first_word = NO_WORD;
+
+    // Lettura dal ring buffer o dei frame dalla pipe e processamento del testo
+    Reader *reader = ring ? reader_open_ring(ring) : reader_open_pipe(pipe_fd[0]);
+    process_input(word_frequencies, reader, &previous_word, &first_word, false);
+    reader_close(reader);
+
+    // L'ultima parola viene collegata alla prima
+    link_last_word(word_frequencies, previous_word, first_word);
+
+    // Chiusura del lato di lettura della pipe
+    if (!ring) close(pipe_fd[0]);
+}
+
+/**
+ * Converte un file di testo in una tabella di frequenze utilizzando un singolo processo.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
  */
-void hashmap_to_csv(HashMap *word_frequencies, FILE *output_file) {
-    // Scorre i bucket della hashmap
-    for (int i = 0; i < word_frequencies->size; i++) {
-        Entry *entry = word_frequencies->buckets[i];
+void tabulate_single_process(HashMap *word_frequencies, FILE *input_file, FILE *output_file) {
+    unsigned int previous_word = NO_WORD;
+    unsigned int first_word = NO_WORD;
 
-        // Scorre le entry
-        while (entry) {
-            // Stampa nel file la parola relativa all'entry
-            fwprintf(output_file, L"%ls", entry->word);
+    // Lettura dal file e processamento del testo
+    Reader *reader = reader_open(input_file);
+    process_input(word_frequencies, reader, &previous_word, &first_word, false);
+    reader_close(reader);
+
+    // L'ultima parola viene collegata alla prima
+    link_last_word(word_frequencies, previous_word, first_word);
+    
+    // Scrittura della tabella delle frequenze
+    hashmap_to_csv(word_frequencies, output_file);
+}
 
-            Node *node = entry->next_words;
+/**
+ * Cerca il confine di una porzione del testo a partire da un offset.
+ *
+ * @param input_file Il file di input.
+ * @param offset L'offset da cui iniziare la ricerca.
+ * @param file_size La dimensione del file.
+ * @param terminator Il terminatore trovato.
+ * @return L'offset del confine, oppure la dimensione del file se non viene trovato.
+ */
+off_t find_boundary(FILE *input_file, off_t offset, off_t file_size, char *terminator) {
+    // La lettura parte dal byte precedente, necessario per verificare che il terminatore chiuda una parola
+    off_t start = offset > 0 ? offset - 1 : 0;
 
-            // Scorre i nodi
-            while (node) {
-                // Stampa nel file la parola successiva e la frequenza
-                fwprintf(output_file, L",%ls,%.5f", node->next_word, node->frequency);
+    Reader *reader = reader_open_range(input_file, start, file_size);
 
-                // Nodo successivo
-                node = node->next;
-            }
+    char *data;
+    size_t size = reader_read(reader, &data);
 
-            // Stampa nel file un carattere di nuova riga
-            fwprintf(output_file, L"\n");
-            
-            // Entry successiva
-            entry = entry->next;
+    // Confine trovato
+    off_t boundary = file_size;
+
+    for (size_t i = offset - start; i < size; i++) {
+        unsigned char character = data[i];
+        unsigned char previous = i > 0 ? data[i - 1] : '\0';
+
+        // Il terminatore deve chiudere una parola (i byte ASCII non fanno mai parte di sequenze multibyte)
+        if ((character == '.' || character == '?' || character == '!') && previous < 0x80 && isalnum(previous)) {
+            *terminator = character;
+            boundary = start + i + 1;
+            break;
         }
     }
+
+    reader_close(reader);
+
+    return boundary;
 }
 
-/*
- * Legge il testo da un file e lo scrive su un pipe.
+/**
+ * Cerca la fine della prima parola del testo.
  *
  * @param input_file Il file di input.
- * @param pipe_fd Il file descriptor del pipe.  
-*/
-void read_text(FILE *input_file, int pipe_fd[2]) {
-    // Chiusura del lato di lettura della pipe
-    close(pipe_fd[0]);
+ * @param file_size La dimensione del file.
+ * @return L'offset del carattere successivo alla prima parola.
+ */
+off_t find_first_word_end(FILE *input_file, off_t file_size) {
+    // Finché la parola precedente è vuota la tabella non viene modificata
+    HashMap *word_frequencies = hashmap_create();
 
-    wchar_t character;
+    unsigned int previous_word = NO_WORD;
+    unsigned int first_word = NO_WORD;
 
-    // Lettura dal file e scrittura sulla pipe
-    while ((character = fgetwc(input_file)) != WEOF) {
-        write(pipe_fd[1], &character, sizeof(character));
-    }
+    Reader *reader = reader_open_range(input_file, 0, file_size);
+    off_t offset = process_input(word_frequencies, reader, &previous_word, &first_word, true);
+    reader_close(reader);
 
-    // Ultima iterazione (poiché WEOF non viene processato dal ciclo while )
-    character = L'\0';
-    write(pipe_fd[1], &character, sizeof(character));
+    hashmap_destroy(word_frequencies);
 
-    // Chiusura del lato di scrittura della pipe
-    close(pipe_fd[1]);
+    return offset;
 }
 
-/*
- * Legge il testo da un pipe e lo processa.
+/**
+ * Processa il testo letto da un lettore.
  *
  * @param word_frequencies La tabella delle frequenze.
- * @param pipe_fd Il file descriptor del pipe.
-*/
-void process_text(HashMap *word_frequencies, int pipe_fd[2]) {
-    // Chisura del lato di scrittura della pipe
-    close(pipe_fd[1]);
+ * @param reader Il lettore del testo.
+ * @param previous_word L'identificativo della parola precedente (NO_WORD all'inizio del testo).
+ * @param first_word L'identificativo della prima parola del testo.
+ * @param first_word_only Indica se fermarsi dopo aver letto la prima parola.
+ * @return Il numero di byte processati.
+ */
+off_t process_input(HashMap *word_frequencies, Reader *reader, unsigned int *previous_word, unsigned int *first_word, bool first_word_only) {
+    Tokenizer *tokenizer = tokenizer_create();
+
+    // Numero di byte processati
+    off_t total = 0;
+
+    char *block;
+    size_t size;
+
+    // Il lettore restituisce blocchi che non dividono mai un carattere
+    while ((size = reader_read(reader, &block)) > 0) {
+        size_t offset = 0;
+
+        while (offset < size) {
+            // Il blocco viene scansionato un gruppo di parole alla volta
+            size_t start = offset;
+            offset += tokenizer_scan(tokenizer, (unsigned char *)block + offset, size - offset);
+
+            // Le parole del gruppo vengono inserite nella tabella
+            for (size_t i = 0; i < tokenizer->count; i++) {
+                process_token(word_frequencies, &tokenizer->tokens[i], previous_word, first_word);
+
+                // Se richiesto, si ferma dopo la prima parola
+                if (first_word_only) {
+                    off_t end = total + start + tokenizer->tokens[i].end;
+                    tokenizer_destroy(tokenizer);
+                    return end;
+                }
+            }
+
+            tokenizer_clear(tokenizer);
+        }
 
-    wchar_t previous_word[MAX_WORD_LENGTH] = L"";
-    wchar_t current_word[MAX_WORD_LENGTH];
+        total += size;
+    }
+
+    // Ultima parola
+    tokenizer_finish(tokenizer);
+    if (tokenizer->count > 0) process_token(word_frequencies, &tokenizer->tokens[0], previous_word, first_word);
 
-    wchar_t first_word[MAX_WORD_LENGTH];
+    tokenizer_destroy(tokenizer);
 
-    wchar_t character;
-    int index = 0;
+    return total;
+}
 
-    // Lettura dalla pipe e processamento del testo
-    while (read(pipe_fd[0], &character, sizeof(character)) > 0) {
-        process_character(word_frequencies, character, previous_word, current_word, &index, first_word);
+/**
+ * Inserisce nella tabella delle frequenze una parola del testo.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param token La parola.
+ * @param previous_word L'identificativo della parola precedente (NO_WORD all'inizio del testo).
+ * @param first_word L'identificativo della prima parola del testo.
+ */
+void process_token(HashMap *word_frequencies, Token *token, unsigned int *previous_word, unsigned int *first_word) {
+    // La parola viene cercata una sola volta, poi viene usato il suo identificativo
+    unsigned int word = hashmap_intern(word_frequencies, token->word);
+
+    // Se la parola precedente è vuota la imposta (e imposta la prima parola come la parola corrente)
+    if (*previous_word == NO_WORD) {
+        *previous_word = word;
+        *first_word = word;
+        return;
     }
 
-    // L'ultima parola viene collegata alla prima
-    hashmap_insert(word_frequencies, previous_word, first_word);
+    // Inserimento della parola corrente nella tabella delle frequenze
+    hashmap_insert_ids(word_frequencies, *previous_word, word);
 
-    // Chiusura del lato di lettura della pipe
-    close(pipe_fd[0]);
+    // Se la parola termina con un segno di punteggiatura, viene inserito nella tabella delle frequenze
+    if (token->terminator) {
+        *previous_word = hashmap_intern(word_frequencies, (char[]){ token->terminator, '\0' });
+        hashmap_insert_ids(word_frequencies, word, *previous_word);
+    } else {
+        *previous_word = word;
+    }
 }
 
 /**
- * Converte un file di testo in una tabella di frequenze utilizzando un singolo processo.
+ * Collega l'ultima parola del testo alla prima.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param previous_word L'identificativo dell'ultima parola (NO_WORD se il testo non contiene parole).
+ * @param first_word L'identificativo della prima parola.
+ */
+void link_last_word(HashMap *word_frequencies, unsigned int previous_word, unsigned int first_word) {
+    // Se il testo non contiene parole, viene collegata la parola vuota a se stessa
+    if (previous_word == NO_WORD) previous_word = first_word = hashmap_intern(word_frequencies, "");
+
+    hashmap_insert_ids(word_frequencies, previous_word, first_word);
+}
+
+/**
+ * Converte un file di testo in una tabella di frequenze suddividendolo tra più processi.
+ *
+ * Ogni processo elabora una porzione del testo che termina con un terminatore di frase in una
+ * propria hashmap; le hashmap vengono unite nell'ordine delle porzioni, ottenendo la stessa
+ * tabella della modalità a singolo processo.
  *
  * @param word_frequencies La tabella delle frequenze.
  * @param input_file Il file di input.
  * @param output_file Il file di output.
+ * @param jobs Il numero di processi.
  */
-void tabulate_single_process(HashMap *word_frequencies, FILE *input_file, FILE *output_file) {
-    wchar_t previous_word[MAX_WORD_LENGTH] = L"";
-    wchar_t current_word[MAX_WORD_LENGTH];
+void tabulate_parallel(HashMap *word_frequencies, FILE *input_file, FILE *output_file, int jobs) {
+    // Confini delle porzioni e terminatori che le precedono
+    off_t *boundaries;
+    char *terminators;
+
+    int ranges = split_text(input_file, jobs, &boundaries, &terminators);
+
+    // Se il file non può essere suddiviso viene elaborato da un singolo processo
+    if (ranges == 0) {
+        tabulate_single_process(word_frequencies, input_file, output_file);
+        return;
+    }
 
-    wchar_t first_word[MAX_WORD_LENGTH];
+    // Pipe e processi delle porzioni
+    int (*pipe_fd)[2] = malloc(ranges * sizeof(*pipe_fd));
+    pid_t *pids = (pid_t *)malloc(ranges * sizeof(pid_t));
+    if (!pipe_fd || !pids) error_handler(ERR_MEMORY_ALLOCATION);
 
-    wchar_t character;
-    int index = 0;
+    for (int i = 0; i < ranges; i++) {
+        pipe_open(pipe_fd[i]);
 
-    // Lettura dal file e processamento del testo
-    while((character = fgetwc(input_file)) != WEOF) {
-        process_character(word_frequencies, character, previous_word, current_word, &index, first_word);
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            // Chiusura del lato di lettura della pipe
+            close(pipe_fd[i][0]);
+
+            // La prima porzione inizia senza parola precedente, le altre dopo un terminatore
+            unsigned int previous_id = i > 0 ? hashmap_intern(word_frequencies, (char[]){ terminators[i], '\0' }) : NO_WORD;
+            unsigned int first_id = NO_WORD;
+
+            // Processamento della porzione
+            Reader *reader = reader_open_range(input_file, boundaries[i], boundaries[i + 1]);
+            process_input(word_frequencies, reader, &previous_id, &first_id, false);
+            reader_close(reader);
+
+            // Testo dell'ultima e della prima parola (vuoto se assenti)
+            char previous_word[MAX_WORD_BYTES] = "";
+            char first_word[MAX_WORD_BYTES] = "";
+            if (previous_id != NO_WORD) strcpy(previous_word, hashmap_word(word_frequencies, previous_id));
+            if (first_id != NO_WORD) strcpy(first_word, hashmap_word(word_frequencies, first_id));
+
+            // Conversione della hashmap in un buffer
+            size_t buffer_size;
+            char *buffer = hashmap_serialize(word_frequencies, &buffer_size);
+
+            // Scrittura dell'ultima parola, della prima parola e della hashmap sulla pipe
+            pipe_write(pipe_fd[i][1], previous_word, sizeof(previous_word));
+            pipe_write(pipe_fd[i][1], first_word, sizeof(first_word));
+            pipe_write(pipe_fd[i][1], &buffer_size, sizeof(buffer_size));
+            pipe_write(pipe_fd[i][1], buffer, buffer_size);
+
+            // Deallocazione del buffer
+            free(buffer);
+
+            // Chiusura del lato di scrittura della pipe
+            close(pipe_fd[i][1]);
+
+            // Fine del processo
+            exit(EXIT_SUCCESS);
+        } else if (pids[i] == -1) {
+            error_handler(ERR_PARALLELIZATION);
+        }
+
+        // Chiusura del lato di scrittura della pipe
+        close(pipe_fd[i][1]);
     }
 
-    // Ultima iterazione (poiché WEOF non viene processato dal ciclo while )
-    character = L'\0';
-    process_character(word_frequencies, character, previous_word, current_word, &index, first_word);
+    char previous_word[MAX_WORD_BYTES];
+    char first_word[MAX_WORD_BYTES];
+
+    // Status dei processi
+    int status;
+
+    // Unione delle hashmap nell'ordine delle porzioni
+    for (int i = 0; i < ranges; i++) {
+        // Prima parola del testo (significativa solo per la prima porzione)
+        char range_first_word[MAX_WORD_BYTES];
+
+        // Dimensione del buffer
+        size_t buffer_size;
+
+        // Se il processo termina senza scrivere il risultato, viene propagato l'errore
+        if (!pipe_read(pipe_fd[i][0], previous_word, sizeof(previous_word)) ||
+            !pipe_read(pipe_fd[i][0], range_first_word, sizeof(range_first_word)) ||
+            !pipe_read(pipe_fd[i][0], &buffer_size, sizeof(buffer_size))) {
+            waitpid(pids[i], &status, 0);
+            exit(EXIT_FAILURE);
+        }
+
+        if (i == 0) strcpy(first_word, range_first_word);
+
+        // Allocazione del buffer
+        char *buffer = malloc(buffer_size);
+        if (!buffer) error_handler(ERR_MEMORY_ALLOCATION);
+
+        if (!pipe_read(pipe_fd[i][0], buffer, buffer_size)) error_handler(ERR_PARALLELIZATION);
+
+        // La prima hashmap viene caricata direttamente, le altre vengono unite
+        if (i == 0) {
+            hashmap_deserialize(word_frequencies, buffer, buffer_size);
+        } else {
+            HashMap *range_frequencies = hashmap_create();
+            hashmap_deserialize(range_frequencies, buffer, buffer_size);
+            hashmap_merge(word_frequencies, range_frequencies);
+            hashmap_destroy(range_frequencies);
+        }
+
+        // Deallocazione del buffer
+        free(buffer);
+
+        // Chiusura del lato di lettura della pipe
+        close(pipe_fd[i][0]);
+
+        // Attesa del processo
+        waitpid(pids[i], &status, 0);
+        if (WIFEXITED(status) && WEXITSTATUS(status) != EXIT_SUCCESS) exit(EXIT_FAILURE);
+    }
 
     // L'ultima parola viene collegata alla prima
     hashmap_insert(word_frequencies, previous_word, first_word);
-    
+
     // Scrittura della tabella delle frequenze
     hashmap_to_csv(word_frequencies, output_file);
+    free(pipe_fd);
+    free(pids);
+    free(boundaries);
+    free(terminators);
+}
+
+/**
+ * Suddivide un file di testo in porzioni che terminano con un terminatore di frase.
+ *
+ * @param input_file Il file di input.
+ * @param parts Il numero massimo di porzioni.
+ * @param boundaries Restituisce i confini delle porzioni (porzioni + 1 elementi, l'ultimo è la dimensione del file; da deallocare, NULL se il file non può essere suddiviso).
+ * @param terminators Restituisce i terminatori che precedono le porzioni (da deallocare, NULL se il file non può essere suddiviso).
+ * @return Il numero di porzioni non vuote, 0 se il file non è regolare o è vuoto e non può essere suddiviso.
+ */
+int split_text(FILE *input_file, int parts, off_t **boundaries, char **terminators) {
+    *boundaries = NULL;
+    *terminators = NULL;
+
+    // Se il file non è regolare o è vuoto non può essere suddiviso
+    struct stat file_stat;
+    if (fstat(fileno(input_file), &file_stat) == -1 || !S_ISREG(file_stat.st_mode) || file_stat.st_size == 0) return 0;
+
+    off_t file_size = file_stat.st_size;
+
+    // Ogni porzione contiene almeno un byte
+    if (parts > file_size) parts = file_size;
+
+    // Allocazione dei confini e dei terminatori
+    off_t *range_boundaries = (off_t *)malloc((parts + 1) * sizeof(off_t));
+    char *range_terminators = (char *)malloc(parts * sizeof(char));
+    if (!range_boundaries || !range_terminators) error_handler(ERR_MEMORY_ALLOCATION);
+
+    *boundaries = range_boundaries;
+    *terminators = range_terminators;
+
+    // Numero di porzioni non vuote
+    int ranges = 1;
+    range_boundaries[0] = 0;
+
+    // Nessun confine può precedere la fine della prima parola
+    off_t first_word_end = find_first_word_end(input_file, file_size);
+
+    for (int i = 1; i < parts; i++) {
+        // Il confine viene cercato a partire dalla suddivisione in parti uguali
+        off_t offset = file_size / parts * i;
+        if (offset < range_boundaries[ranges - 1]) offset = range_boundaries[ranges - 1];
+        if (offset < first_word_end) offset = first_word_end;
+
+        off_t boundary = find_boundary(input_file, offset, file_size, &range_terminators[ranges]);
+
+        // Le porzioni vuote vengono scartate
+        if (boundary == file_size) break;
+
+        range_boundaries[ranges++] = boundary;
+    }
+
+    range_boundaries[ranges] = file_size;
+
+    return ranges;
+}
+
+/**
+ * Costruisce la tabella di una porzione del testo e ne suddivide le entry tra le partizioni.
+ *
+ * @param argument La porzione (RangeTask).
+ * @return NULL.
+ */
+void *tokenize_range(void *argument) {
+    RangeTask *task = (RangeTask *)argument;
+
+    // La prima porzione inizia senza parola precedente, le altre dopo un terminatore
+    task->word_frequencies = hashmap_create();
+    task->previous_word = task->terminator ? hashmap_intern(task->word_frequencies, (char[]){ task->terminator, '\0' }) : NO_WORD;
+    task->first_word = NO_WORD;
+
+    // Processamento della porzione
+    Reader *reader = reader_open_range(task->input_file, task->start, task->end);
+    process_input(task->word_frequencies, reader, &task->previous_word, &task->first_word, false);
+    reader_close(reader);
+
+    HashMap *map = task->word_frequencies;
+
+    // Partizione di ogni entry, calcolata una sola volta dall'hash della parola
+    int *entry_partitions = (int *)malloc((map->usage + 1) * sizeof(int));
+    if (!entry_partitions) error_handler(ERR_MEMORY_ALLOCATION);
+
+    for (int i = 0; i < task->partition_count; i++) task->partition_sizes[i] = 0;
+
+    size_t index = 0;
+    for (Entry *entry = hashmap_entry(map, map->first); entry; entry = hashmap_entry(map, entry->next_inserted)) {
+        entry_partitions[index] = hash(hashmap_word(map, entry->word)) % task->partition_count;
+        task->partition_sizes[entry_partitions[index++]]++;
+    }
+
+    // Allocazione delle partizioni
+    for (int i = 0; i < task->partition_count; i++) {
+        task->partitions[i] = (PartitionItem *)malloc((task->partition_sizes[i] + 1) * sizeof(PartitionItem));
+        if (!task->partitions[i]) error_handler(ERR_MEMORY_ALLOCATION);
+
+        task->partition_sizes[i] = 0;
+    }
+
+    // Le entry vengono assegnate alle partizioni in ordine di inserimento
+    index = 0;
+    for (size_t offset = map->first; offset; offset = hashmap_entry(map, offset)->next_inserted) {
+        int partition = entry_partitions[index];
+        task->partitions[partition][task->partition_sizes[partition]++] = (PartitionItem){ offset, index };
+        index++;
+    }
+
+    free(entry_partitions);
+
+    return NULL;
+}
+
+/**
+ * Unisce le entry di una partizione di tutte le porzioni nella tabella della partizione.
+ *
+ * @param argument La partizione (PartitionTask).
+ * @return NULL.
+ */
+void *merge_partition(void *argument) {
+    PartitionTask *task = (PartitionTask *)argument;
+
+    // Numero massimo di entry della partizione (più l'eventuale collegamento dell'ultima parola alla prima)
+    size_t capacity = 1;
+    for (int i = 0; i < task->range_count; i++) capacity += task->ranges[i].partition_sizes[task->partition];
+
+    task->word_frequencies = hashmap_create();
+    task->orders = (size_t *)malloc(capacity * sizeof(size_t));
+    if (!task->orders) error_handler(ERR_MEMORY_ALLOCATION);
+
+    HashMap *map = task->word_frequencies;
+
+    // Le porzioni vengono unite nel loro ordine, in modo che il risultato coincida con quello a singolo processo
+    for (int i = 0; i < task->range_count; i++) {
+        RangeTask *range = &task->ranges[i];
+        HashMap *other = range->word_frequencies;
+
+        // Conversione degli identificativi delle parole della porzione
+        unsigned int *words = (unsigned int *)malloc((other->word_count + 1) * sizeof(unsigned int));
+        if (!words) error_handler(ERR_MEMORY_ALLOCATION);
+
+        memset(words, 0xFF, (other->word_count + 1) * sizeof(unsigned int));
+
+        PartitionItem *items = range->partitions[task->partition];
+
+        for (size_t j = 0; j < range->partition_sizes[task->partition]; j++) {
+            size_t usage = map->usage;
+            hashmap_merge_entry(map, other, hashmap_entry(other, items[j].entry), words);
+
+            // Se l'entry è stata creata, viene registrata la sua posizione nel testo
+            if (map->usage > usage) task->orders[usage] = task->range_orders[i] + items[j].order;
+        }
+
+        free(words);
+    }
+
+    return NULL;
+}
+
+/**
+ * Converte un file di testo in una tabella di frequenze suddividendolo tra più thread.
+ *
+ * Ogni thread elabora una porzione del testo in una propria hashmap, suddividendone le entry tra
+ * tante partizioni quanti sono i thread in base all'hash della parola; poi ogni thread unisce le
+ * entry di una partizione di tutte le porzioni. Le tabelle non vengono mai serializzate e le
+ * righe vengono scritte nell'ordine di inserimento dell'intero testo, ottenendo la stessa
+ * tabella della modalità a singolo processo.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param threads Il numero di thread.
+ */
+void tabulate_threaded(HashMap *word_frequencies, FILE *input_file, FILE *output_file, int threads) {
+    // Confini delle porzioni e terminatori che le precedono
+    off_t *boundaries;
+    char *terminators;
+
+    int ranges = split_text(input_file, threads, &boundaries, &terminators);
+
+    // Se il file non può essere suddiviso viene elaborato da un singolo processo
+    if (ranges == 0) {
+        tabulate_single_process(word_frequencies, input_file, output_file);
+        return;
+    }
+
+    // Porzioni e partizioni (una partizione per porzione)
+    RangeTask range_tasks[ranges];
+    PartitionTask partition_tasks[ranges];
+    pthread_t thread_ids[ranges];
+
+    // Partizioni di ogni porzione (le partizioni della porzione i iniziano da i * ranges)
+    PartitionItem **partitions = (PartitionItem **)calloc((size_t)ranges * ranges, sizeof(PartitionItem *));
+    size_t *partition_sizes = (size_t *)calloc((size_t)ranges * ranges, sizeof(size_t));
+    if (!partitions || !partition_sizes) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Costruzione delle tabelle delle porzioni
+    for (int i = 0; i < ranges; i++) {
+        range_tasks[i] = (RangeTask){ input_file, boundaries[i], boundaries[i + 1], i > 0 ? terminators[i] : '\0', NULL, NO_WORD, NO_WORD, ranges, &partitions[i * ranges], &partition_sizes[i * ranges] };
+
+        if (pthread_create(&thread_ids[i], NULL, tokenize_range, &range_tasks[i]) != 0) error_handler(ERR_PARALLELIZATION);
+    }
+
+    for (int i = 0; i < ranges; i++) pthread_join(thread_ids[i], NULL);
+
+    // Posizione della prima entry di ogni porzione nell'ordine di inserimento dell'intero testo
+    size_t range_orders[ranges + 1];
+    range_orders[0] = 0;
+
+    for (int i = 0; i < ranges; i++) range_orders[i + 1] = range_orders[i] + range_tasks[i].word_frequencies->usage;
+
+    // Unione delle partizioni
+    for (int i = 0; i < ranges; i++) {
+        partition_tasks[i] = (PartitionTask){ range_tasks, ranges, range_orders, i, NULL, NULL };
+
+        if (pthread_create(&thread_ids[i], NULL, merge_partition, &partition_tasks[i]) != 0) error_handler(ERR_PARALLELIZATION);
+    }
+
+    for (int i = 0; i < ranges; i++) pthread_join(thread_ids[i], NULL);
+
+    // L'ultima parola dell'ultima porzione viene collegata alla prima parola della prima
+    RangeTask *first_range = &range_tasks[0];
+    RangeTask *last_range = &range_tasks[ranges - 1];
+
+    char previous_word[MAX_WORD_BYTES] = "";
+    char first_word[MAX_WORD_BYTES] = "";
+    if (last_range->previous_word != NO_WORD) strcpy(previous_word, hashmap_word(last_range->word_frequencies, last_range->previous_word));
+    if (first_range->first_word != NO_WORD) strcpy(first_word, hashmap_word(first_range->word_frequencies, first_range->first_word));
+
+    // Deallocazione delle tabelle e delle partizioni delle porzioni
+    for (int i = 0; i < ranges; i++) {
+        hashmap_destroy(range_tasks[i].word_frequencies);
+        for (int j = 0; j < ranges; j++) free(partitions[i * ranges + j]);
+    }
+
+    free(partitions);
+    free(partition_sizes);
+
+    // Il collegamento viene inserito nella partizione della parola, come ultima entry del testo se è nuova
+    PartitionTask *link_partition = &partition_tasks[hash(previous_word) % ranges];
+    size_t usage = link_partition->word_frequencies->usage;
+
+    hashmap_insert(link_partition->word_frequencies, previous_word, first_word);
+    if (link_partition->word_frequencies->usage > usage) link_partition->orders[usage] = range_orders[ranges];
+
+    // Entry di tutte le partizioni nell'ordine di inserimento dell'intero testo (le parole ripetute lasciano posizioni vuote)
+    Entry **rows = (Entry **)calloc(range_orders[ranges] + 1, sizeof(Entry *));
+    HashMap **row_maps = (HashMap **)calloc(range_orders[ranges] + 1, sizeof(HashMap *));
+    if (!rows || !row_maps) error_handler(ERR_MEMORY_ALLOCATION);
+
+    for (int i = 0; i < ranges; i++) {
+        HashMap *map = partition_tasks[i].word_frequencies;
+        size_t index = 0;
+
+        for (Entry *entry = hashmap_entry(map, map->first); entry; entry = hashmap_entry(map, entry->next_inserted)) {
+            size_t order = partition_tasks[i].orders[index++];
+
+            rows[order] = entry;
+            row_maps[order] = map;
+        }
+    }
+
+    // Scrittura della tabella delle frequenze
+    for (size_t i = 0; i <= range_orders[ranges]; i++) {
+        if (rows[i]) entry_to_csv(row_maps[i], rows[i], output_file);
+    }
+
+    // Deallocazione delle righe e delle tabelle delle partizioni
+    free(rows);
+    free(row_maps);
+
+    for (int i = 0; i < ranges; i++) {
+        hashmap_destroy(partition_tasks[i].word_frequencies);
+        free(partition_tasks[i].orders);
+    }
+    free(boundaries);
+    free(terminators);
+}
+
+/**
+ * Inserisce nella tabella condivisa le parole di una porzione del testo.
+ *
+ * Ogni coppia di parole viene inserita con la sua posizione nel testo, in modo che l'ordine delle
+ * entry e dei nodi non dipenda dall'ordine in cui i thread inseriscono.
+ *
+ * @param argument La porzione (SharedRangeTask).
+ * @return NULL.
+ */
+void *tokenize_shared_range(void *argument) {
+    SharedRangeTask *task = (SharedRangeTask *)argument;
+    ConcurrentWriter *writer = concurrent_writer_create(task->word_frequencies);
+
+    // La prima porzione inizia senza parola precedente, le altre dopo un terminatore
+    task->previous_word = task->terminator ? concurrent_hashmap_intern(writer, (char[]){ task->terminator, '\0' }) : NULL;
+    task->first_word = NULL;
+
+    Tokenizer *tokenizer = tokenizer_create();
+    Reader *reader = reader_open_range(task->input_file, task->start, task->end);
+
+    // Offset nel file del blocco corrente
+    off_t total = task->start;
+
+    char *block;
+    size_t size;
+
+    // Il lettore restituisce blocchi che non dividono mai un carattere
+    while ((size = reader_read(reader, &block)) > 0) {
+        size_t offset = 0;
+
+        while (offset < size) {
+            // Il blocco viene scansionato un gruppo di parole alla volta
+            size_t start = offset;
+            offset += tokenizer_scan(tokenizer, (unsigned char *)block + offset, size - offset);
+
+            // Le parole del gruppo vengono inserite nella tabella condivisa
+            for (size_t i = 0; i < tokenizer->count; i++) {
+                process_shared_token(task, writer, &tokenizer->tokens[i], total + start + tokenizer->tokens[i].end);
+            }
+
+            tokenizer_clear(tokenizer);
+        }
+
+        total += size;
+    }
+
+    // Ultima parola, che termina alla fine della porzione
+    tokenizer_finish(tokenizer);
+    if (tokenizer->count > 0) process_shared_token(task, writer, &tokenizer->tokens[0], total);
+
+    // Le code vengono chiuse, in modo che i thread proprietari possano terminare
+    for (int i = 0; task->queues && i < task->owner_count; i++) bigram_queue_close(task->queues[i]);
+
+    reader_close(reader);
+    tokenizer_destroy(tokenizer);
+    concurrent_writer_destroy(writer);
+
+    return NULL;
+}
+
+/**
+ * Inserisce nella tabella condivisa una parola del testo.
+ *
+ * La coppia formata con la parola precedente ha posizione 2 * offset, quella formata con il
+ * terminatore 2 * offset + 1, quindi le posizioni seguono l'ordine di inserimento della modalità
+ * a singolo processo.
+ *
+ * @param task La porzione, che contiene la parola precedente (NULL all'inizio del testo) e la prima parola.
+ * @param writer Il thread che inserisce.
+ * @param token La parola.
+ * @param offset L'offset nel file del carattere successivo alla parola, che ne determina la posizione nel testo.
+ */
+void process_shared_token(SharedRangeTask *task, ConcurrentWriter *writer, Token *token, off_t offset) {
+    // La parola viene cercata una sola volta
+    ConcurrentWord *word = concurrent_hashmap_intern(writer, token->word);
+
+    // Se la parola precedente è vuota la imposta (e imposta la prima parola come la parola corrente)
+    if (!task->previous_word) {
+        task->previous_word = word;
+        task->first_word = word;
+        return;
+    }
+
+    // Inserimento della parola corrente nella tabella condivisa
+    insert_bigram(task, writer, task->previous_word, word, 2 * offset);
+
+    // Se la parola termina con un segno di punteggiatura, viene inserito nella tabella condivisa
+    if (token->terminator) {
+        task->previous_word = concurrent_hashmap_intern(writer, (char[]){ token->terminator, '\0' });
+        insert_bigram(task, writer, word, task->previous_word, 2 * offset + 1);
+    } else {
+        task->previous_word = word;
+    }
+}
+
+/**
+ * Inserisce nella tabella condivisa una coppia di parole, oppure la invia al thread proprietario della parola.
+ *
+ * @param task La porzione.
+ * @param writer Il thread che inserisce.
+ * @param word La parola.
+ * @param next_word La parola successiva.
+ * @param position La posizione della coppia nel testo.
+ */
+void insert_bigram(SharedRangeTask *task, ConcurrentWriter *writer, ConcurrentWord *word, ConcurrentWord *next_word, size_t position) {
+    if (task->bigrams) {
+        // La coppia viene contata dopo l'ordinamento
+        bigram_array_push(task->bigrams, word->id, next_word->id, position);
+        return;
+    }
+
+    if (!task->queues) {
+        concurrent_hashmap_insert(writer, word, next_word, position);
+        return;
+    }
+
+    // Il proprietario viene scelto dall'hash della parola (lo stesso calcolato da hash()), quindi ogni entry ha un solo proprietario
+    bigram_queue_push(task->queues[word->hash % task->owner_count], (Bigram){ word, next_word, position });
+}
+
+/**
+ * Inserisce nella tabella condivisa le coppie di parole ricevute da un thread proprietario.
+ *
+ * Le coppie di una parola arrivano tutte allo stesso thread, quindi le entry vengono modificate
+ * senza lock; l'ordine di arrivo non conta, perché ogni coppia porta la sua posizione nel testo.
+ *
+ * @param argument Il thread proprietario (OwnerTask).
+ * @return NULL.
+ */
+void *aggregate_partition(void *argument) {
+    OwnerTask *task = (OwnerTask *)argument;
+    ConcurrentWriter *writer = concurrent_writer_create(task->word_frequencies);
+
+    // Code non ancora terminate, che occupano le prime active posizioni
+    BigramQueue *queues[task->queue_count];
+    int active = task->queue_count;
+
+    for (int i = 0; i < active; i++) queues[i] = task->queues[i];
+
+    while (active > 0) {
+        bool received = false;
+
+        for (int i = 0; i < active; i++) {
+            Bigram *items;
+            size_t count = bigram_queue_acquire(queues[i], &items);
+
+            if (count > 0) {
+                // Inserimento delle coppie ricevute
+                for (size_t j = 0; j < count; j++) concurrent_hashmap_insert_owned(writer, items[j].word, items[j].next_word, items[j].position);
+
+                bigram_queue_release(queues[i], count);
+                received = true;
+            } else if (bigram_queue_finished(queues[i])) {
+                // La coda terminata viene sostituita dall'ultima ancora attiva
+                queues[i--] = queues[--active];
+            }
+        }
+
+        // Se nessuna coda aveva coppie, il thread attende
+        if (!received && active > 0) bigram_queue_wait(&task->signal, queues, active);
+    }
+
+    concurrent_writer_destroy(writer);
+
+    return NULL;
+}
+
+/**
+ * Scrive la tabella condivisa su un file CSV.
+ *
+ * @param word_frequencies La tabella delle frequenze da stampare.
+ * @param output_file Il file su cui stampare la tabella delle frequenze.
+ */
+void concurrent_hashmap_to_csv(ConcurrentHashMap *word_frequencies, FILE *output_file) {
+    // Entry in ordine di prima occorrenza, come l'ordine di inserimento della hashmap
+    size_t count;
+    ConcurrentWord **entries = concurrent_hashmap_entries(word_frequencies, &count);
+
+    // Array dei nodi, riutilizzato per tutte le entry
+    ConcurrentNode **nodes = NULL;
+    size_t capacity = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        ConcurrentWord *entry = entries[i];
+
+        // L'array dei nodi viene ingrandito fino a contenere quelli dell'entry
+        if (entry->size > capacity) {
+            capacity = entry->size;
+            nodes = (ConcurrentNode **)realloc(nodes, capacity * sizeof(ConcurrentNode *));
+            if (!nodes) error_handler(ERR_MEMORY_ALLOCATION);
+        }
+
+        concurrent_hashmap_nodes(word_frequencies, entry, nodes);
+
+        // Stampa nel file la parola relativa all'entry
+        fputs(entry->text, output_file);
+
+        // Stampa nel file le parole successive e le frequenze, calcolate dal numero di occorrenze
+        for (size_t j = 0; j < entry->size; j++) {
+            fprintf(output_file, ",%s,%.5f", concurrent_hashmap_word(word_frequencies, nodes[j]->next_word)->text, (double)nodes[j]->count / entry->count);
+        }
+
+        // Stampa nel file un carattere di nuova riga
+        fputc('\n', output_file);
+    }
+
+    free(nodes);
+    free(entries);
+}
+
+/**
+ * Converte un file di testo in una tabella di frequenze suddividendolo tra più thread che inseriscono in una tabella condivisa.
+ *
+ * Ogni thread elabora una porzione del testo inserendo le coppie di parole direttamente in
+ * un'unica hashmap concorrente, quindi non ci sono tabelle da unire; entry e nodi vengono
+ * ordinati in base alla loro prima occorrenza nel testo, ottenendo la stessa tabella della
+ * modalità a singolo processo.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param threads Il numero di thread.
+ */
+void tabulate_shared(HashMap *word_frequencies, FILE *input_file, FILE *output_file, int threads) {
+    // Confini delle porzioni e terminatori che le precedono
+    off_t *boundaries;
+    char *terminators;
+
+    int ranges = split_text(input_file, threads, &boundaries, &terminators);
+
+    // Se il file non può essere suddiviso viene elaborato da un singolo processo
+    if (ranges == 0) {
+        tabulate_single_process(word_frequencies, input_file, output_file);
+        return;
+    }
+
+    // Tabella condivisa e porzioni
+    ConcurrentHashMap *map = concurrent_hashmap_create();
+    SharedRangeTask range_tasks[ranges];
+    pthread_t thread_ids[ranges];
+
+    for (int i = 0; i < ranges; i++) {
+        range_tasks[i] = (SharedRangeTask){ input_file, boundaries[i], boundaries[i + 1], i > 0 ? terminators[i] : '\0', map, NULL, NULL, NULL, 0, NULL };
+
+        if (pthread_create(&thread_ids[i], NULL, tokenize_shared_range, &range_tasks[i]) != 0) error_handler(ERR_PARALLELIZATION);
+    }
+
+    for (int i = 0; i < ranges; i++) pthread_join(thread_ids[i], NULL);
+
+    // Collegamento dell'ultima parola e scrittura della tabella delle frequenze
+    write_shared_table(map, range_tasks, ranges, boundaries[ranges], output_file);
+
+    concurrent_hashmap_destroy(map);
+    free(boundaries);
+    free(terminators);
+}
+
+/**
+ * Converte un file di testo in una tabella di frequenze suddividendolo tra thread che leggono il testo e thread proprietari delle parole.
+ *
+ * I thread che leggono il testo non contano: cercano le parole nella tabella condivisa e inviano
+ * ogni coppia di parole, su una coda a singolo produttore e singolo consumatore, al thread
+ * proprietario della parola, scelto dal suo hash. Ogni proprietario modifica da solo le entry
+ * delle sue parole, quindi le coppie vengono contate senza lock e senza tabelle da unire.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param threads Il numero di thread che leggono il testo (e di thread proprietari, al massimo uno per porzione).
+ */
+void tabulate_shuffle(HashMap *word_frequencies, FILE *input_file, FILE *output_file, int threads) {
+    // Confini delle porzioni e terminatori che le precedono
+    off_t *boundaries;
+    char *terminators;
+
+    int ranges = split_text(input_file, threads, &boundaries, &terminators);
+
+    // Se il file non può essere suddiviso viene elaborato da un singolo processo
+    if (ranges == 0) {
+        tabulate_single_process(word_frequencies, input_file, output_file);
+        return;
+    }
+
+    // Al massimo un proprietario per porzione, in modo che il numero di code non superi il quadrato delle porzioni
+    int owners = threads < ranges ? threads : ranges;
+
+    // Tabella condivisa, porzioni e proprietari
+    ConcurrentHashMap *map = concurrent_hashmap_create();
+    SharedRangeTask range_tasks[ranges];
+    pthread_t range_ids[ranges];
+
+    OwnerTask *owner_tasks = (OwnerTask *)malloc(owners * sizeof(OwnerTask));
+    pthread_t *owner_ids = (pthread_t *)malloc(owners * sizeof(pthread_t));
+    if (!owner_tasks || !owner_ids) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Code tra ogni porzione e ogni proprietario (queues[i * owners + j] e owner_queues[j * ranges + i] vanno dalla porzione i al proprietario j)
+    BigramQueue **queues = (BigramQueue **)malloc((size_t)ranges * owners * sizeof(BigramQueue *));
+    BigramQueue **owner_queues = (BigramQueue **)malloc((size_t)owners * ranges * sizeof(BigramQueue *));
+    if (!queues || !owner_queues) error_handler(ERR_MEMORY_ALLOCATION);
+
+    for (int j = 0; j < owners; j++) {
+        // Il segnale parte senza dati e senza consumatore in attesa
+        owner_tasks[j] = (OwnerTask){ map, &owner_queues[j * ranges], ranges, { 0, false } };
+
+        for (int i = 0; i < ranges; i++) queues[i * owners + j] = owner_queues[j * ranges + i] = bigram_queue_create(&owner_tasks[j].signal);
+    }
+
+    // Avvio dei proprietari e dei thread che leggono il testo
+    for (int j = 0; j < owners; j++) {
+        if (pthread_create(&owner_ids[j], NULL, aggregate_partition, &owner_tasks[j]) != 0) error_handler(ERR_PARALLELIZATION);
+    }
+
+    for (int i = 0; i < ranges; i++) {
+        range_tasks[i] = (SharedRangeTask){ input_file, boundaries[i], boundaries[i + 1], i > 0 ? terminators[i] : '\0', map, NULL, NULL, &queues[i * owners], owners, NULL };
+
+        if (pthread_create(&range_ids[i], NULL, tokenize_shared_range, &range_tasks[i]) != 0) error_handler(ERR_PARALLELIZATION);
+    }
+
+    for (int i = 0; i < ranges; i++) pthread_join(range_ids[i], NULL);
+    for (int j = 0; j < owners; j++) pthread_join(owner_ids[j], NULL);
+
+    // Deallocazione delle code e dei proprietari
+    for (size_t i = 0; i < (size_t)ranges * owners; i++) bigram_queue_destroy(queues[i]);
+
+    free(queues);
+    free(owner_queues);
+    free(owner_tasks);
+    free(owner_ids);
+
+    // Collegamento dell'ultima parola e scrittura della tabella delle frequenze
+    write_shared_table(map, range_tasks, ranges, boundaries[ranges], output_file);
+
+    concurrent_hashmap_destroy(map);
+    free(boundaries);
+    free(terminators);
+}
+
+/**
+ * Collega l'ultima parola del testo alla prima e scrive la tabella condivisa su un file CSV.
+ *
+ * @param word_frequencies La tabella condivisa.
+ * @param range_tasks Le porzioni del testo.
+ * @param ranges Il numero di porzioni.
+ * @param file_size La dimensione del file.
+ * @param output_file Il file di output.
+ */
+void write_shared_table(ConcurrentHashMap *word_frequencies, SharedRangeTask *range_tasks, int ranges, off_t file_size, FILE *output_file) {
+    // L'ultima parola dell'ultima porzione viene collegata alla prima parola della prima, dopo tutte le altre coppie
+    ConcurrentWriter *writer = concurrent_writer_create(word_frequencies);
+
+    ConcurrentWord *previous_word = range_tasks[ranges - 1].previous_word;
+    ConcurrentWord *first_word = range_tasks[0].first_word;
+
+    // Se il testo non contiene parole, viene collegata la parola vuota a se stessa
+    if (!previous_word) previous_word = first_word = concurrent_hashmap_intern(writer, "");
+
+    concurrent_hashmap_insert(writer, previous_word, first_word, 2 * file_size + 2);
+    concurrent_writer_destroy(writer);
+
+    // Scrittura della tabella delle frequenze
+    concurrent_hashmap_to_csv(word_frequencies, output_file);
+}
+
+/**
+ * Converte un file di testo in una tabella di frequenze ordinando le coppie di parole invece di inserirle in una hashmap.
+ *
+ * Ogni thread legge una porzione del testo e aggiunge a un proprio array le coppie di parole, come
+ * identificativi della tabella condivisa delle parole; le coppie vengono poi ordinate con un radix
+ * sort tra gli stessi thread e contate scorrendo le sequenze di coppie uguali, con accessi
+ * sequenziali alla memoria. Ogni coppia porta la sua posizione nel testo, da cui si ottiene lo
+ * stesso ordine della modalità a singolo processo.
+ *
+ * @param word_frequencies La tabella delle frequenze.
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param threads Il numero di thread.
+ */
+void tabulate_sort(HashMap *word_frequencies, FILE *input_file, FILE *output_file, int threads) {
+    // Confini delle porzioni e terminatori che le precedono
+    off_t *boundaries;
+    char *terminators;
+
+    int ranges = split_text(input_file, threads, &boundaries, &terminators);
+
+    // Se il file non può essere suddiviso viene elaborato da un singolo processo
+    if (ranges == 0) {
+        tabulate_single_process(word_frequencies, input_file, output_file);
+        return;
+    }
+
+    // Tabella condivisa delle parole, porzioni e array delle coppie
+    ConcurrentHashMap *map = concurrent_hashmap_create();
+    SharedRangeTask range_tasks[ranges];
+    BigramArray bigrams[ranges];
+    pthread_t thread_ids[ranges];
+
+    for (int i = 0; i < ranges; i++) {
+        bigram_array_init(&bigrams[i]);
+        range_tasks[i] = (SharedRangeTask){ input_file, boundaries[i], boundaries[i + 1], i > 0 ? terminators[i] : '\0', map, NULL, NULL, NULL, 0, &bigrams[i] };
+
+        if (pthread_create(&thread_ids[i], NULL, tokenize_shared_range, &range_tasks[i]) != 0) error_handler(ERR_PARALLELIZATION);
+    }
+
+    for (int i = 0; i < ranges; i++) pthread_join(thread_ids[i], NULL);
+
+    // L'ultima parola dell'ultima porzione viene collegata alla prima parola della prima, dopo tutte le altre coppie
+    ConcurrentWriter *writer = concurrent_writer_create(map);
+
+    ConcurrentWord *previous_word = range_tasks[ranges - 1].previous_word;
+    ConcurrentWord *first_word = range_tasks[0].first_word;
+
+    // Se il testo non contiene parole, viene collegata la parola vuota a se stessa
+    if (!previous_word) previous_word = first_word = concurrent_hashmap_intern(writer, "");
+
+    bigram_array_push(&bigrams[ranges - 1], previous_word->id, first_word->id, 2 * boundaries[ranges] + 2);
+    concurrent_writer_destroy(writer);
+
+    // Ordinamento delle coppie per parola e parola successiva
+    size_t word_count;
+    ConcurrentWord **words = concurrent_hashmap_words(map, &word_count);
+
+    size_t size;
+    BigramRecord *records = bigram_sort(bigrams, ranges, word_count, &size);
+
+    // Scrittura della tabella delle frequenze
+    sorted_bigrams_to_csv(words, records, size, output_file);
+
+    free(words);
+    concurrent_hashmap_destroy(map);
+    free(boundaries);
+    free(terminators);
+}
+
+/**
+ * Scrive su un file CSV la tabella delle frequenze ottenuta dalle coppie di parole ordinate.
+ *
+ * Le coppie uguali sono consecutive e le coppie di una stessa parola formano un gruppo di coppie
+ * distinte, di cui si conservano il numero di occorrenze e la posizione della prima. I gruppi vengono
+ * scritti in ordine di prima occorrenza e le coppie di un gruppo in ordine inverso, come nella hashmap.
+ *
+ * Le coppie distinte e i gruppi vengono contati prima di essere allocati, e le coppie ordinate
+ * vengono deallocate prima dell'ordinamento dei gruppi, quindi la memoria usata per la scrittura
+ * dipende dal numero di coppie distinte e non dalla lunghezza del testo.
+ *
+ * @param words Le parole indicizzate per identificativo.
+ * @param records Le coppie ordinate (vengono deallocate).
+ * @param size Il numero di coppie.
+ * @param output_file Il file di output.
+ */
+void sorted_bigrams_to_csv(ConcurrentWord **words, BigramRecord *records, size_t size, FILE *output_file) {
+    // Conteggio delle coppie distinte e delle parole
+    size_t distinct_count = 0;
+    size_t word_count = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        if (i == 0 || records[i].word != records[i - 1].word) {
+            word_count++;
+            distinct_count++;
+        } else if (records[i].next_word != records[i - 1].next_word) {
+            distinct_count++;
+        }
+    }
+
+    BigramRun *runs = (BigramRun *)malloc((distinct_count + 1) * sizeof(BigramRun));
+    BigramGroup *groups = (BigramGroup *)malloc((word_count + 1) * sizeof(BigramGroup));
+    if (!runs || !groups) error_handler(ERR_MEMORY_ALLOCATION);
+
+    size_t run_count = 0;
+    size_t group_count = 0;
+
+    // Conteggio delle sequenze di coppie uguali
+    for (size_t i = 0; i < size; i++) {
+        BigramRecord *record = &records[i];
+
+        // Una nuova parola inizia un nuovo gruppo
+        if (i == 0 || record->word != records[i - 1].word) {
+            groups[group_count++] = (BigramGroup){ record->word, 0, record->position, run_count, 0 };
+        }
+
+        BigramGroup *group = &groups[group_count - 1];
+        group->count++;
+        if (record->position < group->position) group->position = record->position;
+
+        // Una nuova parola successiva inizia una nuova coppia distinta
+        if (group->run_count == 0 || record->next_word != runs[run_count - 1].next_word) {
+            runs[run_count++] = (BigramRun){ record->next_word, 0, record->position };
+            group->run_count++;
+        }
+
+        BigramRun *run = &runs[run_count - 1];
+        run->count++;
+        if (record->position < run->position) run->position = record->position;
+    }
+
+    // Le coppie ordinate non servono più
+    free(records);
+
+    // Ordinamento dei gruppi in ordine di prima occorrenza, come l'ordine di inserimento della hashmap
+    qsort(groups, group_count, sizeof(BigramGroup), compare_groups);
+
+    for (size_t i = 0; i < group_count; i++) {
+        BigramGroup *group = &groups[i];
+        BigramRun *group_runs = runs + group->first_run;
+
+        // L'ultima parola successiva comparsa viene per prima, come nella lista della hashmap
+        qsort(group_runs, group->run_count, sizeof(BigramRun), compare_runs);
+
+        // Stampa nel file la parola relativa al gruppo
+        fputs(words[group->word]->text, output_file);
+
+        // Stampa nel file le parole successive e le frequenze, calcolate dal numero di occorrenze
+        for (size_t j = 0; j < group->run_count; j++) {
+            fprintf(output_file, ",%s,%.5f", words[group_runs[j].next_word]->text, (double)group_runs[j].count / group->count);
+        }
+
+        // Stampa nel file un carattere di nuova riga
+        fputc('\n', output_file);
+    }
+
+    free(runs);
+    free(groups);
+}
+
+/**
+ * Confronta due parole in base alla loro prima occorrenza nel testo.
+ *
+ * @param first La prima parola (BigramGroup).
+ * @param second La seconda parola (BigramGroup).
+ * @return Un numero negativo, nullo o positivo se la prima parola precede, coincide o segue la seconda.
+ */
+int compare_groups(const void *first, const void *second) {
+    size_t first_position = ((BigramGroup *)first)->position;
+    size_t second_position = ((BigramGroup *)second)->position;
+
+    return (first_position > second_position) - (first_position < second_position);
+}
+
+/**
+ * Confronta due coppie distinte in ordine inverso di prima occorrenza nel testo.
+ *
+ * @param first La prima coppia (BigramRun).
+ * @param second La seconda coppia (BigramRun).
+ * @return Un numero negativo, nullo o positivo se la prima coppia precede, coincide o segue la seconda.
+ */
+int compare_runs(const void *first, const void *second) {
+    size_t first_position = ((BigramRun *)first)->position;
+    size_t second_position = ((BigramRun *)second)->position;
+
+    return (first_position < second_position) - (first_position > second_position);
+}
+
+/**
+ * Converte un file di testo in una tabella di frequenze usando al massimo una quantità di memoria indicata.
+ *
+ * Quando la tabella supera la memoria massima viene scritta su disco come run, ordinata per
+ * parola e parola successiva, e il testo prosegue in una tabella vuota. Alla fine i run vengono
+ * uniti: le coppie uguali dei diversi run vengono sommate e le righe, scritte a loro volta in run
+ * ordinati se non entrano in memoria, vengono riportate nell'ordine della modalità a singolo
+ * processo. Se la tabella non supera mai la memoria massima viene scritta direttamente.
+ *
+ * @param input_file Il file di input.
+ * @param output_file Il file di output.
+ * @param max_memory La memoria massima in byte.
+ */
+void tabulate_external(FILE *input_file, FILE *output_file, size_t max_memory) {
+    // La tabella viene sostituita a ogni run
+    ExternalTable table = { hashmap_create(), max_memory, { NULL, 0, 0, false }, 0, 0, NO_WORD, NO_WORD };
+
+    // Lettura dal file e processamento del testo
+    Reader *reader = reader_open(input_file);
+    process_external_input(&table, reader);
+    reader_close(reader);
+
+    // L'ultima parola viene collegata alla prima
+    link_last_word(table.word_frequencies, table.previous_word, table.first_word);
+
+    if (table.runs.count == 0) {
+        // La tabella è rimasta in memoria
+        hashmap_to_csv(table.word_frequencies, output_file);
+    } else {
+        // L'ultima tabella viene scritta su disco e i run vengono uniti
+        spill_table(&table);
+        merge_spilled_runs(&table, output_file);
+    }
+
+    spill_runs_destroy(&table.runs);
+    hashmap_destroy(table.word_frequencies);
+}
+
+/**
+ * Processa il testo letto da un lettore, scrivendo la tabella su disco quando supera la memoria massima.
+ *
+ * @param table La tabella.
+ * @param reader Il lettore del testo.
+ */
+void process_external_input(ExternalTable *table, Reader *reader) {
+    Tokenizer *tokenizer = tokenizer_create();
+
+    char *block;
+    size_t size;
+
+    // Il lettore restituisce blocchi che non dividono mai un carattere
+    while ((size = reader_read(reader, &block)) > 0) {
+        size_t offset = 0;
+
+        while (offset < size) {
+            // Il blocco viene scansionato un gruppo di parole alla volta
+            offset += tokenizer_scan(tokenizer, (unsigned char *)block + offset, size - offset);
+
+            for (size_t i = 0; i < tokenizer->count; i++) {
+                process_token(table->word_frequencies, &tokenizer->tokens[i], &table->previous_word, &table->first_word);
+
+                // Se la tabella supera la memoria massima viene scritta su disco (una tabella senza entry non può essere ridotta)
+                HashMap *map = table->word_frequencies;
+                if (region_header(map->region)->size >= table->max_memory && map->usage > 0) spill_table(table);
+            }
+
+            tokenizer_clear(tokenizer);
+        }
+    }
+
+    // Ultima parola
+    tokenizer_finish(tokenizer);
+    if (tokenizer->count > 0) process_token(table->word_frequencies, &tokenizer->tokens[0], &table->previous_word, &table->first_word);
+
+    tokenizer_destroy(tokenizer);
+}
+
+/**
+ * Scrive su disco la tabella corrente come run e la sostituisce con una tabella vuota.
+ *
+ * Le entry vengono scritte in ordine di parola e i nodi di ogni entry in ordine di parola
+ * successiva; gli ordini di prima occorrenza vengono ricavati dalla lista delle entry e da quella
+ * dei nodi (in cui l'ultimo nodo inserito è il primo) e proseguono quelli dei run precedenti.
+ *
+ * @param table La tabella.
+ */
+void spill_table(ExternalTable *table) {
+    HashMap *map = table->word_frequencies;
+
+    // Entry in ordine di inserimento
+    SpilledEntry *entries = (SpilledEntry *)malloc((map->usage + 1) * sizeof(SpilledEntry));
+    if (!entries) error_handler(ERR_MEMORY_ALLOCATION);
+
+    size_t count = 0;
+    size_t node_capacity = 0;
+
+    for (Entry *entry = hashmap_entry(map, map->first); entry; entry = hashmap_entry(map, entry->next_inserted)) {
+        entries[count] = (SpilledEntry){ hashmap_word(map, entry->word), entry, table->entry_order + count };
+        count++;
+
+        if (entry->size > node_capacity) node_capacity = entry->size;
+    }
+
+    table->entry_order += count;
+
+    // Ordinamento delle entry per parola
+    qsort(entries, count, sizeof(SpilledEntry), compare_spilled_entries);
+
+    SpilledNode *nodes = (SpilledNode *)malloc((node_capacity + 1) * sizeof(SpilledNode));
+    if (!nodes) error_handler(ERR_MEMORY_ALLOCATION);
+
+    FILE *run = spill_create();
+    SpillPair pair;
+
+    for (size_t i = 0; i < count; i++) {
+        Entry *entry = entries[i].entry;
+
+        // Nodi dell'entry, dall'ultimo inserito al primo
+        size_t size = 0;
+        for (Node *node = hashmap_node(map, entry->next_words); node; node = hashmap_node(map, node->next)) {
+            nodes[size] = (SpilledNode){ hashmap_word(map, node->next_word), node->count, table->pair_order + entry->size - 1 - size };
+            size++;
+        }
+
+        table->pair_order += entry->size;
+
+        // Ordinamento dei nodi per parola successiva e scrittura delle coppie
+        qsort(nodes, size, sizeof(SpilledNode), compare_spilled_nodes);
+
+        strcpy(pair.word, entries[i].word);
+        pair.entry_order = entries[i].order;
+
+        for (size_t j = 0; j < size; j++) {
+            strcpy(pair.next_word, nodes[j].next_word);
+            pair.count = nodes[j].count;
+            pair.order = nodes[j].order;
+
+            spill_write_pair(run, &pair);
+        }
+    }
+
+    spill_runs_add(&table->runs, run);
+
+    free(nodes);
+    free(entries);
+
+    // La parola precedente e la prima parola vengono riportate nella nuova tabella
+    char previous_word[MAX_WORD_BYTES];
+    char first_word[MAX_WORD_BYTES];
+
+    strcpy(previous_word, hashmap_word(map, table->previous_word));
+    strcpy(first_word, hashmap_word(map, table->first_word));
+
+    hashmap_destroy(map);
+
+    table->word_frequencies = map = hashmap_create();
+    table->first_word = hashmap_intern(map, first_word);
+    table->previous_word = hashmap_intern(map, previous_word);
+}
+
+/**
+ * Unisce i run di una tabella scritta su disco e scrive la tabella delle frequenze su un file CSV.
+ *
+ * Le coppie arrivano in ordine di parola e parola successiva, quindi le coppie uguali e le coppie
+ * di una stessa parola sono consecutive: ogni parola diventa una riga, che viene scritta con
+ * l'ordine della sua prima occorrenza. Le righe vengono ordinate in memoria e, se superano la
+ * memoria massima, scritte in run ordinati e unite a loro volta.
+ *
+ * @param table La tabella.
+ * @param output_file Il file di output.
+ */
+void merge_spilled_runs(ExternalTable *table, FILE *output_file) {
+    SpillMerge *merge = spill_merge_create(&table->runs);
+
+    LineBuffer lines = { NULL, 0, 0, NULL, 0, 0, 0, table->max_memory, { NULL, 0, 0, true } };
+    MergedGroup group = { "", 0, 0, NULL, 0, 0 };
+
+    bool started = false;
+    SpillPair *pair;
+
+    while ((pair = spill_merge_pair(merge))) {
+        // Una nuova parola termina la riga della parola precedente
+        if (!started || strcmp(pair->word, group.word) != 0) {
+            if (started) buffer_group(&group, &lines);
+
+            strcpy(group.word, pair->word);
+            group.count = 0;
+            group.order = pair->entry_order;
+            group.size = 0;
+            started = true;
+        }
+
+        group.count += pair->count;
+        if (pair->entry_order < group.order) group.order = pair->entry_order;
+
+        // Una nuova parola successiva inizia una nuova coppia, le coppie uguali di run diversi vengono sommate
+        MergedSuccessor *successor = group.size > 0 ? &group.successors[group.size - 1] : NULL;
+
+        if (!successor || strcmp(pair->next_word, successor->next_word) != 0) {
+            if (group.size == group.capacity) {
+                group.capacity = group.capacity ? group.capacity * 2 : 64;
+
+                group.successors = (MergedSuccessor *)realloc(group.successors, group.capacity * sizeof(MergedSuccessor));
+                if (!group.successors) error_handler(ERR_MEMORY_ALLOCATION);
+            }
+
+            successor = &group.successors[group.size++];
+            strcpy(successor->next_word, pair->next_word);
+            successor->count = 0;
+            successor->order = pair->order;
+        }
+
+        successor->count += pair->count;
+        if (pair->order < successor->order) successor->order = pair->order;
+    }
+
+    if (started) buffer_group(&group, &lines);
+
+    spill_merge_destroy(merge);
+    free(group.successors);
+
+    if (lines.runs.count == 0) {
+        // Le righe sono rimaste in memoria
+        flush_lines(&lines, output_file, false);
+    } else {
+        // Le ultime righe vengono scritte su disco e i run vengono uniti in ordine di riga
+        FILE *run = spill_create();
+        flush_lines(&lines, run, true);
+        spill_runs_add(&lines.runs, run);
+
+        SpillMerge *line_merge = spill_merge_create(&lines.runs);
+
+        SpillLine *line;
+        while ((line = spill_merge_line(line_merge))) fwrite(line->text, 1, line->length, output_file);
+
+        spill_merge_destroy(line_merge);
+    }
+
+    spill_runs_destroy(&lines.runs);
+    free(lines.text);
+    free(lines.lines);
+}
+
+/**
+ * Aggiunge a un buffer la riga di una parola ottenuta dall'unione dei run.
+ *
+ * @param group La parola con le sue parole successive.
+ * @param lines Il buffer delle righe.
+ */
+void buffer_group(MergedGroup *group, LineBuffer *lines) {
+    // L'ultima parola successiva comparsa viene per prima, come nella lista della hashmap
+    qsort(group->successors, group->size, sizeof(MergedSuccessor), compare_merged_successors);
+
+    // Parola relativa alla riga
+    append_line_text(lines, group->word, strlen(group->word));
+
+    // Parole successive e frequenze, calcolate dal numero di occorrenze
+    char frequency[32];
+
+    for (size_t i = 0; i < group->size; i++) {
+        MergedSuccessor *successor = &group->successors[i];
+
+        append_line_text(lines, ",", 1);
+        append_line_text(lines, successor->next_word, strlen(successor->next_word));
+
+        int length = snprintf(frequency, sizeof(frequency), ",%.5f", (double)successor->count / group->count);
+        append_line_text(lines, frequency, length);
+    }
+
+    append_line_text(lines, "\n", 1);
+    end_line(lines, group->order);
+}
+
+/**
+ * Aggiunge del testo alla riga in corso di un buffer, ingrandendolo se necessario.
+ *
+ * @param lines Il buffer delle righe.
+ * @param text Il testo.
+ * @param length La lunghezza del testo.
+ */
+void append_line_text(LineBuffer *lines, char *text, size_t length) {
+    // Se il buffer è pieno la capacità viene raddoppiata
+    if (lines->size + length > lines->capacity) {
+        while (lines->size + length > lines->capacity) lines->capacity = lines->capacity ? lines->capacity * 2 : 64 * 1024;
+
+        lines->text = (char *)realloc(lines->text, lines->capacity);
+        if (!lines->text) error_handler(ERR_MEMORY_ALLOCATION);
+    }
+
+    memcpy(lines->text + lines->size, text, length);
+    lines->size += length;
+}
+
+/**
+ * Termina la riga in corso di un buffer; se il buffer supera la memoria massima, le righe vengono scritte in un run.
+ *
+ * @param lines Il buffer delle righe.
+ * @param order L'ordine della riga.
+ */
+void end_line(LineBuffer *lines, size_t order) {
+    // Se l'array delle righe è pieno la capacità viene raddoppiata
+    if (lines->count == lines->lines_capacity) {
+        lines->lines_capacity = lines->lines_capacity ? lines->lines_capacity * 2 : 1024;
+
+        lines->lines = (BufferedLine *)realloc(lines->lines, lines->lines_capacity * sizeof(BufferedLine));
+        if (!lines->lines) error_handler(ERR_MEMORY_ALLOCATION);
+    }
+
+    lines->lines[lines->count++] = (BufferedLine){ order, lines->start, lines->size - lines->start };
+    lines->start = lines->size;
+
+    // Le righe vengono scritte su disco quando superano la memoria massima
+    if (lines->size + lines->count * sizeof(BufferedLine) >= lines->max_memory) {
+        FILE *run = spill_create();
+        flush_lines(lines, run, true);
+        spill_runs_add(&lines->runs, run);
+    }
+}
+
+/**
+ * Scrive le righe di un buffer in ordine di riga e svuota il buffer.
+ *
+ * @param lines Il buffer delle righe.
+ * @param file Il file su cui scrivere.
+ * @param run Indica se scrivere le righe come run (con il loro ordine) invece che come testo.
+ */
+void flush_lines(LineBuffer *lines, FILE *file, bool run) {
+    qsort(lines->lines, lines->count, sizeof(BufferedLine), compare_buffered_lines);
+
+    for (size_t i = 0; i < lines->count; i++) {
+        BufferedLine *line = &lines->lines[i];
+
+        if (run) {
+            spill_write_line(file, line->order, lines->text + line->offset, line->length);
+        } else {
+            fwrite(lines->text + line->offset, 1, line->length, file);
+        }
+    }
+
+    lines->size = 0;
+    lines->count = 0;
+    lines->start = 0;
+}
+
+/**
+ * Confronta due entry scritte su disco in base alla parola.
+ *
+ * @param first La prima entry (SpilledEntry).
+ * @param second La seconda entry (SpilledEntry).
+ * @return Un numero negativo, nullo o positivo se la prima entry precede, coincide o segue la seconda.
+ */
+int compare_spilled_entries(const void *first, const void *second) {
+    return strcmp(((SpilledEntry *)first)->word, ((SpilledEntry *)second)->word);
+}
+
+/**
+ * Confronta due nodi scritti su disco in base alla parola successiva.
+ *
+ * @param first Il primo nodo (SpilledNode).
+ * @param second Il secondo nodo (SpilledNode).
+ * @return Un numero negativo, nullo o positivo se il primo nodo precede, coincide o segue il secondo.
+ */
+int compare_spilled_nodes(const void *first, const void *second) {
+    return strcmp(((SpilledNode *)first)->next_word, ((SpilledNode *)second)->next_word);
+}
+
+/**
+ * Confronta due parole successive in ordine inverso di prima occorrenza nel testo.
+ *
+ * @param first La prima parola successiva (MergedSuccessor).
+ * @param second La seconda parola successiva (MergedSuccessor).
+ * @return Un numero negativo, nullo o positivo se la prima parola precede, coincide o segue la seconda.
+ */
+int compare_merged_successors(const void *first, const void *second) {
+    size_t first_order = ((MergedSuccessor *)first)->order;
+    size_t second_order = ((MergedSuccessor *)second)->order;
+
+    return (first_order < second_order) - (first_order > second_order);
+}
+
+/**
+ * Confronta due righe in base al loro ordine.
+ *
+ * @param first La prima riga (BufferedLine).
+ * @param second La seconda riga (BufferedLine).
+ * @return Un numero negativo, nullo o positivo se la prima riga precede, coincide o segue la seconda.
+ */
+int compare_buffered_lines(const void *first, const void *second) {
+    size_t first_order = ((BufferedLine *)first)->order;
+    size_t second_order = ((BufferedLine *)second)->order;
+
+    return (first_order > second_order) - (first_order < second_order);
 }
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#include "tokenizer.h"
+#include "error_handler.h"
+#include "utf8.h"
+
+/**
+ * Enumerazione delle classi dei caratteri.
+ */
+typedef enum {
+    CLASS_OTHER,
+    CLASS_ALNUM,
+    CLASS_SEPARATOR,
+    CLASS_APOSTROPHE,
+    CLASS_TERMINATOR,
+    CLASS_IGNORED,
+    CLASS_MULTIBYTE
+} CharacterClass;
+
+/**
+ * Classe di ogni byte: i caratteri ASCII vengono classificati direttamente, i byte iniziali delle
+ * sequenze multibyte richiedono la decodifica del carattere.
+ */
+const unsigned char character_classes[256] = {
+    // Lettere e cifre, aggiunte alla parola in minuscolo
+    ['0' ... '9'] = CLASS_ALNUM,
+    ['A' ... 'Z'] = CLASS_ALNUM,
+    ['a' ... 'z'] = CLASS_ALNUM,
+
+    // Spazi, a capo e fine del testo, che terminano la parola
+    ['\0'] = CLASS_SEPARATOR,
+    ['\t'] = CLASS_SEPARATOR,
+    ['\n'] = CLASS_SEPARATOR,
+    [' '] = CLASS_SEPARATOR,
+
+    // Apostrofo, che termina la parola e ne fa parte
+    ['\''] = CLASS_APOSTROPHE,
+
+    // Segni di punteggiatura che terminano la parola e la frase
+    ['.'] = CLASS_TERMINATOR,
+    ['?'] = CLASS_TERMINATOR,
+    ['!'] = CLASS_TERMINATOR,
+
+    // Punteggiatura non valida, che viene scartata
+    [','] = CLASS_IGNORED, [';'] = CLASS_IGNORED, [':'] = CLASS_IGNORED, ['-'] = CLASS_IGNORED,
+    ['('] = CLASS_IGNORED, [')'] = CLASS_IGNORED, ['['] = CLASS_IGNORED, [']'] = CLASS_IGNORED,
+    ['{'] = CLASS_IGNORED, ['}'] = CLASS_IGNORED, ['<'] = CLASS_IGNORED, ['>'] = CLASS_IGNORED,
+    ['"'] = CLASS_IGNORED, ['/'] = CLASS_IGNORED, ['\\'] = CLASS_IGNORED, ['|'] = CLASS_IGNORED,
+    ['@'] = CLASS_IGNORED, ['#'] = CLASS_IGNORED, ['$'] = CLASS_IGNORED, ['%'] = CLASS_IGNORED,
+    ['^'] = CLASS_IGNORED, ['&'] = CLASS_IGNORED, ['*'] = CLASS_IGNORED, ['_'] = CLASS_IGNORED,
+    ['+'] = CLASS_IGNORED, ['='] = CLASS_IGNORED, ['~'] = CLASS_IGNORED, ['`'] = CLASS_IGNORED,
+
+    // Byte non ASCII
+    [0x80 ... 0xFF] = CLASS_MULTIBYTE
+};
+
+/**
+ * Aggiunge un carattere alla parola corrente.
+ *
+ * @param tokenizer Il tokenizzatore.
+ * @param character Il carattere da aggiungere (già in minuscolo).
+ */
+void append_character(Tokenizer *tokenizer, wchar_t character);
+
+/**
+ * Termina la parola corrente, aggiungendola al gruppo di parole.
+ *
+ * @param tokenizer Il tokenizzatore.
+ * @param terminator Il segno di punteggiatura che termina la parola ('\0' se assente).
+ * @param end L'offset del blocco successivo al carattere che termina la parola.
+ */
+void end_word(Tokenizer *tokenizer, char terminator, size_t end);
+
+/**
+ * Crea un tokenizzatore.
+ *
+ * @return Il tokenizzatore creato.
+ */
+Tokenizer *tokenizer_create() {
+    // Allocazione del tokenizzatore
+    Tokenizer *tokenizer = (Tokenizer *)malloc(sizeof(Tokenizer));
+    if (!tokenizer) error_handler(ERR_MEMORY_ALLOCATION);
+
+    // Inizializzazione del tokenizzatore
+    tokenizer->count = 0;
+    tokenizer->index = 0;
+    tokenizer->length = 0;
+
+    // Tabella dei caratteri Latin-1, calcolata in base alla localizzazione in modo da non convertirli uno alla volta
+    for (wchar_t character = 0x80; character < 0x100; character++) {
+        tokenizer->latin1_lower[character - 0x80] = iswblank(character) ? 0 : towlower(character);
+    }
+
+    // Restituzione del tokenizzatore
+    return tokenizer;
+}
+
+/**
+ * Scansiona un blocco del testo, fermandosi quando il gruppo di parole è pieno.
+ *
+ * @param tokenizer Il tokenizzatore (con il gruppo di parole vuoto).
+ * @param data Il blocco da scansionare (non divide mai un carattere).
+ * @param size La dimensione del blocco.
+ * @return Il numero di byte scansionati.
+ */
+size_t tokenizer_scan(Tokenizer *tokenizer, const unsigned char *data, size_t size) {
+    size_t offset = 0;
+
+    while (offset < size && tokenizer->count < TOKENIZER_BATCH_SIZE) {
+        unsigned char byte = data[offset];
+
+        switch (character_classes[byte]) {
+            case CLASS_ALNUM: {
+                // Le sequenze di lettere e cifre vengono copiate in minuscolo direttamente nella parola
+                size_t span = utf8_alnum_span(data + offset, size - offset);
+                if (tokenizer->length + span >= MAX_WORD_LENGTH) error_handler(ERR_INVALID_TEXT);
+
+                utf8_alnum_lower(tokenizer->tokens[tokenizer->count].word + tokenizer->index, data + offset, span);
+
+                tokenizer->index += span;
+                tokenizer->length += span;
+                offset += span;
+                break;
+            }
+
+            case CLASS_SEPARATOR:
+                offset++;
+
+                // Termina la parola corrente, se presente
+                if (tokenizer->index != 0) end_word(tokenizer, '\0', offset);
+                break;
+
+            case CLASS_APOSTROPHE:
+                offset++;
+
+                // L'apostrofo viene concatenato alla parola corrente, che termina (all'inizio di una parola è un carattere qualsiasi)
+                if (tokenizer->index != 0) {
+                    tokenizer->tokens[tokenizer->count].word[tokenizer->index++] = '\'';
+                    end_word(tokenizer, '\0', offset);
+                } else {
+                    append_character(tokenizer, byte);
+                }
+                break;
+
+            case CLASS_TERMINATOR:
+                offset++;
+
+                // Il segno di punteggiatura termina la parola corrente (all'inizio di una parola è un carattere qualsiasi)
+                if (tokenizer->index != 0) {
+                    end_word(tokenizer, byte, offset);
+                } else {
+                    append_character(tokenizer, byte);
+                }
+                break;
+
+            case CLASS_IGNORED:
+                offset++;
+                break;
+
+            case CLASS_MULTIBYTE: {
+                // Decodifica del carattere
+                wchar_t character;
+                size_t character_size = utf8_decode(data + offset, size - offset, &character);
+
+                // Sequenza non valida o troncata alla fine del testo
+                if (character_size == (size_t)-1 || character_size == 0) error_handler(ERR_INVALID_TEXT);
+
+                offset += character_size;
+
+                // I caratteri Latin-1 vengono classificati con la tabella, gli altri singolarmente
+                wchar_t lower = character < 0x100 ? tokenizer->latin1_lower[character - 0x80] : iswblank(character) ? 0 : towlower(character);
+
+                if (lower) {
+                    append_character(tokenizer, lower);
+                } else if (tokenizer->index != 0) {
+                    end_word(tokenizer, '\0', offset);
+                }
+                break;
+            }
+
+            default:
+                // Gli altri caratteri ASCII vengono aggiunti alla parola così come sono
+                append_character(tokenizer, byte);
+                offset++;
+        }
+    }
+
+    return offset;
+}
+
+/**
+ * Termina il testo, completando la parola corrente.
+ *
+ * @param tokenizer Il tokenizzatore (con il gruppo di parole vuoto).
+ */
+void tokenizer_finish(Tokenizer *tokenizer) {
+    // La fine del testo si comporta come uno spazio
+    if (tokenizer->index != 0) end_word(tokenizer, '\0', 0);
+}
+
+/**
+ * Svuota il gruppo di parole già consumate, conservando la parola corrente.
+ *
+ * @param tokenizer Il tokenizzatore.
+ */
+void tokenizer_clear(Tokenizer *tokenizer) {
+    if (tokenizer->count == 0) return;
+
+    // La parola corrente viene spostata all'inizio del gruppo
+    memcpy(tokenizer->tokens[0].word, tokenizer->tokens[tokenizer->count].word, tokenizer->index);
+    tokenizer->count = 0;
+}
+
+/**
+ * Distrugge un tokenizzatore.
+ *
+ * @param tokenizer Il tokenizzatore da distruggere.
+ */
+void tokenizer_destroy(Tokenizer *tokenizer) {
+    free(tokenizer);
+}
+
+/**
+ * Aggiunge un carattere alla parola corrente.
+ *
+ * @param tokenizer Il tokenizzatore.
+ * @param character Il carattere da aggiungere (già in minuscolo).
+ */
+void append_character(Tokenizer *tokenizer, wchar_t character) {
+    // Controllo della lunghezza massima della parola
+    if (tokenizer->length + 1 >= MAX_WORD_LENGTH) error_handler(ERR_INVALID_TEXT);
+
+    // Il carattere viene codificato in UTF-8 nella parola
+    tokenizer->index += utf8_encode(character, tokenizer->tokens[tokenizer->count].word + tokenizer->index);
+    tokenizer->length++;
+}
+
+/**
+ * Termina la parola corrente, aggiungendola al gruppo di parole.
+ *
+ * @param tokenizer Il tokenizzatore.
+ * @param terminator Il segno di punteggiatura che termina la parola ('\0' se assente).
+ * @param end L'offset del blocco successivo al carattere che termina la parola.
+ */
+void end_word(Tokenizer *tokenizer, char terminator, size_t end) {
+    Token *token = &tokenizer->tokens[tokenizer->count++];
+
+    // Terminazione della parola
+    token->word[tokenizer->index] = '\0';
+    token->terminator = terminator;
+    token->end = end;
+
+    // La parola successiva inizia vuota
+    tokenizer->index = 0;
+    tokenizer->length = 0;
+}
\ No newline at end of file
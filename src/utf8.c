@@ -0,0 +1,241 @@
+#include <stddef.h>
+#include <stdbool.h>
+#include <wchar.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "utf8.h"
+
+/**
+ * Verifica se un byte è una lettera o una cifra ASCII.
+ *
+ * @param byte Il byte da verificare.
+ * @return true se il byte è una lettera o una cifra ASCII, false altrimenti.
+ */
+bool is_ascii_alnum(unsigned char byte);
+
+/**
+ * Restituisce la lunghezza di un carattere UTF-8 a partire dal suo primo byte.
+ *
+ * @param byte Il primo byte del carattere.
+ * @return La lunghezza del carattere, 0 se il byte non può iniziare un carattere.
+ */
+size_t utf8_length(unsigned char byte);
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * Restituisce la lunghezza della sequenza di lettere e cifre ASCII all'inizio di un buffer, a blocchi di 32 byte con AVX2.
+ *
+ * La funzione viene compilata per AVX2 indipendentemente dalle opzioni di compilazione e va chiamata
+ * solo se il processore lo supporta.
+ *
+ * @param data Il buffer.
+ * @param size La dimensione del buffer.
+ * @return Il numero di byte della sequenza, o dei blocchi completi esaminati se la sequenza prosegue oltre.
+ */
+size_t utf8_alnum_span_avx2(const unsigned char *data, size_t size) __attribute__((target("avx2")));
+#endif
+
+/**
+ * Restituisce la lunghezza della sequenza di lettere e cifre ASCII all'inizio di un buffer.
+ *
+ * @param data Il buffer.
+ * @param size La dimensione del buffer.
+ * @return Il numero di byte della sequenza.
+ */
+size_t utf8_alnum_span(const unsigned char *data, size_t size) {
+    size_t offset = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Blocchi di 32 byte, se il processore supporta AVX2 (la scansione prosegue dal primo byte non esaminato)
+    if (__builtin_cpu_supports("avx2")) offset = utf8_alnum_span_avx2(data, size);
+#endif
+
+#ifdef __SSE2__
+    // Blocchi di 16 byte
+    while (offset + 16 <= size) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(data + offset));
+        __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('9' + 1)));
+
+        // Maschera dei byte che sono lettere o cifre
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(alpha, digit));
+
+        // La sequenza termina al primo byte che non appartiene alla maschera
+        if (mask != 0xFFFF) return offset + __builtin_ctz(~mask);
+
+        offset += 16;
+    }
+#endif
+
+    // Byte rimanenti
+    while (offset < size && is_ascii_alnum(data[offset])) offset++;
+
+    return offset;
+}
+
+/**
+ * Copia una sequenza di lettere e cifre ASCII convertendola in minuscolo.
+ *
+ * @param destination La stringa di destinazione.
+ * @param source La sequenza da copiare.
+ * @param size La lunghezza della sequenza.
+ */
+void utf8_alnum_lower(char *destination, const unsigned char *source, size_t size) {
+    // Il bit 0x20 rende minuscole le lettere e lascia invariate le cifre
+    for (size_t i = 0; i < size; i++) {
+        destination[i] = source[i] | 0x20;
+    }
+}
+
+/**
+ * Decodifica un carattere UTF-8.
+ *
+ * @param data Il buffer da cui decodificare il carattere.
+ * @param size Il numero di byte disponibili nel buffer.
+ * @param character Il carattere decodificato.
+ * @return Il numero di byte del carattere, 0 se la sequenza è incompleta, (size_t)-1 se non è valida.
+ */
+size_t utf8_decode(const unsigned char *data, size_t size, wchar_t *character) {
+    // Carattere ASCII
+    if (data[0] < 0x80) {
+        *character = data[0];
+        return 1;
+    }
+
+    // Lunghezza della sequenza
+    size_t length = utf8_length(data[0]);
+    if (length == 0) return (size_t)-1;
+
+    // Bit del primo byte e valore minimo rappresentabile con la lunghezza della sequenza
+    wchar_t value = data[0] & (0x7F >> length);
+    wchar_t minimum = length == 2 ? 0x80 : length == 3 ? 0x800 : 0x10000;
+
+    // Byte di continuazione
+    for (size_t i = 1; i < length; i++) {
+        if (i == size) return 0;
+        if ((data[i] & 0xC0) != 0x80) return (size_t)-1;
+
+        value = (value << 6) | (data[i] & 0x3F);
+    }
+
+    // Sequenze troppo lunghe, surrogati e valori fuori dall'intervallo Unicode non sono validi
+    if (value < minimum || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) return (size_t)-1;
+
+    *character = value;
+    return length;
+}
+
+/**
+ * Codifica un carattere in UTF-8.
+ *
+ * @param character Il carattere da codificare.
+ * @param destination La stringa di destinazione (almeno 4 byte disponibili).
+ * @return Il numero di byte scritti.
+ */
+size_t utf8_encode(wchar_t character, char *destination) {
+    // Carattere ASCII
+    if (character < 0x80) {
+        destination[0] = (char)character;
+        return 1;
+    }
+
+    // Lunghezza della sequenza in base al valore del carattere
+    size_t length = character < 0x800 ? 2 : character < 0x10000 ? 3 : 4;
+
+    // Byte di continuazione, a partire dall'ultimo
+    for (size_t i = length - 1; i > 0; i--) {
+        destination[i] = (char)(0x80 | (character & 0x3F));
+        character >>= 6;
+    }
+
+    // Primo byte, con i bit che indicano la lunghezza
+    destination[0] = (char)((0xF00 >> length) | character);
+    return length;
+}
+
+/**
+ * Restituisce il numero di byte finali di un buffer che formano un carattere incompleto.
+ *
+ * @param data Il buffer.
+ * @param size La dimensione del buffer.
+ * @return Il numero di byte del carattere incompleto, 0 se il buffer termina con un carattere completo.
+ */
+size_t utf8_incomplete_suffix(const unsigned char *data, size_t size) {
+    // Un carattere occupa al massimo 4 byte, quindi il primo byte è tra gli ultimi 3
+    for (size_t i = 1; i <= 3 && i <= size; i++) {
+        unsigned char byte = data[size - i];
+
+        // Byte di continuazione, il primo byte è più indietro
+        if ((byte & 0xC0) == 0x80) continue;
+
+        // Il carattere è incompleto se richiede più byte di quelli presenti
+        size_t length = utf8_length(byte);
+        return length > i ? i : 0;
+    }
+
+    return 0;
+}
+
+/**
+ * Verifica se un byte è una lettera o una cifra ASCII.
+ *
+ * @param byte Il byte da verificare.
+ * @return true se il byte è una lettera o una cifra ASCII, false altrimenti.
+ */
+bool is_ascii_alnum(unsigned char byte) {
+    unsigned char lower = byte | 0x20;
+
+    return (lower >= 'a' && lower <= 'z') || (byte >= '0' && byte <= '9');
+}
+
+/**
+ * Restituisce la lunghezza di un carattere UTF-8 a partire dal suo primo byte.
+ *
+ * @param byte Il primo byte del carattere.
+ * @return La lunghezza del carattere, 0 se il byte non può iniziare un carattere.
+ */
+size_t utf8_length(unsigned char byte) {
+    if (byte < 0x80) return 1;
+    if ((byte & 0xE0) == 0xC0) return 2;
+    if ((byte & 0xF0) == 0xE0) return 3;
+    if ((byte & 0xF8) == 0xF0) return 4;
+
+    return 0;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * Restituisce la lunghezza della sequenza di lettere e cifre ASCII all'inizio di un buffer, a blocchi di 32 byte con AVX2.
+ *
+ * @param data Il buffer.
+ * @param size La dimensione del buffer.
+ * @return Il numero di byte della sequenza, o dei blocchi completi esaminati se la sequenza prosegue oltre.
+ */
+size_t utf8_alnum_span_avx2(const unsigned char *data, size_t size) {
+    size_t offset = 0;
+
+    // Blocchi di 32 byte (i byte non ASCII sono negativi e non rientrano negli intervalli)
+    while (offset + 32 <= size) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *)(data + offset));
+        __m256i lower = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+
+        __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), bytes));
+
+        // Maschera dei byte che sono lettere o cifre
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(alpha, digit));
+
+        // La sequenza termina al primo byte che non appartiene alla maschera
+        if (mask != 0xFFFFFFFF) return offset + __builtin_ctz(~mask);
+
+        offset += 32;
+    }
+
+    return offset;
+}
+#endif
\ No newline at end of file